@@ -18,10 +18,14 @@ void Spheres()
 {
     rcl::HittableList world;
     rcl::HittableList lightList;
+    lightList.SetSurfaceSampling(rcl::SurfaceSampling::Power);
 
     auto materialGround = std::make_shared<rcl::Lambertian>(std::make_shared<rcl::SolidColor>(rcl::vec3(0.5)));
     world.Add(std::make_shared<rcl::Sphere>(rcl::vec3(0,-1000,-1), 1000, materialGround));
 
+    // Loaded and mipmapped once, shared by all the textured spheres
+    auto texture = std::make_shared<rcl::PictureTexture>("PathCornelBox.png");
+
     for(int a = -11; a < 11; a++)
         for(int b = -11; b < 11; b++)
         {
@@ -34,7 +38,7 @@ void Spheres()
                 if (chooseMat < 0.8)
                 {
                     rcl::vec3 albedo = rcl::vec3::RandomVector(0, 1) * rcl::vec3::RandomVector(0, 1);
-                    sphereMaterial = std::make_shared<rcl::Lambertian>(std::make_shared<rcl::PictureTexture>("PathCornelBox.png"));
+                    sphereMaterial = std::make_shared<rcl::Lambertian>(texture);
                     world.Add(std::make_shared<rcl::Sphere>(center, 0.2, sphereMaterial));
                 } 
                 else if (chooseMat < 0.95)
@@ -86,17 +90,19 @@ void Spheres()
     rcl::Picture target;
     
     rcl::PathTracer vcm(50, 50);
+    // Linear out of the render, tone mapped and gamma corrected as the PNG is written
+    vcm.SetResolve({0.0f, rcl::ToneCurve::None, rcl::TransferCurve::Linear, false});
 
     vcm.Render(world, cam, target, lightList);
 
-    target.GammaCorection();
-    target.Export("PathCornelBox.png");
+    target.Export("PathCornelBox.png", {0.0f, rcl::ToneCurve::Reinhard, rcl::TransferCurve::Gamma2, false});
 }
 
 void CornelBox()
 {    
     rcl::HittableList world;
     rcl::HittableList lightList;
+    lightList.SetSurfaceSampling(rcl::SurfaceSampling::Power);
     auto red = std::make_shared<rcl::Lambertian>(std::make_shared<rcl::SolidColor>(rcl::vec3(.65, .05, .05)));
     auto white = std::make_shared<rcl::Lambertian>(std::make_shared<rcl::SolidColor>(rcl::vec3(.73, .73, .73)));
     auto green = std::make_shared<rcl::Lambertian>(std::make_shared<rcl::SolidColor>(rcl::vec3(.12, .45, .15)));
@@ -194,11 +200,12 @@ void CornelBox()
     
     // Create VCM renderer with more light paths and samples
     rcl::PathTracer vcm(50, 50);
+    // Linear out of the render, tone mapped and gamma corrected as the PNG is written
+    vcm.SetResolve({0.0f, rcl::ToneCurve::None, rcl::TransferCurve::Linear, false});
 
     vcm.Render(world, cam, target, lightList);
 
-    target.GammaCorection();
-    target.Export("PathCornelBox.png");
+    target.Export("PathCornelBox.png", {0.0f, rcl::ToneCurve::Reinhard, rcl::TransferCurve::Gamma2, false});
 }
 
 int main()
@@ -0,0 +1,45 @@
+#ifndef RCL_ALIAS_TABLE
+#define RCL_ALIAS_TABLE
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace rcl
+{
+
+// Discrete distribution over indices, index i is drawn with probability weights[i] / total
+// in constant time with a single random number (Walker's alias method, Vose's construction).
+class AliasTable
+{
+public:
+    AliasTable() = default;
+    explicit AliasTable(const std::vector<double>& weights);
+
+    // Negative and non-finite weights count as zero
+    void Build(const std::vector<double>& weights);
+    void Clear();
+
+    // u in [0, 1), undefined on an empty table
+    size_t Sample(double u) const;
+    size_t Sample() const;
+
+    double Probability(size_t index) const;
+    double Total() const;
+    size_t Size() const;
+    // True when there is no positive weight to draw from
+    bool Empty() const;
+private:
+    struct Bin
+    {
+        double threshold;
+        uint32_t alias;
+    };
+
+    std::vector<Bin> bins;
+    std::vector<double> probabilities;
+    double total = 0;
+};
+
+}
+#endif
\ No newline at end of file
@@ -1,16 +1,38 @@
 #ifndef RCL_FUNCTIONS
 #define RCL_FUNCTIONS
 
+#include <cstdint>
+#include <cstddef>
+
+// Only the vector template, vector.hpp includes this header
+#include "vectors/base_vector.hpp"
+
 namespace rcl
 {
 
+// Every thread draws from its own generator, SeedRandom reseeds the calling thread's one
+void SeedRandom(unsigned int seed);
+
+// Uniform in [0, 1)
 double RandomDouble01();
 
 double RandomDoubleMinMax(double min, double max);
 
+// Uniform over min..max, both included
 int RandomIntMinMax(int min, int max);
 
+// Uniform barycentric coordinates over a triangle, the point is a + (b - a) * u + (c - a) * v.
+// The unit square is folded in half, so no point lands in the other half of the parallelogram.
+void RandomBarycentric(double& u, double& v);
+
 double LinearToGamma(double value);
 
+// Rec. 709 luminance of a linear color, a vec3
+double Luminance(const Vector<3, float>& color);
+
+// 64-bit hash over 8-byte words, each mixed with MurmurHash3's finalizer, and the result finalized
+// the same way. Pass a previous result as seed to hash several buffers as one. Not cryptographic.
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,39 @@
+#ifndef RCL_MAPPED_FILE
+#define RCL_MAPPED_FILE
+
+#include <cstddef>
+#include <vector>
+
+namespace rcl
+{
+
+// Read-only view of a whole file. Maps it into memory where mmap is available,
+// otherwise reads it into an owned buffer, callers see the same bytes either way.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const char* path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const char* path);
+    void Close();
+
+    bool IsOpen() const;
+    const char* Data() const;
+    size_t Size() const;
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool open = false;
+    bool mapped = false;
+    std::vector<char> buffer;
+};
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,106 @@
+#include "alias_table.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "functions.hpp"
+
+namespace rcl
+{
+
+AliasTable::AliasTable(const std::vector<double>& weights)
+{
+    Build(weights);
+}
+
+void AliasTable::Build(const std::vector<double>& weights)
+{
+    Clear();
+
+    for (double weight : weights)
+        if (std::isfinite(weight) && weight > 0)
+            total += weight;
+    if (total <= 0)
+    {
+        total = 0;
+        return;
+    }
+
+    size_t count = weights.size();
+    bins.resize(count);
+    probabilities.resize(count);
+
+    // Bins start with their weight scaled so the average is 1, underfull ones
+    // are topped up from overfull ones, which become their alias
+    std::vector<double> scaled(count);
+    std::vector<uint32_t> small, large;
+    for (size_t i = 0; i < count; i++)
+    {
+        double weight = std::isfinite(weights[i]) && weights[i] > 0 ? weights[i] : 0;
+        probabilities[i] = weight / total;
+        scaled[i] = probabilities[i] * count;
+        (scaled[i] < 1 ? small : large).push_back(static_cast<uint32_t>(i));
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        uint32_t under = small.back();
+        small.pop_back();
+        uint32_t over = large.back();
+
+        bins[under] = Bin{scaled[under], over};
+        scaled[over] -= 1 - scaled[under];
+        if (scaled[over] < 1)
+        {
+            large.pop_back();
+            small.push_back(over);
+        }
+    }
+
+    // Whatever is left is 1 up to rounding
+    for (uint32_t i : large)
+        bins[i] = Bin{1, i};
+    for (uint32_t i : small)
+        bins[i] = Bin{1, i};
+}
+
+void AliasTable::Clear()
+{
+    bins.clear();
+    probabilities.clear();
+    total = 0;
+}
+
+size_t AliasTable::Sample(double u) const
+{
+    double scaled = u * bins.size();
+    size_t bin = std::min(static_cast<size_t>(scaled), bins.size() - 1);
+    return scaled - bin < bins[bin].threshold ? bin : bins[bin].alias;
+}
+
+size_t AliasTable::Sample() const
+{
+    return Sample(RandomDouble01());
+}
+
+double AliasTable::Probability(size_t index) const
+{
+    return index < probabilities.size() ? probabilities[index] : 0;
+}
+
+double AliasTable::Total() const
+{
+    return total;
+}
+
+size_t AliasTable::Size() const
+{
+    return probabilities.size();
+}
+
+bool AliasTable::Empty() const
+{
+    return bins.empty();
+}
+
+}
\ No newline at end of file
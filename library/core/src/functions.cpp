@@ -1,17 +1,48 @@
 #include "functions.hpp"
 
 #include <random>
+#include <cmath>
+#include <atomic>
+#include <cstring>
 
 #include "constants.hpp"
+#include "vector.hpp"
 
 namespace rcl
 {
 
+namespace
+{
+    std::mt19937& Generator()
+    {
+        static std::atomic<unsigned int> nextStream(0);
+        thread_local std::mt19937 generator(std::mt19937::default_seed + nextStream++);
+        return generator;
+    }
+
+    // MurmurHash3's 64-bit finalizer, every input bit reaches every output bit
+    uint64_t Mix64(uint64_t value)
+    {
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        return value;
+    }
+}
+
+void SeedRandom(unsigned int seed)
+{
+    Generator().seed(seed);
+}
+
+// The distribution itself can round up to 1, that one value is pulled back
 double RandomDouble01()
 {
-    static std::uniform_real_distribution<double> distribution(0.0, 0.999);
-    static std::mt19937 generator;
-    return distribution(generator);
+    thread_local std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    double value = distribution(Generator());
+    return value < 1.0 ? value : std::nextafter(1.0, 0.0);
 }
 
 double RandomDoubleMinMax(double min, double max)
@@ -24,6 +55,17 @@ int RandomIntMinMax(int min, int max)
     return int(RandomDoubleMinMax(min, max+1));
 }
 
+void RandomBarycentric(double& u, double& v)
+{
+    u = RandomDouble01();
+    v = RandomDouble01();
+    if (u + v > 1)
+    {
+        u = 1 - u;
+        v = 1 - v;
+    }
+}
+
 double LinearToGamma(double value)
 {
     if (value > 0)
@@ -32,4 +74,34 @@ double LinearToGamma(double value)
     return 0;
 }
 
+double Luminance(const vec3& color)
+{
+    return 0.2126 * color.r + 0.7152 * color.g + 0.0722 * color.b;
+}
+
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = seed;
+
+    // Whole words, large inputs are hashed on every mesh load. Each word is mixed before it is
+    // folded in, so its high bytes reach the low bits of the result too.
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ Mix64(word)) * 0x9e3779b97f4a7c15ull + 0x165667b19e3779f9ull;
+    }
+
+    // The last few bytes as one zero padded word, the size tells paddings apart
+    if (i < size)
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + i, size - i);
+        hash = (hash ^ Mix64(word)) * 0x9e3779b97f4a7c15ull + 0x165667b19e3779f9ull;
+    }
+    return Mix64(hash ^ size);
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "mapped_file.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define RCL_HAS_MMAP
+#endif
+
+namespace rcl
+{
+
+MappedFile::MappedFile(const char* path)
+{
+    Open(path);
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this == &other)
+        return *this;
+
+    Close();
+    data = other.data;
+    size = other.size;
+    open = other.open;
+    mapped = other.mapped;
+    buffer = std::move(other.buffer);
+    if (!mapped)
+        data = buffer.data();
+
+    other.data = nullptr;
+    other.size = 0;
+    other.open = other.mapped = false;
+    return *this;
+}
+
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+#ifdef RCL_HAS_MMAP
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0)
+    {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED)
+        {
+            data = static_cast<const char*>(address);
+            mapped = true;
+        }
+    }
+    ::close(fd);
+
+    if (mapped || size == 0)
+    {
+        open = true;
+        return true;
+    }
+#endif
+
+    // No mmap on this platform or the mapping failed, fall back to a plain read
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open())
+        return false;
+
+    size = static_cast<size_t>(file.tellg());
+    buffer.resize(size);
+    file.seekg(0);
+    if (!file.read(buffer.data(), size))
+    {
+        buffer.clear();
+        size = 0;
+        return false;
+    }
+
+    data = buffer.data();
+    open = true;
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef RCL_HAS_MMAP
+    if (mapped)
+        munmap(const_cast<char*>(data), size);
+#endif
+    buffer.clear();
+    buffer.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    open = mapped = false;
+}
+
+bool MappedFile::IsOpen() const
+{
+    return open;
+}
+
+const char* MappedFile::Data() const
+{
+    return data;
+}
+
+size_t MappedFile::Size() const
+{
+    return size;
+}
+
+}
\ No newline at end of file
@@ -15,17 +15,60 @@ class BVHNode : public Hittable
 public:
     BVHNode(HittableList list);
     BVHNode(std::vector<std::shared_ptr<Hittable>>& objects, size_t start, size_t end);
+    // Assembles a node over already built children, used to restore a serialized tree
+    BVHNode(std::shared_ptr<Hittable> left, std::shared_ptr<Hittable> right, bool leftIsNode, bool rightIsNode);
 
     bool hit(const Ray& ray, const Interval<double>& interval, HitRecord& record) const override;
 
     const AABB& BoundingBox() const override;
+    double Area() const override;
     vec3 RandomPointOnSurface() const override;
     Ray RandomRayFromSurface() const override;
     std::shared_ptr<Material> GetMaterial() const override;
+
+    // Recomputes bounds bottom-up after leaves moved, the tree shape is kept
+    void Refit();
+    // Refits, then rebuilds every subtree whose SAH cost grew past threshold * build-time cost;
+    // returns true if anything was rebuilt
+    bool Update(double threshold = 1.5);
+    void Rebuild();
+
+    // Surface area heuristic cost of the subtree, now and right after it was built
+    double Cost() const;
+    double BuildCost() const;
+
+    size_t NodeCount() const;
+    size_t PrimitiveCount() const;
+    // Node objects and their shared_ptr control blocks, per primitive
+    double BytesPerPrimitive() const;
+
+    const std::shared_ptr<Hittable>& Left() const;
+    const std::shared_ptr<Hittable>& Right() const;
+    bool LeftIsNode() const;
+    bool RightIsNode() const;
+
+    // Bump whenever the split strategy changes, serialized trees built by an older one get discarded
+    static constexpr int BUILDER_VERSION = 1;
 private:
     std::shared_ptr<Hittable> left;
     std::shared_ptr<Hittable> right;
+    bool leftIsNode;
+    bool rightIsNode;
     AABB bbox;
+    double area;
+    double cost;
+    double buildCost;
+
+    void Build(std::vector<std::shared_ptr<Hittable>>& objects, size_t start, size_t end);
+    void UpdateBounds();
+    void RefitHelper(int depth);
+    bool RebuildDegraded(double threshold);
+    void CollectLeaves(std::vector<std::shared_ptr<Hittable>>& leaves) const;
+    const Hittable& PickLeafByArea() const;
+
+    static constexpr double TRAVERSAL_COST = 1.0;
+    static constexpr double INTERSECTION_COST = 1.0;
+    static constexpr int MIN_DEPTH_FOR_PARALLEL = 3;
 
     static bool BoxCompare
     (const std::shared_ptr<Hittable> a, const std::shared_ptr<Hittable> b, int axisIndex);
@@ -0,0 +1,62 @@
+#ifndef RCL_FIXED_MAX_HEAP
+#define RCL_FIXED_MAX_HEAP
+
+#include <algorithm>
+#include <cstddef>
+
+namespace rcl
+{
+
+// Bounded max-heap living in inline storage, used to keep the k best
+// candidates of a nearest-neighbour search without touching the allocator.
+template <typename T, size_t Capacity>
+class FixedMaxHeap
+{
+public:
+    FixedMaxHeap(size_t limit) : limit(std::min(limit, Capacity)), count(0) {}
+
+    size_t Size() const { return count; }
+    size_t Limit() const { return limit; }
+    bool Empty() const { return count == 0; }
+    bool Full() const { return count >= limit; }
+
+    const T& Top() const { return items[0]; }
+
+    // Keeps the value if the heap is not full or it beats the current worst
+    bool Offer(const T& value)
+    {
+        if (limit == 0) return false;
+
+        if (count < limit)
+        {
+            items[count++] = value;
+            std::push_heap(items, items + count);
+            return true;
+        }
+
+        if (!(value < items[0])) return false;
+
+        std::pop_heap(items, items + count);
+        items[count - 1] = value;
+        std::push_heap(items, items + count);
+        return true;
+    }
+
+    // Destroys the heap order, leaves items sorted from best to worst
+    void SortAscending()
+    {
+        std::sort_heap(items, items + count);
+    }
+
+    const T* begin() const { return items; }
+    const T* end() const { return items + count; }
+
+private:
+    T items[Capacity];
+    size_t limit;
+    size_t count;
+};
+
+} // namespace rcl
+
+#endif
\ No newline at end of file
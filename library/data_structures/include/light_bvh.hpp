@@ -0,0 +1,89 @@
+#ifndef RCL_LIGHT_BVH
+#define RCL_LIGHT_BVH
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "hittable.hpp"
+#include "hittable_list.hpp"
+
+namespace rcl
+{
+
+// Hierarchy over emitters for picking one light per shading point. Every node bounds the power,
+// the extent and the emission directions of the lights below it. Picking walks down from the root
+// and enters each child with probability proportional to its estimated contribution at the point,
+// so it costs O(log n) and prefers near, bright lights that face the point. Built once, rebuild it
+// after lights move. Lights without a material or with no emitted power are never picked.
+class LightBVH
+{
+public:
+    struct LightSample
+    {
+        const Hittable* light = nullptr;
+        // Position in the list the hierarchy was built from
+        size_t index = 0;
+        double probability = 0;
+    };
+
+    LightBVH() = default;
+    explicit LightBVH(const HittableList& lights);
+
+    void Build(const HittableList& lights);
+    void Clear();
+
+    // normal may be zero, for points in participating media. u in [0, 1).
+    // False when no light can reach the point.
+    bool Pick(const vec3& point, const vec3& normal, double u, LightSample& sample) const;
+    bool Pick(const vec3& point, const vec3& normal, LightSample& sample) const;
+
+    // Probability of Pick choosing this light at the point, to weight BSDF samples that hit it
+    double Probability(const vec3& point, const vec3& normal, size_t index) const;
+    double Probability(const vec3& point, const vec3& normal, const Hittable* light) const;
+
+    // Lights that can be picked
+    size_t Size() const;
+    bool Empty() const;
+    size_t NodeCount() const;
+private:
+    struct Bounds
+    {
+        AABB box = AABB::empty;
+        // Emission directions: normals within acos(cosNormal) of axis,
+        // light leaves them at up to acos(cosEmission) further
+        vec3 axis = vec3(0, 0, 1);
+        double cosNormal = 1;
+        double cosEmission = 0;
+        double power = 0;
+        bool twoSided = false;
+    };
+
+    struct Node
+    {
+        Bounds bounds;
+        // Interior nodes have their first child right after them
+        uint32_t second = 0;
+        uint32_t parent = NONE;
+        uint32_t light = NONE;
+    };
+
+    static constexpr uint32_t NONE = 0xFFFFFFFFu;
+    static constexpr int BUCKETS = 12;
+
+    std::vector<Node> nodes;
+    std::vector<const Hittable*> lights;
+    // Leaf of every light in the source list, NONE when it is not in the tree
+    std::vector<uint32_t> leaves;
+    std::unordered_map<const Hittable*, size_t> indices;
+
+    uint32_t BuildRecursive(std::vector<std::pair<Bounds, uint32_t>>& items, size_t start, size_t end, uint32_t parent);
+
+    static Bounds LightBounds(const Hittable& light);
+    static Bounds Union(const Bounds& a, const Bounds& b);
+    static double Importance(const Bounds& bounds, const vec3& point, const vec3& normal);
+    static double Cost(const Bounds& bounds, const AABB& parent, int axis);
+};
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,25 @@
+#ifndef RCL_PHOTON
+#define RCL_PHOTON
+
+#include "vector.hpp"
+
+namespace rcl
+{
+
+struct Photon
+{
+    vec3 position;
+    vec3 power;
+    vec3 direction;
+    bool isCaustic;
+    int sourceMaterial;    // 0=unknown, 1=diffuse, 2=metal, 3=glass
+    vec3 normal;           // of the surface on the side the photon arrived, zero when unknown
+   
+    Photon() {}
+    Photon(const vec3& pos, const vec3& pow, const vec3& dir, bool caustic = false, int source = 0, const vec3& norm = vec3(0))
+    : position(pos), power(pow), direction(dir), isCaustic(caustic), sourceMaterial(source), normal(norm) {}
+};
+
+} // namespace rcl
+
+#endif
\ No newline at end of file
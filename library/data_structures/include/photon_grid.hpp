@@ -0,0 +1,129 @@
+#ifndef RCL_PHOTON_GRID
+#define RCL_PHOTON_GRID
+
+#include "vector.hpp"
+#include "photon.hpp"
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+namespace rcl
+{
+
+// Spatial hash over a uniform grid whose cell size equals the gather radius,
+// so a fixed-radius query touches at most the 27 cells around the query point.
+// Photons are counting-sorted by cell, positions are kept as SoA arrays.
+class PhotonGrid
+{
+public:
+    PhotonGrid();
+    ~PhotonGrid() = default;
+
+    void Build(const std::vector<Photon>& photons, double cellSize);
+
+    void FindNearestPhotons(const vec3& position, double radius,
+                           std::vector<const Photon*>& result, bool causticsOnly = false) const;
+
+    template <typename Heap>
+    void FindKNearestPhotons(const vec3& position, Heap& heap, bool causticsOnly = false) const;
+
+    void Clear();
+
+    bool Empty() const;
+    const std::vector<Photon>& GetPhotons() const;
+    double GetCellSize() const;
+
+private:
+    double cellSize;
+    double invCellSize;
+    uint32_t tableMask;
+
+    std::vector<uint32_t> cellStart;
+    std::vector<Photon> photons;
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> positionZ;
+
+    ivec3 CellCoords(const vec3& position) const;
+    uint32_t Hash(int x, int y, int z) const;
+
+    template <typename Visitor>
+    void ForEachCandidate(const vec3& position, double radius, Visitor&& visit) const;
+
+    static constexpr int MIN_PHOTONS_FOR_PARALLEL = 1000;
+};
+
+template <typename Heap>
+void PhotonGrid::FindKNearestPhotons(const vec3& position, Heap& heap, bool causticsOnly) const
+{
+    if (Empty()) return;
+
+    // The grid only answers within one gather radius, k-NN is bounded by it
+    double squaredRadius = cellSize * cellSize;
+
+    ForEachCandidate(position, cellSize, [&](uint32_t index, double squaredDistance)
+    {
+        if (squaredDistance > squaredRadius) return;
+
+        const Photon& photon = photons[index];
+        if (!causticsOnly || photon.isCaustic)
+            heap.Offer(std::make_pair(squaredDistance, &photon));
+    });
+}
+
+template <typename Visitor>
+void PhotonGrid::ForEachCandidate(const vec3& position, double radius, Visitor&& visit) const
+{
+    ivec3 center = CellCoords(position);
+    int reach = std::max(1, static_cast<int>(std::ceil(radius * invCellSize)));
+
+    // Distinct cells may share a hash slot, visit every slot only once
+    constexpr int LOCAL_SLOTS = 27;
+    uint32_t localVisited[LOCAL_SLOTS];
+    std::vector<uint32_t> visited;
+    int visitedCount = 0;
+    bool useLocal = (2 * reach + 1) * (2 * reach + 1) * (2 * reach + 1) <= LOCAL_SLOTS;
+
+    float px = position.x;
+    float py = position.y;
+    float pz = position.z;
+
+    for (int dz = -reach; dz <= reach; dz++)
+        for (int dy = -reach; dy <= reach; dy++)
+            for (int dx = -reach; dx <= reach; dx++)
+            {
+                uint32_t slot = Hash(center.x + dx, center.y + dy, center.z + dz);
+                uint32_t begin = cellStart[slot];
+                uint32_t end = cellStart[slot + 1];
+                if (begin == end)
+                    continue;
+
+                if (useLocal)
+                {
+                    if (std::find(localVisited, localVisited + visitedCount, slot) != localVisited + visitedCount)
+                        continue;
+                    localVisited[visitedCount++] = slot;
+                }
+                else
+                {
+                    if (std::find(visited.begin(), visited.end(), slot) != visited.end())
+                        continue;
+                    visited.push_back(slot);
+                }
+
+                for (uint32_t i = begin; i < end; i++)
+                {
+                    float ddx = positionX[i] - px;
+                    float ddy = positionY[i] - py;
+                    float ddz = positionZ[i] - pz;
+                    visit(i, static_cast<double>(ddx * ddx + ddy * ddy + ddz * ddz));
+                }
+            }
+}
+
+} // namespace rcl
+
+#endif
\ No newline at end of file
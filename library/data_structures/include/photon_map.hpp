@@ -5,6 +5,9 @@
 #include "camera.hpp"
 #include "material.hpp"
 #include "vector.hpp"
+#include "photon.hpp"
+#include "photon_grid.hpp"
+#include "fixed_max_heap.hpp"
 
 #include <vector>
 #include <memory>
@@ -12,25 +15,11 @@
 #include <cmath>
 #include <iostream>
 #include <fstream>
-#include <queue>
 #include <mutex>
 
 namespace rcl
 {
    
-struct Photon
-{
-    vec3 position;
-    vec3 power;
-    vec3 direction;
-    bool isCaustic;
-    int sourceMaterial;    // 0=unknown, 1=diffuse, 2=metal, 3=glass
-   
-    Photon() {}
-    Photon(const vec3& pos, const vec3& pow, const vec3& dir, bool caustic = false, int source = 0)
-    : position(pos), power(pow), direction(dir), isCaustic(caustic), sourceMaterial(source) {}
-};
-
 struct KDTreeNode
 {
     Photon photon;
@@ -41,12 +30,21 @@ struct KDTreeNode
     KDTreeNode(const Photon& p, int ax) : photon(p), axis(ax), left(nullptr), right(nullptr) {}
 };
 
+enum class PhotonMapBackend
+{
+    KDTree,     // balanced kd-tree, exact k-NN at any distance
+    HashGrid    // hashed uniform grid, fixed-radius gathers up to gatherRadius
+};
+
 class PhotonMap
 {
 public:
     PhotonMap();
     ~PhotonMap() = default;
    
+    void SetBackend(PhotonMapBackend backend, double gatherRadius = 0.0);
+    PhotonMapBackend GetBackend() const;
+
     void Build(std::vector<Photon>& photons);
    
     void FindNearestPhotons(const vec3& position, double radius,
@@ -54,11 +52,40 @@ public:
    
     void FindKNearestPhotons(const vec3& position, int k,
                             std::vector<const Photon*>& result, bool causticsOnly = false) const;
+
+    // Same search, also returns the squared distances sorted from nearest to farthest
+    void FindKNearestPhotons(const vec3& position, int k, std::vector<const Photon*>& result,
+                            std::vector<double>& squaredDistances, bool causticsOnly = false) const;
+   
+    // Irradiance at a point of a surface facing normal, from the k nearest photons over the disc
+    // reaching the farthest of them. Photons landed on surfaces facing elsewhere, the other side
+    // of a wall or the far face of a corner, bring no flux.
+    vec3 EstimateIrradiance(const vec3& position, const vec3& normal, int k) const;
+
+    // Precomputes EstimateIrradiance at every stride-th photon, on its own surface, and keeps the
+    // estimates with their normals in a second kd-tree (Christensen's irradiance photons).
+    // Clear and Build invalidate it.
+    void BuildIrradianceCache(int k, int stride = 4);
+    // The nearest cached estimate whose normal agrees with normal, or a direct estimate when
+    // none of the nearby ones does
+    vec3 LookupIrradiance(const vec3& position, const vec3& normal) const;
+    bool HasIrradianceCache() const;
    
     void Clear();
 
+    static constexpr int MAX_K_NEAREST = 256;
+    // Photons and cached estimates count for a surface when their normals' cosine exceeds this
+    static constexpr double NORMAL_THRESHOLD = 0.9;
+    // Cached estimates looked at per lookup for one with a matching normal
+    static constexpr int IRRADIANCE_CANDIDATES = 8;
+
 private:
     std::unique_ptr<KDTreeNode> root;
+    std::unique_ptr<KDTreeNode> irradianceRoot;
+    PhotonGrid grid;
+    PhotonMapBackend backend;
+    double gatherRadius;
+    int irradianceK = 0;
     mutable std::mutex mapMutex;
    
     std::unique_ptr<KDTreeNode> BuildTree(std::vector<Photon>& photons, int start, int end, int depth);
@@ -68,12 +95,19 @@ private:
                                  double squaredRadius, std::vector<const Photon*>& result,
                                  bool causticsOnly, int materialFilter = 0) const;
    
-    void FindKNearestPhotonsHelper(const KDTreeNode* node, const vec3& position,
-                                  std::priority_queue<std::pair<double, const Photon*>>& result,
-                                  int k, bool causticsOnly) const;
+    using NearestHeap = FixedMaxHeap<std::pair<double, const Photon*>, MAX_K_NEAREST>;
+
+    void FindKNearestPhotonsHelper(const KDTreeNode* start, const vec3& position,
+                                  NearestHeap& heap, bool causticsOnly) const;
+
+    void CollectPhotons(std::vector<const Photon*>& result) const;
+
+    // Zero normals, photons from outside PhotonTracer, match any surface
+    static bool SameSurface(const vec3& a, const vec3& b);
    
     static constexpr int MIN_PHOTONS_FOR_PARALLEL = 1000;
     static constexpr int MIN_DEPTH_FOR_PARALLEL = 3;
+    static constexpr int MAX_TREE_DEPTH = 64;
 };
 
 } // namespace rcl
@@ -0,0 +1,72 @@
+#ifndef RCL_QUANTIZED_BVH
+#define RCL_QUANTIZED_BVH
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "hittable.hpp"
+#include "hittable_list.hpp"
+#include "bvh.hpp"
+#include "alias_table.hpp"
+
+namespace rcl
+{
+
+// Read-only BVH with compressed nodes. Each node holds up to four children, their bounds are
+// stored as T sized offsets inside the node box, rounded outwards so they always contain the
+// real bounds. With uint8_t a node is exactly one 64 byte cache line, with uint16_t 88 bytes.
+// Built by collapsing a BVHNode tree, so it keeps that tree's splits. It does not refit,
+// rebuild it after objects move.
+template<typename T>
+class QuantizedBVH : public Hittable
+{
+public:
+    static constexpr int WIDTH = 4;
+
+    struct alignas(sizeof(T) == 1 ? 64 : 8) Node
+    {
+        float origin[3];
+        float scale[3];
+        T low[3][WIDTH];
+        T high[3][WIDTH];
+        uint32_t child[WIDTH];
+    };
+
+    explicit QuantizedBVH(HittableList list);
+    explicit QuantizedBVH(const BVHNode& root);
+
+    bool hit(const Ray& ray, const Interval<double>& interval, HitRecord& record) const override;
+
+    const AABB& BoundingBox() const override;
+    double Area() const override;
+    vec3 RandomPointOnSurface() const override;
+    Ray RandomRayFromSurface() const override;
+    std::shared_ptr<Material> GetMaterial() const override;
+
+    size_t NodeCount() const;
+    size_t PrimitiveCount() const;
+    // Nodes plus primitive references, what traversal reads, per primitive
+    double BytesPerPrimitive() const;
+private:
+    std::vector<Node> nodes;
+    std::vector<std::shared_ptr<Hittable>> primitives;
+    AliasTable primitiveAreas;
+    AABB bbox;
+    double area = 0;
+    size_t maxStack = 0;
+
+    static constexpr uint32_t LEAF = 0x80000000u;
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+    static constexpr uint32_t QUANT_MAX = (1u << (8 * sizeof(T))) - 1;
+    static constexpr size_t LOCAL_STACK = 256;
+
+    uint32_t Collapse(const BVHNode& node, size_t depth);
+    void BuildSampling();
+};
+
+extern template class QuantizedBVH<uint8_t>;
+extern template class QuantizedBVH<uint16_t>;
+
+}
+#endif
\ No newline at end of file
@@ -2,10 +2,26 @@
 
 #include <algorithm>
 #include <memory>
+#include <future>
 
 rcl::BVHNode::BVHNode(rcl::HittableList list) : BVHNode(list.objects, 0, list.objects.size()) {}
 rcl::BVHNode::BVHNode(std::vector<std::shared_ptr<Hittable>>& objects, size_t start, size_t end)
 {
+    Build(objects, start, end);
+}
+
+rcl::BVHNode::BVHNode
+(std::shared_ptr<Hittable> left, std::shared_ptr<Hittable> right, bool leftIsNode, bool rightIsNode)
+: left(left), right(right), leftIsNode(leftIsNode), rightIsNode(rightIsNode)
+{
+    UpdateBounds();
+    buildCost = cost;
+}
+
+void rcl::BVHNode::Build(std::vector<std::shared_ptr<Hittable>>& objects, size_t start, size_t end)
+{
+    leftIsNode = rightIsNode = false;
+
     bbox = rcl::AABB::empty;
     for(size_t objIndex = start; objIndex < end; objIndex++)
         bbox = rcl::AABB(bbox, objects[objIndex]->BoundingBox());
@@ -32,9 +48,162 @@ rcl::BVHNode::BVHNode(std::vector<std::shared_ptr<Hittable>>& objects, size_t st
         size_t mid = start + objectSpan/2;
         left = std::make_shared<BVHNode>(objects, start, mid);
         right = std::make_shared<BVHNode>(objects, mid, end);
+        leftIsNode = rightIsNode = true;
     }
 
+    UpdateBounds();
+    buildCost = cost;
+}
+
+void rcl::BVHNode::UpdateBounds()
+{
     bbox = rcl::AABB(left->BoundingBox(), right->BoundingBox());
+    area = (left == right) ? left->Area() : left->Area() + right->Area();
+
+    double leftCost = leftIsNode ? static_cast<const BVHNode&>(*left).cost : INTERSECTION_COST;
+    if (left == right)
+    {
+        cost = TRAVERSAL_COST + leftCost;
+        return;
+    }
+
+    double rightCost = rightIsNode ? static_cast<const BVHNode&>(*right).cost : INTERSECTION_COST;
+    double surface = bbox.SurfaceArea();
+    if (surface <= 0)
+    {
+        cost = TRAVERSAL_COST + leftCost + rightCost;
+        return;
+    }
+
+    cost = TRAVERSAL_COST 
+         + (left->BoundingBox().SurfaceArea() * leftCost + right->BoundingBox().SurfaceArea() * rightCost) / surface;
+}
+
+void rcl::BVHNode::Refit()
+{
+    RefitHelper(0);
+}
+
+void rcl::BVHNode::RefitHelper(int depth)
+{
+    BVHNode* leftNode = leftIsNode ? static_cast<BVHNode*>(left.get()) : nullptr;
+    BVHNode* rightNode = rightIsNode ? static_cast<BVHNode*>(right.get()) : nullptr;
+
+    if (leftNode && rightNode && depth < MIN_DEPTH_FOR_PARALLEL)
+    {
+        auto leftFuture = std::async(std::launch::async, [leftNode, depth]()
+        {
+            leftNode->RefitHelper(depth + 1);
+        });
+        rightNode->RefitHelper(depth + 1);
+        leftFuture.wait();
+    }
+    else
+    {
+        if (leftNode) leftNode->RefitHelper(depth + 1);
+        if (rightNode) rightNode->RefitHelper(depth + 1);
+    }
+
+    UpdateBounds();
+}
+
+bool rcl::BVHNode::Update(double threshold)
+{
+    Refit();
+    return RebuildDegraded(threshold);
+}
+
+bool rcl::BVHNode::RebuildDegraded(double threshold)
+{
+    if (cost > threshold * buildCost)
+    {
+        Rebuild();
+        return true;
+    }
+
+    bool rebuilt = false;
+    if (leftIsNode) rebuilt |= static_cast<BVHNode*>(left.get())->RebuildDegraded(threshold);
+    if (rightIsNode) rebuilt |= static_cast<BVHNode*>(right.get())->RebuildDegraded(threshold);
+
+    if (rebuilt)
+        UpdateBounds();
+    return rebuilt;
+}
+
+void rcl::BVHNode::Rebuild()
+{
+    std::vector<std::shared_ptr<Hittable>> leaves;
+    CollectLeaves(leaves);
+    Build(leaves, 0, leaves.size());
+}
+
+void rcl::BVHNode::CollectLeaves(std::vector<std::shared_ptr<Hittable>>& leaves) const
+{
+    if (leftIsNode)
+        static_cast<const BVHNode&>(*left).CollectLeaves(leaves);
+    else
+        leaves.push_back(left);
+
+    if (left == right)
+        return;
+
+    if (rightIsNode)
+        static_cast<const BVHNode&>(*right).CollectLeaves(leaves);
+    else
+        leaves.push_back(right);
+}
+
+double rcl::BVHNode::Cost() const
+{
+    return cost;
+}
+
+double rcl::BVHNode::BuildCost() const
+{
+    return buildCost;
+}
+
+size_t rcl::BVHNode::NodeCount() const
+{
+    size_t count = 1;
+    if (leftIsNode) count += static_cast<const BVHNode&>(*left).NodeCount();
+    if (rightIsNode && right != left) count += static_cast<const BVHNode&>(*right).NodeCount();
+    return count;
+}
+
+size_t rcl::BVHNode::PrimitiveCount() const
+{
+    size_t count = leftIsNode ? static_cast<const BVHNode&>(*left).PrimitiveCount() : 1;
+    if (right != left)
+        count += rightIsNode ? static_cast<const BVHNode&>(*right).PrimitiveCount() : 1;
+    return count;
+}
+
+double rcl::BVHNode::BytesPerPrimitive() const
+{
+    // make_shared puts a two counter control block with a vtable pointer in front of every node
+    size_t controlBlock = 2 * sizeof(int) + sizeof(void*);
+    return static_cast<double>(NodeCount() * (sizeof(BVHNode) + controlBlock)) / PrimitiveCount();
+}
+
+const std::shared_ptr<rcl::Hittable>& rcl::BVHNode::Left() const
+{
+    return left;
+}
+
+const std::shared_ptr<rcl::Hittable>& rcl::BVHNode::Right() const
+{
+    return right;
+}
+
+bool rcl::BVHNode::LeftIsNode() const
+{
+    return leftIsNode;
+}
+
+bool rcl::BVHNode::RightIsNode() const
+{
+    return rightIsNode;
 }
 
 bool rcl::BVHNode::hit
@@ -57,45 +226,36 @@ const rcl::AABB& rcl::BVHNode::BoundingBox() const
     return bbox;
 }
     
-rcl::vec3 rcl::BVHNode::RandomPointOnSurface() const
+double rcl::BVHNode::Area() const
 {
-    if (rcl::RandomDouble01() < 0.5)
-    {
-        auto leftNode = std::dynamic_pointer_cast<BVHNode>(left);
-        if (leftNode)
-            return leftNode->RandomPointOnSurface();
-        else
-            return left->RandomPointOnSurface();
-    }
-    else
+    return area;
+}
+    
+// Walks down choosing each child with probability proportional to its area, so the leaf
+// is picked by area and the point is uniform over the whole surface, density 1 / Area()
+const rcl::Hittable& rcl::BVHNode::PickLeafByArea() const
+{
+    const BVHNode* node = this;
+    while (true)
     {
-        auto rightNode = std::dynamic_pointer_cast<BVHNode>(right);
-        if (rightNode)
-            return rightNode->RandomPointOnSurface();
-        else
-            return right->RandomPointOnSurface();
+        bool goLeft = node->left == node->right || node->area <= 0 ||
+                      rcl::RandomDouble01() * node->area < node->left->Area();
+        bool isNode = goLeft ? node->leftIsNode : node->rightIsNode;
+        const rcl::Hittable& child = goLeft ? *node->left : *node->right;
+        if (!isNode)
+            return child;
+        node = static_cast<const BVHNode*>(&child);
     }
 }
 
+rcl::vec3 rcl::BVHNode::RandomPointOnSurface() const
+{
+    return PickLeafByArea().RandomPointOnSurface();
+}
     
 rcl::Ray rcl::BVHNode::RandomRayFromSurface() const
 {
-    if (rcl::RandomDouble01() < 0.5)
-    {
-        auto leftNode = std::dynamic_pointer_cast<BVHNode>(left);
-        if (leftNode)
-            return leftNode->RandomRayFromSurface();
-        else
-            return left->RandomRayFromSurface();
-    }
-    else
-    {
-        auto rightNode = std::dynamic_pointer_cast<BVHNode>(right);
-        if (rightNode)
-            return rightNode->RandomRayFromSurface();
-        else
-            return right->RandomRayFromSurface();
-    } 
+    return PickLeafByArea().RandomRayFromSurface();
 }
     
 std::shared_ptr<rcl::Material> rcl::BVHNode::GetMaterial() const
@@ -0,0 +1,413 @@
+#include "light_bvh.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+#include "material.hpp"
+#include "functions.hpp"
+#include "constants.hpp"
+
+namespace rcl
+{
+
+namespace
+{
+    const double ONE_MINUS_EPSILON = 0x1.fffffffffffffp-1;
+
+    double SafeSqrt(double value)
+    {
+        return std::sqrt(std::max(0.0, value));
+    }
+
+    double SafeAcos(double value)
+    {
+        return std::acos(std::clamp(value, -1.0, 1.0));
+    }
+
+    vec3 Center(const AABB& box)
+    {
+        return vec3(0.5 * (box.x.min + box.x.max), 0.5 * (box.y.min + box.y.max), 0.5 * (box.z.min + box.z.max));
+    }
+
+    // cos(max(0, a - b)) and sin(max(0, a - b)) from the sines and cosines of the angles
+    double CosSubtract(double sinA, double cosA, double sinB, double cosB)
+    {
+        if (cosA > cosB)
+            return 1;
+        return cosA * cosB + sinA * sinB;
+    }
+
+    double SinSubtract(double sinA, double cosA, double sinB, double cosB)
+    {
+        if (cosA > cosB)
+            return 0;
+        return sinA * cosB - cosA * sinB;
+    }
+}
+
+LightBVH::LightBVH(const HittableList& lights)
+{
+    Build(lights);
+}
+
+void LightBVH::Clear()
+{
+    nodes.clear();
+    lights.clear();
+    leaves.clear();
+    indices.clear();
+}
+
+void LightBVH::Build(const HittableList& list)
+{
+    Clear();
+
+    std::vector<std::pair<Bounds, uint32_t>> items;
+    lights.reserve(list.objects.size());
+    leaves.assign(list.objects.size(), NONE);
+
+    for (size_t i = 0; i < list.objects.size(); i++)
+    {
+        const Hittable* light = list.objects[i].get();
+        lights.push_back(light);
+        indices.emplace(light, i);
+
+        Bounds bounds = LightBounds(*light);
+        if (bounds.power > 0)
+            items.push_back(std::make_pair(bounds, static_cast<uint32_t>(i)));
+    }
+
+    if (items.empty())
+        return;
+
+    nodes.reserve(2 * items.size() - 1);
+    BuildRecursive(items, 0, items.size(), NONE);
+}
+
+LightBVH::Bounds LightBVH::LightBounds(const Hittable& light)
+{
+    Bounds bounds;
+    double radiance = Luminance(EmitterRadiance(light));
+    if (!(radiance > 0) || !std::isfinite(radiance))
+        return bounds;
+
+    bounds.box = light.BoundingBox();
+
+    // Flat lights shine around their normal, on both sides like the Light material does.
+    // The rest are bounded as shining everywhere, seen from any side a convex emitter
+    // shows a quarter of its surface on average.
+    vec3 normal;
+    if (light.FaceNormal(normal))
+    {
+        bounds.axis = normal;
+        bounds.cosNormal = 1;
+        bounds.twoSided = true;
+        bounds.power = radiance * light.Area();
+    }
+    else
+    {
+        bounds.cosNormal = -1;
+        bounds.power = 0.25 * radiance * light.Area();
+    }
+    bounds.cosEmission = 0;
+    return bounds;
+}
+
+// Smallest cone holding both, after Barringer et al.
+LightBVH::Bounds LightBVH::Union(const Bounds& a, const Bounds& b)
+{
+    if (!(a.power > 0)) return b;
+    if (!(b.power > 0)) return a;
+
+    Bounds result;
+    result.box = AABB(a.box, b.box);
+    result.power = a.power + b.power;
+    result.cosEmission = std::min(a.cosEmission, b.cosEmission);
+    result.twoSided = a.twoSided || b.twoSided;
+
+    double thetaA = SafeAcos(a.cosNormal);
+    double thetaB = SafeAcos(b.cosNormal);
+    double thetaD = SafeAcos(Dot(a.axis, b.axis));
+
+    if (std::min(thetaD + thetaB, PI) <= thetaA)
+    {
+        result.axis = a.axis;
+        result.cosNormal = a.cosNormal;
+        return result;
+    }
+    if (std::min(thetaD + thetaA, PI) <= thetaB)
+    {
+        result.axis = b.axis;
+        result.cosNormal = b.cosNormal;
+        return result;
+    }
+
+    double thetaO = 0.5 * (thetaA + thetaD + thetaB);
+    vec3 rotationAxis = Cross(a.axis, b.axis);
+    if (thetaO >= PI || rotationAxis.LengthSquared() <= 0)
+    {
+        result.axis = a.axis;
+        result.cosNormal = -1;
+        return result;
+    }
+
+    // Turn a's axis towards b's by the angle the cone grows on a's side
+    double thetaR = thetaO - thetaA;
+    vec3 k = rotationAxis.Unit();
+    result.axis = (std::cos(thetaR) * a.axis + std::sin(thetaR) * Cross(k, a.axis)).Unit();
+    result.cosNormal = std::cos(thetaO);
+    return result;
+}
+
+// Upper estimate of what the lights in bounds send to the point: power over squared distance,
+// times the most favourable cosines at the light and at the point the box allows
+double LightBVH::Importance(const Bounds& bounds, const vec3& point, const vec3& normal)
+{
+    vec3 center = Center(bounds.box);
+    vec3 toPoint = point - center;
+    double distanceSquared = toPoint.LengthSquared();
+    double radius = 0.5 * bounds.box.DiagonalLength();
+    double radiusSquared = radius * radius;
+
+    // Spread of the directions from the point into the box, all of them inside its bounding sphere
+    double cosBound = -1;
+    if (distanceSquared > radiusSquared)
+        cosBound = SafeSqrt(1 - radiusSquared / distanceSquared);
+    double sinBound = SafeSqrt(1 - cosBound * cosBound);
+
+    vec3 direction = distanceSquared > 0 ? toPoint / std::sqrt(distanceSquared) : vec3(0);
+    distanceSquared = std::max({distanceSquared, radiusSquared, 1e-12});
+
+    double cosAxis = Dot(bounds.axis, direction);
+    if (bounds.twoSided)
+        cosAxis = std::fabs(cosAxis);
+    double sinAxis = SafeSqrt(1 - cosAxis * cosAxis);
+    double sinNormal = SafeSqrt(1 - bounds.cosNormal * bounds.cosNormal);
+
+    // Angle to the point, less the normal spread, less the box spread
+    double cosReduced = CosSubtract(sinAxis, cosAxis, sinNormal, bounds.cosNormal);
+    double sinReduced = SinSubtract(sinAxis, cosAxis, sinNormal, bounds.cosNormal);
+    double cosLight = CosSubtract(sinReduced, cosReduced, sinBound, cosBound);
+    if (cosLight <= bounds.cosEmission)
+        return 0;
+
+    double importance = bounds.power * cosLight / distanceSquared;
+
+    if (normal.LengthSquared() > 0)
+    {
+        double cosIncident = std::fabs(Dot(direction, normal.Unit()));
+        double sinIncident = SafeSqrt(1 - cosIncident * cosIncident);
+        importance *= CosSubtract(sinIncident, cosIncident, sinBound, cosBound);
+    }
+
+    return std::max(importance, 0.0);
+}
+
+// Surface area orientation heuristic of one side of a split
+double LightBVH::Cost(const Bounds& bounds, const AABB& parent, int axis)
+{
+    double thetaO = SafeAcos(bounds.cosNormal);
+    double thetaE = SafeAcos(bounds.cosEmission);
+    double thetaW = std::min(thetaO + thetaE, PI);
+    double sinO = SafeSqrt(1 - bounds.cosNormal * bounds.cosNormal);
+    double orientation = 2 * PI * (1 - bounds.cosNormal)
+                       + PI / 2 * (2 * thetaW * sinO - std::cos(thetaO - 2 * thetaW) - 2 * thetaO * sinO + bounds.cosNormal);
+
+    // Thin slabs split across their short side are penalised
+    double longest = std::max({parent.x.Size(), parent.y.Size(), parent.z.Size()});
+    double extent = parent.AxisInterval(axis).Size();
+    double regularity = extent > 0 ? longest / extent : 1;
+
+    return bounds.power * orientation * bounds.box.SurfaceArea() * regularity;
+}
+
+uint32_t LightBVH::BuildRecursive
+(std::vector<std::pair<Bounds, uint32_t>>& items, size_t start, size_t end, uint32_t parent)
+{
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+    nodes[index].parent = parent;
+
+    if (end - start == 1)
+    {
+        nodes[index].bounds = items[start].first;
+        nodes[index].light = items[start].second;
+        leaves[items[start].second] = index;
+        return index;
+    }
+
+    Bounds total;
+    AABB centroids = AABB::empty;
+    for (size_t i = start; i < end; i++)
+    {
+        total = Union(total, items[i].first);
+        vec3 center = Center(items[i].first.box);
+        centroids = AABB(centroids, AABB(center, center));
+    }
+
+    // Binned split minimising the cost over all three axes
+    double bestCost = infinity;
+    int bestAxis = -1;
+    int bestBucket = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const Interval<double>& range = centroids.AxisInterval(axis);
+        if (!(range.Size() > 0))
+            continue;
+
+        Bounds buckets[BUCKETS];
+        for (size_t i = start; i < end; i++)
+        {
+            double c = Center(items[i].first.box)[axis];
+            int b = std::min(BUCKETS - 1, static_cast<int>(BUCKETS * (c - range.min) / range.Size()));
+            buckets[b] = Union(buckets[b], items[i].first);
+        }
+
+        for (int split = 0; split < BUCKETS - 1; split++)
+        {
+            Bounds below, above;
+            for (int b = 0; b <= split; b++)
+                below = Union(below, buckets[b]);
+            for (int b = split + 1; b < BUCKETS; b++)
+                above = Union(above, buckets[b]);
+            if (!(below.power > 0) || !(above.power > 0))
+                continue;
+
+            double cost = Cost(below, total.box, axis) + Cost(above, total.box, axis);
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBucket = split;
+            }
+        }
+    }
+
+    size_t mid;
+    if (bestAxis >= 0 && bestCost > 0)
+    {
+        const Interval<double>& range = centroids.AxisInterval(bestAxis);
+        auto below = [&](const std::pair<Bounds, uint32_t>& item)
+        {
+            double c = Center(item.first.box)[bestAxis];
+            int b = std::min(BUCKETS - 1, static_cast<int>(BUCKETS * (c - range.min) / range.Size()));
+            return b <= bestBucket;
+        };
+        mid = std::partition(items.begin() + start, items.begin() + end, below) - items.begin();
+    }
+    else
+    {
+        // Coincident centers or lights without extent, halve along the longest axis
+        int axis = centroids.LongestAxis();
+        mid = (start + end) / 2;
+        std::nth_element(items.begin() + start, items.begin() + mid, items.begin() + end,
+            [axis](const std::pair<Bounds, uint32_t>& a, const std::pair<Bounds, uint32_t>& b)
+            {
+                return Center(a.first.box)[axis] < Center(b.first.box)[axis];
+            });
+    }
+    if (mid == start || mid == end)
+        mid = (start + end) / 2;
+
+    BuildRecursive(items, start, mid, index);
+    uint32_t second = BuildRecursive(items, mid, end, index);
+
+    nodes[index].bounds = total;
+    nodes[index].second = second;
+    return index;
+}
+
+bool LightBVH::Pick(const vec3& point, const vec3& normal, double u, LightSample& sample) const
+{
+    if (nodes.empty() || !(Importance(nodes[0].bounds, point, normal) > 0))
+        return false;
+
+    double probability = 1;
+    uint32_t index = 0;
+    while (nodes[index].light == NONE)
+    {
+        uint32_t first = index + 1;
+        uint32_t second = nodes[index].second;
+        double importanceFirst = Importance(nodes[first].bounds, point, normal);
+        double importanceSecond = Importance(nodes[second].bounds, point, normal);
+        double sum = importanceFirst + importanceSecond;
+        if (!(sum > 0))
+            return false;
+
+        // Reuse u for the next level by stretching the chosen part back to [0, 1)
+        double probabilityFirst = importanceFirst / sum;
+        if (u < probabilityFirst)
+        {
+            u = std::min(u / probabilityFirst, ONE_MINUS_EPSILON);
+            probability *= probabilityFirst;
+            index = first;
+        }
+        else
+        {
+            u = std::min((u - probabilityFirst) / (1 - probabilityFirst), ONE_MINUS_EPSILON);
+            probability *= 1 - probabilityFirst;
+            index = second;
+        }
+    }
+
+    sample.index = nodes[index].light;
+    sample.light = lights[sample.index];
+    sample.probability = probability;
+    return true;
+}
+
+bool LightBVH::Pick(const vec3& point, const vec3& normal, LightSample& sample) const
+{
+    return Pick(point, normal, RandomDouble01(), sample);
+}
+
+// Same choices as Pick, walked from the light's leaf up to the root
+double LightBVH::Probability(const vec3& point, const vec3& normal, size_t index) const
+{
+    if (index >= leaves.size() || leaves[index] == NONE)
+        return 0;
+    if (!(Importance(nodes[0].bounds, point, normal) > 0))
+        return 0;
+
+    double probability = 1;
+    uint32_t node = leaves[index];
+    while (nodes[node].parent != NONE)
+    {
+        uint32_t parent = nodes[node].parent;
+        double importanceFirst = Importance(nodes[parent + 1].bounds, point, normal);
+        double importanceSecond = Importance(nodes[nodes[parent].second].bounds, point, normal);
+        double sum = importanceFirst + importanceSecond;
+        if (!(sum > 0))
+            return 0;
+
+        probability *= (node == parent + 1 ? importanceFirst : importanceSecond) / sum;
+        node = parent;
+    }
+    return probability;
+}
+
+double LightBVH::Probability(const vec3& point, const vec3& normal, const Hittable* light) const
+{
+    auto found = indices.find(light);
+    if (found == indices.end())
+        return 0;
+    return Probability(point, normal, found->second);
+}
+
+size_t LightBVH::Size() const
+{
+    return nodes.empty() ? 0 : (nodes.size() + 1) / 2;
+}
+
+bool LightBVH::Empty() const
+{
+    return nodes.empty();
+}
+
+size_t LightBVH::NodeCount() const
+{
+    return nodes.size();
+}
+
+}
\ No newline at end of file
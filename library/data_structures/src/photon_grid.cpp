@@ -0,0 +1,189 @@
+#include "photon_grid.hpp"
+
+#include <thread>
+#include <future>
+#include <atomic>
+#include <algorithm>
+
+namespace rcl
+{
+
+PhotonGrid::PhotonGrid() : cellSize(0), invCellSize(0), tableMask(0) {}
+
+void PhotonGrid::Build(const std::vector<Photon>& inputPhotons, double size)
+{
+    Clear();
+
+    if (inputPhotons.empty() || size <= 0)
+        return;
+
+    cellSize = size;
+    invCellSize = 1.0 / size;
+
+    size_t count = inputPhotons.size();
+
+    uint32_t tableSize = 1;
+    while (tableSize < count && tableSize < (1u << 31))
+        tableSize <<= 1;
+    tableMask = tableSize - 1;
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0 || count < MIN_PHOTONS_FOR_PARALLEL) numThreads = 1;
+
+    // Runs work(begin, end, thread) over contiguous slices of [0, size), one per thread
+    auto forEachSlice = [numThreads](size_t size, auto work)
+    {
+        size_t sliceSize = (size + numThreads - 1) / numThreads;
+        std::vector<std::future<void>> futures;
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            size_t begin = std::min(size, t * sliceSize);
+            size_t end = std::min(size, begin + sliceSize);
+            futures.push_back(std::async(std::launch::async, [&work, begin, end, t]() { work(begin, end, t); }));
+        }
+        for (auto& future : futures)
+            future.wait();
+    };
+
+    // Pass 1: hash every photon and count cell occupancy, all threads into one table
+    std::vector<uint32_t> cellOf(count);
+    std::vector<std::atomic<uint32_t>> cursors(tableSize);
+
+    forEachSlice(count, [this, &inputPhotons, &cellOf, &cursors](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            ivec3 cell = CellCoords(inputPhotons[i].position);
+            uint32_t hash = Hash(cell.x, cell.y, cell.z);
+            cellOf[i] = hash;
+            cursors[hash].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    // Exclusive prefix sum over the cells: every thread sums its slice, the slice totals are
+    // scanned, then every thread writes its slice's offsets. The cursors start at the offsets.
+    cellStart.resize(tableSize + 1);
+    std::vector<uint32_t> sliceStart(numThreads + 1, 0);
+
+    forEachSlice(tableSize, [&cursors, &sliceStart](size_t begin, size_t end, unsigned int t)
+    {
+        uint32_t total = 0;
+        for (size_t cell = begin; cell < end; cell++)
+            total += cursors[cell].load(std::memory_order_relaxed);
+        sliceStart[t + 1] = total;
+    });
+    for (unsigned int t = 0; t < numThreads; ++t)
+        sliceStart[t + 1] += sliceStart[t];
+
+    forEachSlice(tableSize, [this, &cursors, &sliceStart](size_t begin, size_t end, unsigned int t)
+    {
+        uint32_t running = sliceStart[t];
+        for (size_t cell = begin; cell < end; cell++)
+        {
+            uint32_t cellCount = cursors[cell].load(std::memory_order_relaxed);
+            cellStart[cell] = running;
+            cursors[cell].store(running, std::memory_order_relaxed);
+            running += cellCount;
+        }
+    });
+    cellStart[tableSize] = sliceStart[numThreads];
+
+    // Pass 2: claim a slot in the photon's cell. Threads race for the slots within a cell, so
+    // each cell is then sorted by input index, which keeps the build stable and deterministic.
+    std::vector<uint32_t> order(count);
+
+    forEachSlice(count, [&cellOf, &cursors, &order](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t i = begin; i < end; i++)
+            order[cursors[cellOf[i]].fetch_add(1, std::memory_order_relaxed)] = static_cast<uint32_t>(i);
+    });
+
+    photons.resize(count);
+    positionX.resize(count);
+    positionY.resize(count);
+    positionZ.resize(count);
+
+    forEachSlice(tableSize, [this, &inputPhotons, &order](size_t begin, size_t end, unsigned int)
+    {
+        for (size_t cell = begin; cell < end; cell++)
+        {
+            uint32_t first = cellStart[cell], last = cellStart[cell + 1];
+            if (last - first > 1)
+                std::sort(order.begin() + first, order.begin() + last);
+
+            for (uint32_t slot = first; slot < last; slot++)
+            {
+                const Photon& photon = inputPhotons[order[slot]];
+                photons[slot] = photon;
+                positionX[slot] = photon.position.x;
+                positionY[slot] = photon.position.y;
+                positionZ[slot] = photon.position.z;
+            }
+        }
+    });
+}
+
+void PhotonGrid::FindNearestPhotons(const vec3& position, double radius,
+                                    std::vector<const Photon*>& result, bool causticsOnly) const
+{
+    result.clear();
+    if (Empty()) return;
+
+    double squaredRadius = radius * radius;
+
+    ForEachCandidate(position, radius, [&](uint32_t index, double squaredDistance)
+    {
+        if (squaredDistance > squaredRadius) return;
+
+        const Photon& photon = photons[index];
+        if (!causticsOnly || photon.isCaustic)
+            result.push_back(&photon);
+    });
+}
+
+void PhotonGrid::Clear()
+{
+    cellSize = 0;
+    invCellSize = 0;
+    tableMask = 0;
+    cellStart.clear();
+    photons.clear();
+    positionX.clear();
+    positionY.clear();
+    positionZ.clear();
+}
+
+bool PhotonGrid::Empty() const
+{
+    return photons.empty();
+}
+
+const std::vector<Photon>& PhotonGrid::GetPhotons() const
+{
+    return photons;
+}
+
+double PhotonGrid::GetCellSize() const
+{
+    return cellSize;
+}
+
+ivec3 PhotonGrid::CellCoords(const vec3& position) const
+{
+    return ivec3
+    (
+        static_cast<int>(std::floor(position.x * invCellSize)),
+        static_cast<int>(std::floor(position.y * invCellSize)),
+        static_cast<int>(std::floor(position.z * invCellSize))
+    );
+}
+
+uint32_t PhotonGrid::Hash(int x, int y, int z) const
+{
+    uint32_t hash = (static_cast<uint32_t>(x) * 73856093u)
+                  ^ (static_cast<uint32_t>(y) * 19349663u)
+                  ^ (static_cast<uint32_t>(z) * 83492791u);
+    return hash & tableMask;
+}
+
+}
\ No newline at end of file
@@ -8,21 +8,48 @@
 namespace rcl
 {
 
-PhotonMap::PhotonMap() : root(nullptr) {}
+PhotonMap::PhotonMap() : root(nullptr), backend(PhotonMapBackend::KDTree), gatherRadius(0.0) {}
+
+void PhotonMap::SetBackend(PhotonMapBackend newBackend, double radius)
+{
+    std::lock_guard<std::mutex> lock(mapMutex);
+
+    if (newBackend == PhotonMapBackend::HashGrid && radius <= 0)
+    {
+        std::cerr << "Error: Hash grid photon map needs a positive gather radius" << std::endl;
+        return;
+    }
+
+    backend = newBackend;
+    gatherRadius = radius;
+    root = nullptr;
+    irradianceRoot = nullptr;
+    grid.Clear();
+}
+
+PhotonMapBackend PhotonMap::GetBackend() const
+{
+    return backend;
+}
 
 void PhotonMap::Build(std::vector<Photon>& inputPhotons)
 {
     std::lock_guard<std::mutex> lock(mapMutex);
     
+    root = nullptr;
+    irradianceRoot = nullptr;
+    grid.Clear();
+
     if (inputPhotons.empty()) 
-    {
-        root = nullptr;
         return;
-    }
     
     auto start = std::chrono::high_resolution_clock::now();
     
-    if (inputPhotons.size() >= MIN_PHOTONS_FOR_PARALLEL) 
+    if (backend == PhotonMapBackend::HashGrid)
+    {
+        grid.Build(inputPhotons, gatherRadius);
+    }
+    else if (inputPhotons.size() >= MIN_PHOTONS_FOR_PARALLEL) 
     {
         root = BuildBalancedTree(inputPhotons, 0, inputPhotons.size(), 0);
     } 
@@ -40,6 +67,12 @@ void PhotonMap::Build(std::vector<Photon>& inputPhotons)
 void PhotonMap::FindNearestPhotons(const vec3& position, double radius, 
                                        std::vector<const Photon*>& result, bool causticsOnly) const
 {
+    if (backend == PhotonMapBackend::HashGrid)
+    {
+        grid.FindNearestPhotons(position, radius, result, causticsOnly);
+        return;
+    }
+
     if (!root) return;
     
     double squaredRadius = radius * radius;
@@ -52,28 +85,143 @@ void PhotonMap::FindNearestPhotons(const vec3& position, double radius,
 void PhotonMap::FindKNearestPhotons(const vec3& position, int k, 
                                         std::vector<const Photon*>& result, bool causticsOnly) const
 {
-    if (!root || k <= 0) return;
-    
-    std::priority_queue<std::pair<double, const Photon*>> pq;
-    
-    FindKNearestPhotonsHelper(root.get(), position, pq, k, causticsOnly);
-    
     result.clear();
-    result.reserve(pq.size());
-    
-    while (!pq.empty()) 
+    if (k <= 0) return;
+
+    NearestHeap heap(k);
+
+    if (backend == PhotonMapBackend::HashGrid)
+        grid.FindKNearestPhotons(position, heap, causticsOnly);
+    else
+        FindKNearestPhotonsHelper(root.get(), position, heap, causticsOnly);
+
+    heap.SortAscending();
+
+    result.reserve(heap.Size());
+    for (const auto& entry : heap)
+        result.push_back(entry.second);
+}
+
+void PhotonMap::FindKNearestPhotons(const vec3& position, int k, std::vector<const Photon*>& result,
+                                        std::vector<double>& squaredDistances, bool causticsOnly) const
+{
+    result.clear();
+    squaredDistances.clear();
+    if (k <= 0) return;
+
+    NearestHeap heap(k);
+
+    if (backend == PhotonMapBackend::HashGrid)
+        grid.FindKNearestPhotons(position, heap, causticsOnly);
+    else
+        FindKNearestPhotonsHelper(root.get(), position, heap, causticsOnly);
+
+    heap.SortAscending();
+
+    result.reserve(heap.Size());
+    squaredDistances.reserve(heap.Size());
+    for (const auto& entry : heap)
     {
-        result.push_back(pq.top().second);
-        pq.pop();
+        squaredDistances.push_back(entry.first);
+        result.push_back(entry.second);
     }
-    
-    std::reverse(result.begin(), result.end());
+}
+
+vec3 PhotonMap::EstimateIrradiance(const vec3& position, const vec3& normal, int k) const
+{
+    if (k <= 0) return vec3(0);
+
+    NearestHeap heap(k);
+    if (backend == PhotonMapBackend::HashGrid)
+        grid.FindKNearestPhotons(position, heap, false);
+    else
+        FindKNearestPhotonsHelper(root.get(), position, heap, false);
+
+    vec3 flux(0);
+    for (const auto& entry : heap)
+        if (SameSurface(entry.second->normal, normal))
+            flux += entry.second->power;
+
+    double squaredRadius = heap.Empty() ? 0.0 : heap.Top().first;
+    return (squaredRadius > 0) ? flux / (PI * squaredRadius) : vec3(0);
+}
+
+void PhotonMap::BuildIrradianceCache(int k, int stride)
+{
+    std::lock_guard<std::mutex> lock(mapMutex);
+    irradianceRoot = nullptr;
+    irradianceK = 0;
+
+    if (k <= 0 || stride <= 0) return;
+
+    std::vector<const Photon*> photons;
+    CollectPhotons(photons);
+    if (photons.empty()) return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::vector<Photon> samples((photons.size() + stride - 1) / stride);
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 1;
+    size_t samplesPerThread = (samples.size() + numThreads - 1) / numThreads;
+
+    std::vector<std::future<void>> futures;
+    for (unsigned int t = 0; t < numThreads; ++t)
+    {
+        size_t begin = t * samplesPerThread;
+        size_t end = std::min(samples.size(), begin + samplesPerThread);
+
+        futures.push_back(std::async(std::launch::async, [this, k, stride, begin, end, &photons, &samples]()
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                const Photon& source = *photons[i * stride];
+                vec3 irradiance = EstimateIrradiance(source.position, source.normal, k);
+                samples[i] = Photon(source.position, irradiance, source.direction, source.isCaustic, source.sourceMaterial, source.normal);
+            }
+        }));
+    }
+
+    for (auto& future : futures)
+        future.wait();
+
+    irradianceRoot = BuildBalancedTree(samples, 0, samples.size(), 0);
+    irradianceK = k;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "Irradiance cache built with " << samples.size() << " samples in " 
+              << duration.count() << "ms" << std::endl;
+}
+
+vec3 PhotonMap::LookupIrradiance(const vec3& position, const vec3& normal) const
+{
+    if (!irradianceRoot) return vec3(0);
+
+    NearestHeap heap(IRRADIANCE_CANDIDATES);
+    FindKNearestPhotonsHelper(irradianceRoot.get(), position, heap, false);
+    heap.SortAscending();
+
+    for (const auto& entry : heap)
+        if (SameSurface(entry.second->normal, normal))
+            return entry.second->power;
+
+    return EstimateIrradiance(position, normal, irradianceK);
+}
+
+bool PhotonMap::HasIrradianceCache() const
+{
+    return irradianceRoot != nullptr;
 }
 
 void PhotonMap::Clear()
 {
     std::lock_guard<std::mutex> lock(mapMutex);
     root = nullptr;
+    irradianceRoot = nullptr;
+    irradianceK = 0;
+    grid.Clear();
 }
 
 std::unique_ptr<KDTreeNode> PhotonMap::BuildTree(std::vector<Photon>& inputPhotons, 
@@ -178,41 +326,92 @@ void PhotonMap::FindNearestPhotonsHelper(const KDTreeNode* node, const vec3& pos
         FindNearestPhotonsHelper(second, position, squaredRadius, result, causticsOnly, materialFilter);
 }
 
-void PhotonMap::FindKNearestPhotonsHelper(const KDTreeNode* node, const vec3& position,
-                                              std::priority_queue<std::pair<double, const Photon*>>& result,
-                                              int k, bool causticsOnly) const
+void PhotonMap::FindKNearestPhotonsHelper(const KDTreeNode* start, const vec3& position,
+                                              NearestHeap& heap, bool causticsOnly) const
 {
-    if (!node) return;
-    
-    const Photon& photon = node->photon;
-    double squaredDistance = (position - photon.position).LengthSquared();
-    
-    if (!causticsOnly || photon.isCaustic) 
+    if (!start) return;
+
+    // Far children wait on an explicit stack together with their splitting plane distance,
+    // a balanced tree never holds more than one pending entry per level
+    struct PendingNode
     {
-        if (result.size() < k) 
-        {
-            result.push(std::make_pair(squaredDistance, &photon));
-        } 
-        else if (squaredDistance < result.top().first) 
+        const KDTreeNode* node;
+        double planeSquaredDistance;
+    };
+
+    PendingNode stack[MAX_TREE_DEPTH];
+    int stackSize = 0;
+    stack[stackSize++] = {start, 0.0};
+
+    while (stackSize > 0)
+    {
+        PendingNode pending = stack[--stackSize];
+        if (heap.Full() && pending.planeSquaredDistance > heap.Top().first)
+            continue;
+
+        const KDTreeNode* node = pending.node;
+        while (node)
         {
-            result.pop();
-            result.push(std::make_pair(squaredDistance, &photon));
+            const Photon& photon = node->photon;
+
+            if (!causticsOnly || photon.isCaustic)
+            {
+                double squaredDistance = (position - photon.position).LengthSquared();
+                heap.Offer(std::make_pair(squaredDistance, &photon));
+            }
+
+            int axis = node->axis;
+            double axisDist = position[axis] - photon.position[axis];
+            double planeSquaredDistance = axisDist * axisDist;
+
+            const KDTreeNode* nearChild = (axisDist < 0) ? node->left.get() : node->right.get();
+            const KDTreeNode* farChild = (axisDist < 0) ? node->right.get() : node->left.get();
+
+            if (farChild && (!heap.Full() || planeSquaredDistance <= heap.Top().first))
+            {
+                if (stackSize < MAX_TREE_DEPTH)
+                    stack[stackSize++] = {farChild, planeSquaredDistance};
+                else
+                    std::cerr << "Error: Photon kd-tree deeper than " << MAX_TREE_DEPTH << std::endl;
+            }
+
+            node = nearChild;
         }
     }
-    
-    int axis = node->axis;
-    double axisDist = position[axis] - photon.position[axis];
-    
-    const KDTreeNode* first = (axisDist < 0) ? node->left.get() : node->right.get();
-    const KDTreeNode* second = (axisDist < 0) ? node->right.get() : node->left.get();
-    
-    FindKNearestPhotonsHelper(first, position, result, k, causticsOnly);
-    
-    double maxSquaredDist = (result.size() < k) ? std::numeric_limits<double>::max() : result.top().first;
-    if (axisDist * axisDist <= maxSquaredDist) 
+}
+
+void PhotonMap::CollectPhotons(std::vector<const Photon*>& result) const
+{
+    result.clear();
+
+    if (backend == PhotonMapBackend::HashGrid)
+    {
+        const std::vector<Photon>& photons = grid.GetPhotons();
+        result.reserve(photons.size());
+        for (const Photon& photon : photons)
+            result.push_back(&photon);
+        return;
+    }
+
+    std::vector<const KDTreeNode*> stack;
+    if (root) stack.push_back(root.get());
+
+    while (!stack.empty())
     {
-        FindKNearestPhotonsHelper(second, position, result, k, causticsOnly);
+        const KDTreeNode* node = stack.back();
+        stack.pop_back();
+
+        result.push_back(&node->photon);
+        if (node->right) stack.push_back(node->right.get());
+        if (node->left) stack.push_back(node->left.get());
     }
 }
 
+bool PhotonMap::SameSurface(const vec3& a, const vec3& b)
+{
+    if (a.LengthSquared() == 0 || b.LengthSquared() == 0)
+        return true;
+    return Dot(a, b) > NORMAL_THRESHOLD * std::sqrt(a.LengthSquared() * b.LengthSquared());
+}
+
 }
\ No newline at end of file
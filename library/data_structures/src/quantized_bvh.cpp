@@ -0,0 +1,326 @@
+#include "quantized_bvh.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <utility>
+
+namespace rcl
+{
+
+namespace
+{
+    // Every quantized bound is decoded as origin + q * scale in double. The product of a float and
+    // a 16-bit integer is exact, so builder and traversal agree on the value to the last bit.
+    double Dequantize(float origin, float scale, uint32_t q)
+    {
+        return static_cast<double>(origin) + q * static_cast<double>(scale);
+    }
+
+    // Float grid covering [min, max] in quantMax steps, origin rounded down and scale up
+    void FitAxis(double min, double max, uint32_t quantMax, float& origin, float& scale)
+    {
+        origin = static_cast<float>(min);
+        if (origin > min)
+            origin = std::nextafter(origin, -std::numeric_limits<float>::infinity());
+
+        scale = static_cast<float>((max - origin) / quantMax);
+        while (Dequantize(origin, scale, quantMax) < max)
+            scale = std::nextafter(scale, std::numeric_limits<float>::infinity());
+    }
+
+    uint32_t QuantizeDown(double value, float origin, float scale, uint32_t quantMax)
+    {
+        if (scale <= 0)
+            return 0;
+
+        double q = std::clamp(std::floor((value - origin) / scale), 0.0, static_cast<double>(quantMax));
+        uint32_t result = static_cast<uint32_t>(q);
+        while (result > 0 && Dequantize(origin, scale, result) > value)
+            result--;
+        return result;
+    }
+
+    uint32_t QuantizeUp(double value, float origin, float scale, uint32_t quantMax)
+    {
+        if (scale <= 0)
+            return 0;
+
+        double q = std::clamp(std::ceil((value - origin) / scale), 0.0, static_cast<double>(quantMax));
+        uint32_t result = static_cast<uint32_t>(q);
+        while (result < quantMax && Dequantize(origin, scale, result) < value)
+            result++;
+        return result;
+    }
+}
+
+template<typename T>
+QuantizedBVH<T>::QuantizedBVH(HittableList list)
+{
+    if (list.objects.empty())
+    {
+        bbox = AABB::empty;
+        return;
+    }
+
+    BVHNode root(list);
+    Collapse(root, 0);
+    bbox = root.BoundingBox();
+    area = root.Area();
+    BuildSampling();
+}
+
+template<typename T>
+QuantizedBVH<T>::QuantizedBVH(const BVHNode& root)
+{
+    Collapse(root, 0);
+    bbox = root.BoundingBox();
+    area = root.Area();
+    BuildSampling();
+}
+
+template<typename T>
+void QuantizedBVH<T>::BuildSampling()
+{
+    std::vector<double> areas(primitives.size());
+    for (size_t i = 0; i < primitives.size(); i++)
+        areas[i] = primitives[i]->Area();
+    primitiveAreas.Build(areas);
+}
+
+// Pulls grandchildren up, always opening the child node with the largest surface,
+// until the node has WIDTH children or only leaves are left
+template<typename T>
+uint32_t QuantizedBVH<T>::Collapse(const BVHNode& node, size_t depth)
+{
+    struct Child
+    {
+        std::shared_ptr<Hittable> object;
+        bool isNode;
+    };
+
+    std::vector<Child> children;
+    children.reserve(WIDTH);
+    auto open = [&children](const BVHNode& parent)
+    {
+        children.push_back(Child{parent.Left(), parent.LeftIsNode()});
+        if (parent.Right() != parent.Left())
+            children.push_back(Child{parent.Right(), parent.RightIsNode()});
+    };
+    open(node);
+
+    while (children.size() < WIDTH)
+    {
+        int largest = -1;
+        double largestSurface = -1;
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            double surface = children[i].object->BoundingBox().SurfaceArea();
+            if (children[i].isNode && surface > largestSurface)
+            {
+                largest = static_cast<int>(i);
+                largestSurface = surface;
+            }
+        }
+        if (largest < 0)
+            break;
+
+        std::shared_ptr<Hittable> opened = children[largest].object;
+        children.erase(children.begin() + largest);
+        open(static_cast<const BVHNode&>(*opened));
+    }
+
+    // Stack entries left behind by one node, plus what its children push
+    maxStack = std::max(maxStack, (depth + 1) * (WIDTH - 1) + 1);
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.emplace_back();
+
+    Node packed;
+    const AABB& box = node.BoundingBox();
+    for (int axis = 0; axis < 3; axis++)
+    {
+        const Interval<double>& range = box.AxisInterval(axis);
+        FitAxis(range.min, range.max, QUANT_MAX, packed.origin[axis], packed.scale[axis]);
+    }
+
+    for (int i = 0; i < WIDTH; i++)
+    {
+        if (i >= static_cast<int>(children.size()))
+        {
+            for (int axis = 0; axis < 3; axis++)
+            {
+                packed.low[axis][i] = static_cast<T>(QUANT_MAX);
+                packed.high[axis][i] = 0;
+            }
+            packed.child[i] = EMPTY;
+            continue;
+        }
+
+        const AABB& childBox = children[i].object->BoundingBox();
+        for (int axis = 0; axis < 3; axis++)
+        {
+            const Interval<double>& range = childBox.AxisInterval(axis);
+            packed.low[axis][i] = static_cast<T>(QuantizeDown(range.min, packed.origin[axis], packed.scale[axis], QUANT_MAX));
+            packed.high[axis][i] = static_cast<T>(QuantizeUp(range.max, packed.origin[axis], packed.scale[axis], QUANT_MAX));
+        }
+
+        if (children[i].isNode)
+        {
+            packed.child[i] = Collapse(static_cast<const BVHNode&>(*children[i].object), depth + 1);
+        }
+        else
+        {
+            packed.child[i] = LEAF | static_cast<uint32_t>(primitives.size());
+            primitives.push_back(children[i].object);
+        }
+    }
+
+    nodes[index] = packed;
+    return index;
+}
+
+template<typename T>
+bool QuantizedBVH<T>::hit(const Ray& ray, const Interval<double>& interval, HitRecord& record) const
+{
+    if (nodes.empty() || !bbox.Hit(ray, interval))
+        return false;
+
+    struct Entry
+    {
+        double distance;
+        uint32_t ref;
+    };
+
+    // Deep trees, only possible with very unbalanced input, fall back to the heap
+    Entry localStack[LOCAL_STACK];
+    std::vector<Entry> heapStack;
+    Entry* stack = localStack;
+    if (maxStack > LOCAL_STACK)
+    {
+        heapStack.resize(maxStack);
+        stack = heapStack.data();
+    }
+
+    double origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+    double inverse[3] = {1.0 / ray.direction.x, 1.0 / ray.direction.y, 1.0 / ray.direction.z};
+
+    double closest = interval.max;
+    bool hitAnything = false;
+    size_t size = 0;
+    stack[size++] = Entry{interval.min, 0};
+
+    while (size > 0)
+    {
+        Entry entry = stack[--size];
+        if (entry.distance >= closest)
+            continue;
+
+        if (entry.ref & LEAF)
+        {
+            if (primitives[entry.ref & ~LEAF]->hit(ray, Interval<double>(interval.min, closest), record))
+            {
+                closest = record.distance;
+                hitAnything = true;
+            }
+            continue;
+        }
+
+        const Node& node = nodes[entry.ref];
+        Entry hits[WIDTH];
+        int hitCount = 0;
+
+        for (int i = 0; i < WIDTH && node.child[i] != EMPTY; i++)
+        {
+            double tMin = interval.min;
+            double tMax = closest;
+            for (int axis = 0; axis < 3 && tMin < tMax; axis++)
+            {
+                double t0 = (Dequantize(node.origin[axis], node.scale[axis], node.low[axis][i]) - origin[axis]) * inverse[axis];
+                double t1 = (Dequantize(node.origin[axis], node.scale[axis], node.high[axis][i]) - origin[axis]) * inverse[axis];
+                if (t0 > t1)
+                    std::swap(t0, t1);
+                if (t0 > tMin) tMin = t0;
+                if (t1 < tMax) tMax = t1;
+            }
+            if (tMax <= tMin)
+                continue;
+
+            // Sorted nearest first
+            int at = hitCount++;
+            while (at > 0 && hits[at - 1].distance > tMin)
+            {
+                hits[at] = hits[at - 1];
+                at--;
+            }
+            hits[at] = Entry{tMin, node.child[i]};
+        }
+
+        // Nearest child on top, once something is hit farther children are skipped
+        for (int i = hitCount - 1; i >= 0; i--)
+            stack[size++] = hits[i];
+    }
+
+    return hitAnything;
+}
+
+template<typename T>
+const AABB& QuantizedBVH<T>::BoundingBox() const
+{
+    return bbox;
+}
+
+template<typename T>
+double QuantizedBVH<T>::Area() const
+{
+    return area;
+}
+
+// Primitives are picked by area, so points are uniform over the surface, density 1 / Area()
+template<typename T>
+vec3 QuantizedBVH<T>::RandomPointOnSurface() const
+{
+    if (primitiveAreas.Empty())
+        return primitives.empty() ? vec3(0) : primitives[0]->RandomPointOnSurface();
+    return primitives[primitiveAreas.Sample()]->RandomPointOnSurface();
+}
+
+template<typename T>
+Ray QuantizedBVH<T>::RandomRayFromSurface() const
+{
+    if (primitiveAreas.Empty())
+        return primitives.empty() ? Ray(vec3(0), vec3(0, 1, 0)) : primitives[0]->RandomRayFromSurface();
+    return primitives[primitiveAreas.Sample()]->RandomRayFromSurface();
+}
+
+template<typename T>
+std::shared_ptr<Material> QuantizedBVH<T>::GetMaterial() const
+{
+    return nullptr;
+}
+
+template<typename T>
+size_t QuantizedBVH<T>::NodeCount() const
+{
+    return nodes.size();
+}
+
+template<typename T>
+size_t QuantizedBVH<T>::PrimitiveCount() const
+{
+    return primitives.size();
+}
+
+template<typename T>
+double QuantizedBVH<T>::BytesPerPrimitive() const
+{
+    if (primitives.empty())
+        return 0;
+    size_t bytes = nodes.size() * sizeof(Node) + primitives.size() * sizeof(std::shared_ptr<Hittable>);
+    return static_cast<double>(bytes) / primitives.size();
+}
+
+template class QuantizedBVH<uint8_t>;
+template class QuantizedBVH<uint16_t>;
+
+}
\ No newline at end of file
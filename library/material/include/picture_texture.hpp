@@ -2,6 +2,7 @@
 #define RCL_PICTURE_TEXTURE
 
 #include <memory>
+#include <vector>
 
 #include "texture.hpp"
 #include "picture.hpp"
@@ -9,17 +10,57 @@
 namespace rcl
 {
 
+enum class TextureFilter
+{
+    // The texel the point falls in, of the full resolution level
+    Nearest,
+    // Blend of the 4 nearest texels of the mip level closest to the footprint
+    Bilinear,
+    // Bilinear in the two levels around the footprint, blended between them
+    Trilinear
+};
+
+// How each mip level is made from the one above it
+enum class MipFilter
+{
+    // Average of the 2x2 texels, 3 wide along odd sizes
+    Box,
+    // Kaiser windowed sinc over 4 texels on each side, sharper than the box
+    Kaiser
+};
+
+// Texture from a picture. A mip pyramid, the picture halved again and again down to 1x1, is built
+// when the picture is set, rows in parallel. Lookups with a footprint read the level whose texels
+// are about as large, so distant or grazing surfaces do not alias and need fewer samples per pixel.
 class PictureTexture : public Texture
 {
 public:
-    PictureTexture(const char* path);
+    PictureTexture(const char* path, TextureFilter filter = TextureFilter::Trilinear, MipFilter mipFilter = MipFilter::Box);
+    PictureTexture(std::shared_ptr<Picture> picture, TextureFilter filter = TextureFilter::Trilinear, MipFilter mipFilter = MipFilter::Box);
 
+    // The full resolution level
     color GetColor(const uv& uv) const override;
+    color GetColor(const uv& uv, float footprint) const override;
 
     void SetPicture(std::shared_ptr<Picture> copy);
     void SetPicture(const char* path);
+    void SetFilter(TextureFilter filter);
+    // Rebuilds the pyramid
+    void SetMipFilter(MipFilter filter);
+
+    // Level 0 is the picture itself
+    int GetLevelCount() const;
+    const Picture& GetLevel(int level) const;
 private:
     std::shared_ptr<Picture> pic;
+    // Levels 1 and down
+    std::vector<Picture> levels;
+    TextureFilter filter;
+    MipFilter mipFilter;
+
+    void BuildLevels();
+    color Nearest(const Picture& level, const uv& uv) const;
+    color Bilinear(const Picture& level, const uv& uv) const;
 };
 
 }
@@ -11,6 +11,9 @@ class Texture
 public: 
     virtual ~Texture() = default; 
     virtual color GetColor(const uv&  uv) const = 0;
+    // footprint is the width in UV units of the area the lookup stands for, as
+    // HitRecord::UVFootprint gives it. Textures without detail to filter ignore it.
+    virtual color GetColor(const uv& uv, float /*footprint*/) const { return GetColor(uv); }
 };
 
 }
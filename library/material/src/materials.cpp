@@ -18,7 +18,7 @@ const
 {
     auto PDF = std::make_shared<CosinePDF>(rec.normal);
     scatterRec.skipBRDF = false;
-    scatterRec.albedo = albedo->GetColor(rec.uv);
+    scatterRec.albedo = albedo->GetColor(rec.uv, rec.UVFootprint(in));
     scatterRec.outVec = PDF->Generate(in, rec);
     scatterRec.probability = PDF->Probability(in, rec, rcl::Ray(rec.point, scatterRec.outVec));
     return true;
@@ -28,7 +28,7 @@ rcl::vec3 Lambertian::BRDF
 (const rcl::Ray& in, const rcl::HitRecord& rec, const rcl::Ray& scattered)
 const 
 {
-    return albedo->GetColor(rec.uv) / rcl::PI;
+    return albedo->GetColor(rec.uv, rec.UVFootprint(in)) / rcl::PI;
 }
 
 Metal::Metal(const std::shared_ptr<rcl::Texture>& c, double roughness, double metallic) 
@@ -57,7 +57,7 @@ const
         scatterRec.outVec = PDF->Generate(in, rec);
         scatterRec.probability = PDF->Probability(in, rec, rcl::Ray(rec.point, scatterRec.outVec));
     }
-    scatterRec.albedo = albedo->GetColor(rec.uv);
+    scatterRec.albedo = albedo->GetColor(rec.uv, rec.UVFootprint(in));
     return true;
 }
 
@@ -154,7 +154,7 @@ const
     if (NoH <= 0.0) return rcl::vec3(0.0);
     
     double alpha = roughness * roughness;
-    rcl::vec3 baseColor = albedo->GetColor(rec.uv);
+    rcl::vec3 baseColor = albedo->GetColor(rec.uv, rec.UVFootprint(in));
    
     // Compute components of the Cook-Torrance specular BRDF
     rcl::vec3 F_term = F(baseColor, v, h);
@@ -209,7 +209,7 @@ const
     
     // For glass materials, we don't want to modulate the albedo in the same way as metals
     // Just pass the albedo directly
-    scatterRec.albedo = albedo->GetColor(rec.uv);
+    scatterRec.albedo = albedo->GetColor(rec.uv, rec.UVFootprint(in));
     
     scatterRec.skipBRDF = true;
     return true;
@@ -253,7 +253,7 @@ const
         return vec3(fresnel); // White specular reflection
     } else {
         // For refraction, use the albedo color
-        return albedo->GetColor(rec.uv) * (1.0 - fresnel);
+        return albedo->GetColor(rec.uv, rec.UVFootprint(ray_in)) * (1.0 - fresnel);
     }
 }
 
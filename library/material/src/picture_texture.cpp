@@ -1,25 +1,320 @@
 #include "picture_texture.hpp"
 
 #include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include <future>
+
+#include "constants.hpp"
 
 namespace rcl
 {
 
-PictureTexture::PictureTexture(const char* path) : pic(std::make_shared<Picture>(path)) {}
+namespace
+{
+    // Kaiser window shape, and its half width in texels of the smaller level
+    const double KAISER_ALPHA = 4.0;
+    const double KAISER_RADIUS = 2.0;
+    // Levels with fewer rows are filtered on the calling thread
+    const int PARALLEL_MIN_ROWS = 64;
+
+    struct Tap
+    {
+        int index;
+        float weight;
+    };
+
+    // Modified Bessel function of the first kind, order 0, by its power series
+    double BesselI0(double x)
+    {
+        double sum = 1;
+        double term = 1;
+        for (int k = 1; k < 32; k++)
+        {
+            term *= (x / (2 * k)) * (x / (2 * k));
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return sum;
+    }
+
+    double KaiserSinc(double t)
+    {
+        double x = t / KAISER_RADIUS;
+        if (std::fabs(x) >= 1)
+            return 0;
+        double sinc = t == 0 ? 1 : std::sin(PI * t) / (PI * t);
+        return sinc * BesselI0(KAISER_ALPHA * std::sqrt(1 - x * x)) / BesselI0(KAISER_ALPHA);
+    }
+
+    // Source texels and their weights behind each of the size texels along an axis of sourceSize
+    std::vector<std::vector<Tap>> AxisTaps(int sourceSize, int size, MipFilter filter)
+    {
+        std::vector<std::vector<Tap>> taps(size);
+        for (int x = 0; x < size; x++)
+        {
+            if (size == sourceSize)
+            {
+                taps[x].push_back({x, 1.0f});
+            }
+            else if (filter == MipFilter::Box && sourceSize == 2 * size)
+            {
+                taps[x].push_back({2 * x, 0.5f});
+                taps[x].push_back({2 * x + 1, 0.5f});
+            }
+            else if (filter == MipFilter::Box)
+            {
+                // 2 * size + 1 texels onto size, each smaller texel covers 2 + 1 / size of them
+                float scale = 1.0f / (2 * size + 1);
+                taps[x].push_back({2 * x, (size - x) * scale});
+                taps[x].push_back({2 * x + 1, size * scale});
+                taps[x].push_back({2 * x + 2, (x + 1) * scale});
+            }
+            else
+            {
+                // Distances in texels of the smaller level, edges repeat the outermost texel
+                double scale = double(sourceSize) / size;
+                double center = (x + 0.5) * scale;
+                int first = static_cast<int>(std::floor(center - KAISER_RADIUS * scale));
+                int last = static_cast<int>(std::ceil(center + KAISER_RADIUS * scale));
+                double total = 0;
+                for (int i = first; i <= last; i++)
+                {
+                    double weight = KaiserSinc((i + 0.5 - center) / scale);
+                    if (weight == 0)
+                        continue;
+                    taps[x].push_back({std::max(0, std::min(i, sourceSize - 1)), static_cast<float>(weight)});
+                    total += weight;
+                }
+                for (Tap& tap : taps[x])
+                    tap.weight = static_cast<float>(tap.weight / total);
+            }
+        }
+        return taps;
+    }
+
+    // Runs work(begin, end) on contiguous parts of [0, rows), one per hardware thread
+    template<typename Work>
+    void ParallelRows(int rows, Work work)
+    {
+        unsigned int numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1; // fallback if detection fails
+        if (rows < PARALLEL_MIN_ROWS) numThreads = 1;
+
+        int perThread = rows / numThreads;
+        int remainder = rows % numThreads;
+
+        std::vector<std::future<void>> futures;
+        int begin = 0;
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            int end = begin + perThread + (static_cast<int>(t) < remainder ? 1 : 0);
+            futures.push_back(std::async(std::launch::async, work, begin, end));
+            begin = end;
+        }
+
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+    }
+
+    // The next level: half the size, floored, rows then columns filtered
+    Picture Downsample(const Picture& source, MipFilter filter)
+    {
+        int sourceWidth = source.GetWidth();
+        int sourceHeight = source.GetHeight();
+        int width = std::max(1, sourceWidth / 2);
+        int height = std::max(1, sourceHeight / 2);
+        const vec3* in = source.GetData();
+
+        // Even sizes, the usual case, average 2x2 blocks in one pass
+        if (filter == MipFilter::Box && sourceWidth == 2 * width && sourceHeight == 2 * height)
+        {
+            Picture level(width, height);
+            vec3* data = level.GetData();
+            ParallelRows(height, [&](int begin, int end)
+            {
+                for (int y = begin; y < end; y++)
+                {
+                    const vec3* top = in + static_cast<size_t>(2 * y) * sourceWidth;
+                    const vec3* bottom = top + sourceWidth;
+                    vec3* out = data + static_cast<size_t>(y) * width;
+                    for (int x = 0; x < width; x++)
+                        out[x] = (top[2 * x] + top[2 * x + 1] + bottom[2 * x] + bottom[2 * x + 1]) * 0.25f;
+                }
+            });
+            return level;
+        }
+
+        std::vector<std::vector<Tap>> tapsX = AxisTaps(sourceWidth, width, filter);
+        std::vector<std::vector<Tap>> tapsY = AxisTaps(sourceHeight, height, filter);
+
+        Picture across(width, sourceHeight);
+        vec3* mid = across.GetData();
+        ParallelRows(sourceHeight, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; y++)
+            {
+                const vec3* row = in + static_cast<size_t>(y) * sourceWidth;
+                vec3* out = mid + static_cast<size_t>(y) * width;
+                for (int x = 0; x < width; x++)
+                {
+                    vec3 sum(0.0f);
+                    for (const Tap& tap : tapsX[x])
+                        sum += row[tap.index] * tap.weight;
+                    out[x] = sum;
+                }
+            }
+        });
+
+        Picture level(width, height);
+        vec3* data = level.GetData();
+        ParallelRows(height, [&](int begin, int end)
+        {
+            for (int y = begin; y < end; y++)
+            {
+                vec3* out = data + static_cast<size_t>(y) * width;
+                for (const Tap& tap : tapsY[y])
+                {
+                    const vec3* row = mid + static_cast<size_t>(tap.index) * width;
+                    for (int x = 0; x < width; x++)
+                        out[x] += row[x] * tap.weight;
+                }
+                // The sinc's negative lobes can undershoot next to sharp edges
+                if (filter == MipFilter::Kaiser)
+                {
+                    for (int x = 0; x < width; x++)
+                        out[x] = vec3(std::max(out[x].r, 0.0f), std::max(out[x].g, 0.0f), std::max(out[x].b, 0.0f));
+                }
+            }
+        });
+
+        return level;
+    }
+}
+
+PictureTexture::PictureTexture(const char* path, TextureFilter filter, MipFilter mipFilter)
+: PictureTexture(std::make_shared<Picture>(path), filter, mipFilter) {}
+
+PictureTexture::PictureTexture(std::shared_ptr<Picture> picture, TextureFilter filter, MipFilter mipFilter)
+: pic(picture), filter(filter), mipFilter(mipFilter)
+{
+    BuildLevels();
+}
 
 vec3 PictureTexture::GetColor(const vec2& uv) const
 {
-    return pic->GetPixel(uv);
+    return GetColor(uv, 0.0f);
+}
+
+vec3 PictureTexture::GetColor(const vec2& uv, float footprint) const
+{
+    if (!pic || !pic->GetData())
+        return vec3(0.0f);
+    if (filter == TextureFilter::Nearest)
+        return Nearest(*pic, uv);
+
+    // Texels of the full level across the footprint, each level down halves them
+    float texels = footprint * std::sqrt(static_cast<float>(pic->GetWidth()) * pic->GetHeight());
+    float lod = texels > 1 ? std::log2(texels) : 0.0f;
+    lod = std::min(lod, static_cast<float>(GetLevelCount() - 1));
+
+    if (filter == TextureFilter::Bilinear)
+        return Bilinear(GetLevel(static_cast<int>(lod + 0.5f)), uv);
+
+    int fine = static_cast<int>(lod);
+    float blend = lod - fine;
+    vec3 color = Bilinear(GetLevel(fine), uv);
+    if (blend > 0)
+        color = color * (1 - blend) + Bilinear(GetLevel(fine + 1), uv) * blend;
+    return color;
+}
+
+vec3 PictureTexture::Nearest(const Picture& level, const vec2& uv) const
+{
+    int width = level.GetWidth();
+    int height = level.GetHeight();
+    float u = std::max(0.0f, std::min(1.0f, uv.x));
+    float v = std::max(0.0f, std::min(1.0f, uv.y));
+    int x = std::min(static_cast<int>(u * width), width - 1);
+    int y = std::min(static_cast<int>((1.0f - v) * height), height - 1);
+    return level.GetData()[static_cast<size_t>(y) * width + x];
+}
+
+vec3 PictureTexture::Bilinear(const Picture& level, const vec2& uv) const
+{
+    int width = level.GetWidth();
+    int height = level.GetHeight();
+
+    // Clamped to the edges as GetPixel does, V flipped since rows start from the top.
+    // Texel centers sit at half steps, so every level lines up with the others.
+    float u = std::max(0.0f, std::min(1.0f, uv.x));
+    float v = std::max(0.0f, std::min(1.0f, uv.y));
+    float x = std::max(0.0f, std::min(u * width - 0.5f, static_cast<float>(width - 1)));
+    float y = std::max(0.0f, std::min((1.0f - v) * height - 0.5f, static_cast<float>(height - 1)));
+
+    int x0 = static_cast<int>(x);
+    int y0 = static_cast<int>(y);
+    int x1 = std::min(x0 + 1, width - 1);
+    int y1 = std::min(y0 + 1, height - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+
+    const vec3* top = level.GetData() + static_cast<size_t>(y0) * width;
+    const vec3* bottom = level.GetData() + static_cast<size_t>(y1) * width;
+    vec3 upper = top[x0] * (1 - fx) + top[x1] * fx;
+    vec3 lower = bottom[x0] * (1 - fx) + bottom[x1] * fx;
+    return upper * (1 - fy) + lower * fy;
 }
 
 void PictureTexture::SetPicture(std::shared_ptr<Picture> copy)
 {
     pic = copy;
+    BuildLevels();
 }
 
 void PictureTexture::SetPicture(const char* path)
 {
     pic = std::make_shared<Picture>(path);
+    BuildLevels();
+}
+
+void PictureTexture::SetFilter(TextureFilter textureFilter)
+{
+    filter = textureFilter;
+}
+
+void PictureTexture::SetMipFilter(MipFilter filter)
+{
+    mipFilter = filter;
+    BuildLevels();
+}
+
+int PictureTexture::GetLevelCount() const
+{
+    return pic ? 1 + static_cast<int>(levels.size()) : 0;
+}
+
+const Picture& PictureTexture::GetLevel(int level) const
+{
+    return level == 0 ? *pic : levels[level - 1];
+}
+
+void PictureTexture::BuildLevels()
+{
+    levels.clear();
+    if (!pic || !pic->GetData())
+        return;
+
+    const Picture* above = pic.get();
+    while (above->GetWidth() > 1 || above->GetHeight() > 1)
+    {
+        levels.push_back(Downsample(*above, mipFilter));
+        above = &levels.back();
+    }
 }
 
 }
\ No newline at end of file
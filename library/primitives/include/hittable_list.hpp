@@ -3,15 +3,31 @@
 
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <mutex>
 
 #include "hittable.hpp"
 #include "aabb.hpp"
 #include "material.hpp"
 #include "interval.hpp"
+#include "alias_table.hpp"
 
 namespace rcl
 {
 
+// How RandomPointOnSurface and RandomRayFromSurface pick the object to sample
+enum class SurfaceSampling
+{
+    // By area, so points are uniform over the whole surface with a density of 1 / Area()
+    Area,
+    // By area times emitted luminance, for lists of lights. Objects without a material are never
+    // picked, and when nothing emits nothing is: sampling returns what it does for an empty list.
+    Power
+};
+
+// Surface sampling picks objects from an alias table over the areas kept by Add and Append, built by
+// the first sample after the list changed. Objects pushed into the vector directly are sampled
+// uniformly instead.
 class HittableList : public Hittable 
 {
 public:
@@ -24,14 +40,41 @@ public:
     void Clear();
 
     void Add(std::shared_ptr<Hittable> object);
+    // Moves every object of another list in, reusing its bounds and area instead of visiting them again
+    void Append(HittableList&& list);
+
+    // Area by default
+    void SetSurfaceSampling(SurfaceSampling sampling);
+    SurfaceSampling GetSurfaceSampling() const;
 
     bool hit(const Ray& r, const Interval<double>& interval, HitRecord& rec) const override;
     const AABB& BoundingBox() const override;
+    double Area() const override;
     vec3 RandomPointOnSurface() const override;
     Ray RandomRayFromSurface() const override;
     std::shared_ptr<Material> GetMaterial() const override;
 private:
-    AABB bbox;
+    AABB bbox = AABB::empty;
+    double area = 0;
+    std::vector<double> areas;
+    SurfaceSampling surfaceSampling = SurfaceSampling::Area;
+
+    // Built under the mutex by whichever thread samples first, copies start over unbuilt
+    struct Sampler
+    {
+        AliasTable table;
+        std::atomic<bool> built{false};
+        std::mutex mutex;
+
+        Sampler() = default;
+        Sampler(const Sampler&) {}
+        Sampler& operator=(const Sampler&) { Invalidate(); return *this; }
+        void Invalidate() { built.store(false, std::memory_order_release); }
+    };
+    mutable Sampler sampler;
+
+    // Null when there is nothing to pick
+    const Hittable* Pick() const;
 };
 
 }//namespace rcl
@@ -0,0 +1,40 @@
+#ifndef RCL_INDEXED_TRIANGLE
+#define RCL_INDEXED_TRIANGLE
+
+#include <memory>
+#include <cstdint>
+
+#include "hittable.hpp"
+#include "mesh_buffers.hpp"
+
+namespace rcl
+{
+
+// Triangle of an indexed mesh. Keeps only its number, the vertices are read from
+// the shared MeshBuffers, so corners used by several triangles are stored once.
+class IndexedTriangle : public Hittable
+{
+public:
+    IndexedTriangle(std::shared_ptr<const rcl::MeshBuffers> buffers, uint32_t triangle);
+
+    uint32_t GetTriangle() const;
+
+    bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const override;
+
+    const rcl::AABB& BoundingBox() const override;
+    double Area() const override;
+
+    rcl::vec3 RandomPointOnSurface() const override;
+    rcl::Ray RandomRayFromSurface() const override;
+    std::shared_ptr<rcl::Material> GetMaterial() const override;
+    bool FaceNormal(rcl::vec3& normal) const override;
+private:
+    std::shared_ptr<const rcl::MeshBuffers> buffers;
+    uint32_t triangle;
+    rcl::AABB bbox;
+
+    const rcl::vec3& Position(int corner) const;
+};
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+#ifndef RCL_INSTANCE
+#define RCL_INSTANCE
+
+#include <memory>
+
+#include "hittable.hpp"
+#include "transform.hpp"
+#include "material.hpp"
+
+namespace rcl
+{
+
+// Places a shared, immutable bottom-level object (a Mesh or a BVHNode) in the world
+// through an affine transform. Rays are moved into object space, so any number of
+// instances reuse one copy of the geometry and its BVH. A BVHNode over instances
+// is the top level; moving instances only rebuilds that small tree.
+class Instance : public Hittable
+{
+public:
+    Instance(std::shared_ptr<const rcl::Hittable> object, const rcl::Transform& transform,
+             std::shared_ptr<rcl::Material> mat = nullptr);
+
+    void SetTransform(const rcl::Transform& transform);
+    const rcl::Transform& GetTransform() const;
+
+    bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const override;
+
+    const rcl::AABB& BoundingBox() const override;
+    double Area() const override;
+
+    rcl::vec3 RandomPointOnSurface() const override;
+    rcl::Ray RandomRayFromSurface() const override;
+    std::shared_ptr<rcl::Material> GetMaterial() const override;
+
+private:
+    std::shared_ptr<const rcl::Hittable> object;
+    std::shared_ptr<rcl::Material> mat;
+    rcl::Transform objectToWorld;
+    rcl::Transform worldToObject;
+    rcl::AABB bbox;
+    double areaScale;
+};
+
+}
+#endif
\ No newline at end of file
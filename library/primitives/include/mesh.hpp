@@ -5,7 +5,8 @@
 
 #include "hittable.hpp"
 #include "hittable_list.hpp"
-#include "vertex_triangle.hpp"
+#include "mesh_buffers.hpp"
+#include "alias_table.hpp"
 #include "material.hpp"
 
 namespace rcl
@@ -16,20 +17,31 @@ class Mesh : public Hittable
 public:
     Mesh() = delete;
 
-    Mesh(const char* file, std::shared_ptr<rcl::Material> mat);
+    // With useCache the built BVH is kept next to the source as <file>.rclbvh
+    // and reused by later imports as long as the source is unchanged.
+    // With reorder triangles and vertices are sorted along a Morton curve before the BVH is built.
+    Mesh(const char* file, std::shared_ptr<rcl::Material> mat, bool useCache = true, bool reorder = true);
 
     void Import(const char* file);
 
     bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const;
 
     const rcl::AABB& BoundingBox() const;
+    double Area() const override;
 
     rcl::vec3 RandomPointOnSurface() const override;
     rcl::Ray RandomRayFromSurface() const override;
     std::shared_ptr<rcl::Material> GetMaterial() const override;
 private:
+    std::shared_ptr<rcl::MeshBuffers> buffers;
     rcl::HittableList triangles;
+    rcl::AliasTable triangleAreas;
     std::shared_ptr<rcl::Material> mat;
+    bool useCache;
+    bool reorder;
+
+    void BuildSampling();
+    size_t SampleTriangle(double& u, double& v) const;
 };
 
 }
@@ -0,0 +1,46 @@
+#ifndef RCL_MESH_BUFFERS
+#define RCL_MESH_BUFFERS
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#include "vector.hpp"
+#include "hittable_list.hpp"
+
+namespace rcl
+{
+
+// Indexed triangle mesh: per-vertex attribute arrays and three indices per triangle.
+// normals and uvs are either empty or as long as positions.
+struct MeshBuffers
+{
+    std::vector<vec3> positions;
+    std::vector<vec3> normals;
+    std::vector<vec2> uvs;
+    std::vector<uint32_t> indices;
+
+    size_t TriangleCount() const;
+    void Clear();
+
+    // Triangles are expected to index existing vertices, these do not check
+    double TriangleArea(size_t triangle) const;
+    // Point at barycentric (u, v), the corners are weighted 1 - u - v, u and v
+    vec3 TrianglePoint(size_t triangle, double u, double v) const;
+    // Interpolated shading normal at (u, v), the face normal when there are no normals
+    vec3 TriangleNormal(size_t triangle, double u, double v) const;
+};
+
+// Adds a VertexTriangle per indexed triangle, triangles without normals get the face one.
+// Triangles referencing a missing vertex are skipped, the count of skipped ones is returned.
+size_t BuildTriangles(const MeshBuffers& buffers, HittableList& triangles);
+
+// Same, but adds IndexedTriangles that share the buffers instead of copying their corners
+size_t BuildIndexedTriangles(std::shared_ptr<const MeshBuffers> buffers, HittableList& triangles);
+
+// Sorts triangles by the Morton code of their centroids and renumbers vertices in order of
+// first use, so triangles close in space, and the vertices they read, are close in memory
+void ReorderForLocality(MeshBuffers& buffers);
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#ifndef RCL_MESH_CACHE
+#define RCL_MESH_CACHE
+
+#include <memory>
+#include <cstdint>
+
+#include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
+#include "bvh.hpp"
+
+namespace rcl
+{
+    // Identifies a cache entry: hash of the source file contents, the cache format, the BVH
+    // builder and any import option that changes the result. Returns 0 if the source can not be read.
+    uint64_t MeshCacheKey(const char* sourcePath, uint32_t importOptions);
+
+    // Restores the mesh buffers and the BVH over their triangles from a file written by SaveMeshCache.
+    // The file is mapped, the arrays are bulk copied and the tree is rebuilt from its flat node
+    // list, no parsing or sorting happens. Fails when the file is missing, truncated or was made
+    // for another key.
+    bool LoadMeshCache(const char* cachePath, uint64_t key, std::shared_ptr<MeshBuffers> buffers, HittableList& triangles);
+
+    // Flattens a BVH whose leaves are IndexedTriangles of buffers, returns false if it holds
+    // anything else or the file can not be written
+    bool SaveMeshCache(const char* cachePath, uint64_t key, const MeshBuffers& buffers, const BVHNode& root);
+}
+
+#endif
\ No newline at end of file
@@ -2,10 +2,22 @@
 #define RCL_MODEL_WORKERS
 
 #include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
 
 namespace rcl
 {
-    void ImportOBJ(const char* path, HittableList& triangles);
+    // The file is parsed in chunkCount line-aligned parts at once. The default of 0 gives one part
+    // per hardware thread, each at least a megabyte; the result is the same for any count.
+    void ImportOBJ(const char* path, HittableList& triangles, size_t chunkCount = 0);
+    // Identical v/vt/vn triples become one vertex shared through the index buffer
+    void ImportOBJ(const char* path, MeshBuffers& buffers, size_t chunkCount = 0);
+
+    // ASCII and binary (either byte order) PLY, polygons are triangulated as fans
+    void ImportPLY(const char* path, MeshBuffers& buffers);
+
+    // Native .rclmesh: a small header followed by the raw MeshBuffers arrays
+    void ImportRCLMesh(const char* path, MeshBuffers& buffers);
+    bool ExportRCLMesh(const char* path, const MeshBuffers& buffers);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+#ifndef RCL_PAGED_MESH
+#define RCL_PAGED_MESH
+
+#include <memory>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+#include "hittable.hpp"
+#include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
+#include "mapped_file.hpp"
+#include "alias_table.hpp"
+#include "material.hpp"
+
+namespace rcl
+{
+
+// Splits a mesh into clusters of nearby triangles and writes them compressed to a paged
+// mesh file (.rclpage). Positions are snapped to one 24-bit grid over the whole mesh, so
+// clusters sharing a vertex decode it to the same point and stay watertight. Normals are
+// octahedral encoded and uvs quantized to 16 bits per component, indices are cluster local bytes.
+// Clusters come from median splits of the triangle centroids, so they are compact in space and
+// neighbours in space are close in the file.
+bool WritePagedMesh(const char* path, const MeshBuffers& buffers, uint32_t trianglesPerCluster = 64);
+
+// Mesh rendered straight from a paged mesh file without loading it. Only the cluster table and
+// a quantized BVH over cluster bounds stay resident, a few bytes per triangle. Clusters are decoded
+// when a ray first reaches them and kept in an LRU cache bounded by cacheBytes, least recently used
+// ones are dropped when it is full. Each thread also keeps the last clusters it used, but only ones
+// the cache holds and counts, and gives them back when the cache is over budget. Resident clusters
+// can outgrow cacheBytes by about one cluster per rendering thread, until those threads fetch again.
+class PagedMesh : public Hittable
+{
+public:
+    struct CacheStats
+    {
+        uint64_t hits;
+        uint64_t misses;
+        uint64_t evictions;
+        size_t residentBytes;
+        size_t residentClusters;
+    };
+
+    PagedMesh() = delete;
+    PagedMesh(const char* file, std::shared_ptr<rcl::Material> mat, size_t cacheBytes = size_t(256) << 20);
+
+    PagedMesh(const PagedMesh&) = delete;
+    PagedMesh& operator=(const PagedMesh&) = delete;
+
+    bool IsOpen() const;
+    size_t ClusterCount() const;
+    size_t TriangleCount() const;
+    CacheStats GetCacheStats() const;
+
+    bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const override;
+
+    const rcl::AABB& BoundingBox() const override;
+    double Area() const override;
+
+    rcl::vec3 RandomPointOnSurface() const override;
+    rcl::Ray RandomRayFromSurface() const override;
+    std::shared_ptr<rcl::Material> GetMaterial() const override;
+private:
+    friend bool WritePagedMesh(const char* path, const MeshBuffers& buffers, uint32_t trianglesPerCluster);
+
+    // Entry of the cluster table, stored as is in the file
+    struct ClusterInfo
+    {
+        float bounds[6];
+        float uvMin[2];
+        float uvScale[2];
+        uint64_t offset;
+        uint32_t size;
+        uint16_t vertexCount;
+        uint16_t triangleCount;
+        uint32_t flags;
+        float area;
+    };
+
+    // Cluster expanded to floats, shared so a ray keeps it alive while the cache evicts it
+    struct Cluster
+    {
+        std::vector<rcl::vec3> positions;
+        std::vector<rcl::vec3> normals;
+        std::vector<rcl::vec2> uvs;
+        std::vector<uint8_t> indices;
+        std::vector<rcl::AABB> groups;
+
+        size_t Bytes() const;
+    };
+
+    // BVH leaf standing for one cluster, hit() fetches the cluster through the cache
+    class ClusterProxy;
+
+    struct CacheEntry
+    {
+        std::shared_ptr<const Cluster> cluster;
+        std::list<uint32_t>::iterator position;
+    };
+
+    rcl::MappedFile file;
+    std::vector<ClusterInfo> clusters;
+    rcl::AliasTable clusterAreas;
+    rcl::HittableList root;
+    std::shared_ptr<rcl::Material> mat;
+    double origin[3];
+    double step;
+    bool hasNormals = false;
+    bool hasUVs = false;
+    size_t triangleCount = 0;
+    uint64_t id;
+
+    mutable std::mutex cacheMutex;
+    mutable std::list<uint32_t> recentlyUsed;
+    mutable std::unordered_map<uint32_t, CacheEntry> cache;
+    mutable size_t residentBytes = 0;
+    size_t cacheBytes;
+    // Bumped when the cache needs this mesh's clusters back from the threads' front caches
+    mutable std::atomic<uint64_t> frontGeneration{0};
+
+    mutable std::atomic<uint64_t> hits{0};
+    mutable std::atomic<uint64_t> misses{0};
+    mutable std::atomic<uint64_t> evictions{0};
+
+    bool Open(const char* path);
+    bool HitCluster(uint32_t cluster, const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const;
+    const Cluster* Fetch(uint32_t cluster) const;
+    std::shared_ptr<const Cluster> Decode(uint32_t cluster) const;
+    rcl::vec3 SamplePoint(const Cluster& cluster, rcl::vec3& normal) const;
+};
+
+}
+#endif
\ No newline at end of file
@@ -18,6 +18,7 @@ public:
     void SetBoundingBox();
 
     const rcl::AABB& BoundingBox() const override;
+    double Area() const override;
 
     bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const override;
 
@@ -26,6 +27,7 @@ public:
     rcl::vec3 RandomPointOnSurface() const override;
     rcl::Ray RandomRayFromSurface() const override;
     std::shared_ptr<rcl::Material> GetMaterial() const override;
+    bool FaceNormal(rcl::vec3& normal) const override;
 
 private:
     rcl::vec3 Q;
@@ -36,6 +38,8 @@ private:
     rcl::vec3 normal;
     std::shared_ptr<rcl::Material> mat;
     double D;
+    // The unit UV square covers the quad
+    float uvDensity;
 };
 
 }
@@ -16,6 +16,7 @@ public:
     bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const override;
 
     const rcl::AABB& BoundingBox() const override;
+    double Area() const override;
 
     rcl::vec3 RandomPointOnSurface() const override;
     rcl::Ray RandomRayFromSurface() const override;
@@ -25,14 +25,20 @@ class VertexTriangle : public Hittable
 public:
     VertexTriangle(rcl::Vertex a, rcl::Vertex b, rcl::Vertex c);
 
+    // For deforming meshes, refit the owning BVH afterwards
+    void SetVertices(const rcl::Vertex& a, const rcl::Vertex& b, const rcl::Vertex& c);
+    const rcl::Vertex& GetVertex(int index) const;
+
     void SetBoundingBox();
     const rcl::AABB& BoundingBox() const;
+    double Area() const override;
 
     bool hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const;
 
     rcl::vec3 RandomPointOnSurface() const override;
     rcl::Ray RandomRayFromSurface() const override;
     std::shared_ptr<rcl::Material> GetMaterial() const override;
+    bool FaceNormal(rcl::vec3& normal) const override;
 private:
     rcl::AABB bbox;
     rcl::Vertex a;
@@ -1,6 +1,11 @@
 #include "hittable_list.hpp"
 
 #include <iostream>
+#include <iterator>
+#include <utility>
+#include <algorithm>
+
+#include "functions.hpp"
 
 namespace rcl
 {
@@ -18,12 +23,46 @@ rcl::HittableList::~HittableList()
 void rcl::HittableList::Clear() 
 { 
     objects.clear(); 
+    areas.clear();
+    bbox = AABB::empty;
+    area = 0;
+    sampler.Invalidate();
 }
 
 void rcl::HittableList::Add(std::shared_ptr<Hittable> object) 
 {
     objects.push_back(object);
     bbox = rcl::AABB(bbox, object->BoundingBox());
+    areas.push_back(object->Area());
+    area += areas.back();
+    sampler.Invalidate();
+}
+
+void rcl::HittableList::Append(HittableList&& list)
+{
+    if (objects.empty())
+        objects = std::move(list.objects);
+    else
+        objects.insert(objects.end(), std::make_move_iterator(list.objects.begin()), std::make_move_iterator(list.objects.end()));
+
+    // A list filled directly has no areas to take, which leaves this one sampled uniformly as well
+    areas.insert(areas.end(), list.areas.begin(), list.areas.end());
+
+    bbox = rcl::AABB(bbox, list.bbox);
+    area += list.area;
+    sampler.Invalidate();
+    list.Clear();
+}
+
+void rcl::HittableList::SetSurfaceSampling(SurfaceSampling sampling)
+{
+    surfaceSampling = sampling;
+    sampler.Invalidate();
+}
+
+SurfaceSampling rcl::HittableList::GetSurfaceSampling() const
+{
+    return surfaceSampling;
 }
 
 bool HittableList::hit(const Ray& r, const Interval<double>& interval, HitRecord& rec) const 
@@ -52,14 +91,50 @@ const AABB& HittableList::BoundingBox() const
     return bbox;
 }
     
+double HittableList::Area() const
+{
+    return area;
+}
+
+// Objects are picked in constant time with a probability proportional to their area, or to their
+// power for light lists. Lists without area pick uniformly, light lists without power not at all.
+const Hittable* HittableList::Pick() const
+{
+    if (objects.empty())
+        return nullptr;
+    if (areas.size() != objects.size())
+        return objects[RandomIntMinMax(0, static_cast<int>(objects.size()) - 1)].get();
+
+    if (!sampler.built.load(std::memory_order_acquire))
+    {
+        std::lock_guard<std::mutex> lock(sampler.mutex);
+        if (!sampler.built.load(std::memory_order_relaxed))
+        {
+            std::vector<double> weights = areas;
+            for (size_t i = 0; i < objects.size() && surfaceSampling == SurfaceSampling::Power; i++)
+                weights[i] *= Luminance(EmitterRadiance(*objects[i]));
+            sampler.table.Build(weights);
+            sampler.built.store(true, std::memory_order_release);
+        }
+    }
+
+    if (!sampler.table.Empty())
+        return objects[sampler.table.Sample()].get();
+    if (surfaceSampling == SurfaceSampling::Power)
+        return nullptr;
+    return objects[RandomIntMinMax(0, static_cast<int>(objects.size()) - 1)].get();
+}
+
 vec3 HittableList::RandomPointOnSurface() const
 {
-    return objects[RandomIntMinMax(0, objects.size())]->RandomPointOnSurface();
+    const Hittable* picked = Pick();
+    return picked ? picked->RandomPointOnSurface() : vec3(0);
 }
     
 Ray HittableList::RandomRayFromSurface() const
 {
-    return objects[RandomIntMinMax(0, objects.size())]->RandomRayFromSurface();
+    const Hittable* picked = Pick();
+    return picked ? picked->RandomRayFromSurface() : Ray(vec3(0), vec3(0, 1, 0));
 }
     
 std::shared_ptr<Material> HittableList::GetMaterial() const
@@ -0,0 +1,109 @@
+#include "indexed_triangle.hpp"
+
+#include <cmath>
+
+#include "functions.hpp"
+
+rcl::IndexedTriangle::IndexedTriangle(std::shared_ptr<const rcl::MeshBuffers> buffers, uint32_t triangle)
+: buffers(buffers), triangle(triangle)
+{
+    bbox = rcl::AABB(rcl::AABB(Position(0), Position(1)), rcl::AABB(Position(0), Position(2)));
+}
+
+uint32_t rcl::IndexedTriangle::GetTriangle() const
+{
+    return triangle;
+}
+
+const rcl::vec3& rcl::IndexedTriangle::Position(int corner) const
+{
+    return buffers->positions[buffers->indices[triangle * 3 + corner]];
+}
+
+bool rcl::IndexedTriangle::hit
+(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record)
+const
+{
+    const rcl::vec3& a = Position(0);
+    rcl::vec3 e1 = Position(1) - a;
+    rcl::vec3 e2 = Position(2) - a;
+    rcl::vec3 P = rcl::Cross(ray.direction, e2);
+    double dotPe1 = rcl::Dot(P, e1);
+
+    if (std::fabs(dotPe1) <= 1e-8)
+        return false;
+
+    double invDotPe1 = 1 / dotPe1;
+    rcl::vec3 T = ray.origin - a;
+    double u = rcl::Dot(P, T) * invDotPe1;
+
+    if(u > 1 || u < 0)
+        return false;
+
+    rcl::vec3 Q = rcl::Cross(T, e1);
+    double v = rcl::Dot(Q, ray.direction) * invDotPe1;
+
+    if(u + v > 1 || v < 0)
+        return false;
+
+    double t = rcl::Dot(Q, e2) * invDotPe1;
+
+    if(!interval.Contains(t))
+        return false;
+
+    record.distance = t;
+    record.point = ray.At(t);
+
+    if (buffers->uvs.empty())
+    {
+        record.uv = rcl::vec2(u, v);
+        record.uvDensity = rcl::HitRecord::TriangleUVDensity(e1, e2, rcl::vec2(0, 0), rcl::vec2(1, 0), rcl::vec2(0, 1));
+    }
+    else
+    {
+        const uint32_t* index = &buffers->indices[triangle * 3];
+        record.uv = (1 - u - v) * buffers->uvs[index[0]] + u * buffers->uvs[index[1]] + v * buffers->uvs[index[2]];
+        record.uvDensity = rcl::HitRecord::TriangleUVDensity(e1, e2, buffers->uvs[index[0]], buffers->uvs[index[1]], buffers->uvs[index[2]]);
+    }
+    record.SetNormal(ray, buffers->TriangleNormal(triangle, u, v));
+
+    return true;
+}
+
+const rcl::AABB& rcl::IndexedTriangle::BoundingBox() const
+{
+    return bbox;
+}
+
+double rcl::IndexedTriangle::Area() const
+{
+    return buffers->TriangleArea(triangle);
+}
+
+rcl::vec3 rcl::IndexedTriangle::RandomPointOnSurface() const
+{
+    double u, v;
+    rcl::RandomBarycentric(u, v);
+    return buffers->TrianglePoint(triangle, u, v);
+}
+
+rcl::Ray rcl::IndexedTriangle::RandomRayFromSurface() const
+{
+    double u, v;
+    rcl::RandomBarycentric(u, v);
+    return rcl::Ray(buffers->TrianglePoint(triangle, u, v), rcl::Ray::RandomCosineOnHemisphere(buffers->TriangleNormal(triangle, u, v)));
+}
+
+std::shared_ptr<rcl::Material> rcl::IndexedTriangle::GetMaterial() const
+{
+    return nullptr;
+}
+
+bool rcl::IndexedTriangle::FaceNormal(rcl::vec3& normal) const
+{
+    rcl::vec3 n = rcl::Cross(Position(1) - Position(0), Position(2) - Position(0));
+    if (n.LengthSquared() <= 0)
+        return false;
+    normal = n.Unit();
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "instance.hpp"
+
+#include <cmath>
+
+rcl::Instance::Instance
+(std::shared_ptr<const rcl::Hittable> object, const rcl::Transform& transform, std::shared_ptr<rcl::Material> mat)
+: object(object), mat(mat)
+{
+    SetTransform(transform);
+}
+
+void rcl::Instance::SetTransform(const rcl::Transform& transform)
+{
+    objectToWorld = transform;
+    worldToObject = transform.Inverse();
+
+    const rcl::AABB& objectBox = object->BoundingBox();
+    if (objectBox.x.Size() < 0 || objectBox.y.Size() < 0 || objectBox.z.Size() < 0)
+        bbox = rcl::AABB::empty;
+    else
+        bbox = objectToWorld.ApplyBox(objectBox);
+
+    // Exact for uniform scale, an average for non-uniform one
+    areaScale = std::pow(std::fabs(objectToWorld.Determinant()), 2.0 / 3.0);
+}
+
+const rcl::Transform& rcl::Instance::GetTransform() const
+{
+    return objectToWorld;
+}
+
+bool rcl::Instance::hit
+(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record)
+const
+{
+    rcl::vec3 localDirection = worldToObject.ApplyVector(ray.direction);
+    double scale = localDirection.Length();
+    if (scale <= 0)
+        return false;
+
+    // Ray keeps its direction unit length, so distances are rescaled between spaces
+    rcl::Ray localRay(worldToObject.ApplyPoint(ray.origin), localDirection);
+    rcl::Interval<double> localInterval(interval.min * scale, interval.max * scale);
+
+    if (!object->hit(localRay, localInterval, record))
+        return false;
+
+    rcl::vec3 outwardNormal = record.frontFace ? record.normal : -record.normal;
+
+    record.distance /= scale;
+    // Object space distances are scale times the world ones, UV changes that much faster in world
+    record.uvDensity *= static_cast<float>(scale);
+    record.point = objectToWorld.ApplyPoint(record.point);
+    record.SetNormal(ray, worldToObject.ApplyTransposed(outwardNormal).Unit());
+    if (mat)
+        record.mat = mat;
+    record.object = this;
+
+    return true;
+}
+
+const rcl::AABB& rcl::Instance::BoundingBox() const
+{
+    return bbox;
+}
+
+double rcl::Instance::Area() const
+{
+    return object->Area() * areaScale;
+}
+
+rcl::vec3 rcl::Instance::RandomPointOnSurface() const
+{
+    return objectToWorld.ApplyPoint(object->RandomPointOnSurface());
+}
+
+rcl::Ray rcl::Instance::RandomRayFromSurface() const
+{
+    rcl::Ray local = object->RandomRayFromSurface();
+    return rcl::Ray(objectToWorld.ApplyPoint(local.origin), objectToWorld.ApplyVector(local.direction));
+}
+
+std::shared_ptr<rcl::Material> rcl::Instance::GetMaterial() const
+{
+    return mat ? mat : object->GetMaterial();
+}
\ No newline at end of file
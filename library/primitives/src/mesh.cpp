@@ -6,9 +6,12 @@
 #include <algorithm>
 
 #include "bvh.hpp"
+#include "functions.hpp"
 #include "model_workers.hpp"
+#include "mesh_cache.hpp"
 
-rcl::Mesh::Mesh(const char* path, std::shared_ptr<rcl::Material> mat) : mat(mat)
+rcl::Mesh::Mesh(const char* path, std::shared_ptr<rcl::Material> mat, bool useCache, bool reorder) 
+: mat(mat), useCache(useCache), reorder(reorder)
 {
     Import(path);
 }
@@ -16,25 +19,61 @@ rcl::Mesh::Mesh(const char* path, std::shared_ptr<rcl::Material> mat) : mat(mat)
 void rcl::Mesh::Import(const char* path)
 {
     triangles.Clear();
+    triangleAreas.Clear();
+    auto loaded = std::make_shared<rcl::MeshBuffers>();
 
-    std::string ext = strrchr(path, '.');
-    if (!ext.size())
+    std::string cachePath = std::string(path) + ".rclbvh";
+    uint64_t cacheKey = useCache ? rcl::MeshCacheKey(path, reorder ? 1 : 0) : 0;
+    if (cacheKey && rcl::LoadMeshCache(cachePath.c_str(), cacheKey, loaded, triangles))
+    {
+        buffers = loaded;
+        BuildSampling();
+        return;
+    }
+
+    const char* extension = strrchr(path, '.');
+    if (!extension)
     {
         std::cerr << "Error: No file extension found in " << path << std::endl;
         return;
     }
-    
+
+    std::string ext = extension;
     std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
     if (strcmp(ext.c_str(), ".obj") == 0)
     {
-        ImportOBJ(path, triangles);
+        ImportOBJ(path, *loaded);
+    }
+    else if (strcmp(ext.c_str(), ".ply") == 0)
+    {
+        ImportPLY(path, *loaded);
+    }
+    else if (strcmp(ext.c_str(), ".rclmesh") == 0)
+    {
+        ImportRCLMesh(path, *loaded);
     }
     else
     {
         std::cerr << "Error: Unsupported file format " << ext << std::endl;
     }
-	
-    triangles = rcl::HittableList(std::make_shared<rcl::BVHNode>(triangles));
+
+    if (reorder)
+        rcl::ReorderForLocality(*loaded);
+
+    size_t skipped = rcl::BuildIndexedTriangles(loaded, triangles);
+    if (skipped)
+        std::cerr << "Error: " << skipped << " triangles with out of range indices skipped in " << path << std::endl;
+
+    buffers = loaded;
+    if (triangles.objects.empty())
+        return;
+    BuildSampling();
+
+    auto root = std::make_shared<rcl::BVHNode>(triangles);
+    triangles = rcl::HittableList(root);
+
+    if (cacheKey)
+        rcl::SaveMeshCache(cachePath.c_str(), cacheKey, *buffers, *root);
 }
 
 bool rcl::Mesh::hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const
@@ -53,14 +92,50 @@ const rcl::AABB& rcl::Mesh::BoundingBox() const
     return triangles.BoundingBox();
 }
 
+double rcl::Mesh::Area() const
+{
+    return triangles.Area();
+}
+
+// Triangles with indices out of range get no weight, they are not in the BVH either
+void rcl::Mesh::BuildSampling()
+{
+    size_t vertexCount = buffers->positions.size();
+    std::vector<double> areas(buffers->TriangleCount());
+    for (size_t triangle = 0; triangle < areas.size(); triangle++)
+    {
+        const uint32_t* index = &buffers->indices[triangle * 3];
+        bool valid = index[0] < vertexCount && index[1] < vertexCount && index[2] < vertexCount;
+        areas[triangle] = valid ? buffers->TriangleArea(triangle) : 0;
+    }
+    triangleAreas.Build(areas);
+}
+
+// Triangle picked by area and a uniform point on it, points are uniform over the mesh, density 1 / Area()
+size_t rcl::Mesh::SampleTriangle(double& u, double& v) const
+{
+    rcl::RandomBarycentric(u, v);
+    return triangleAreas.Sample();
+}
+
 rcl::vec3 rcl::Mesh::RandomPointOnSurface() const
 {
-    return triangles.objects[rcl::RandomIntMinMax(0, triangles.objects.size())]->RandomPointOnSurface();
+    if (triangleAreas.Empty())
+        return rcl::vec3(0);
+
+    double u, v;
+    size_t triangle = SampleTriangle(u, v);
+    return buffers->TrianglePoint(triangle, u, v);
 }
     
 rcl::Ray rcl::Mesh::RandomRayFromSurface() const
 {
-    return triangles.objects[rcl::RandomIntMinMax(0, triangles.objects.size())]->RandomRayFromSurface(); 
+    if (triangleAreas.Empty())
+        return rcl::Ray(rcl::vec3(0), rcl::vec3(0, 1, 0));
+
+    double u, v;
+    size_t triangle = SampleTriangle(u, v);
+    return rcl::Ray(buffers->TrianglePoint(triangle, u, v), rcl::Ray::RandomCosineOnHemisphere(buffers->TriangleNormal(triangle, u, v)));
 }
 
 std::shared_ptr<rcl::Material> rcl::Mesh::GetMaterial() const
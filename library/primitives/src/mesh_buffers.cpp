@@ -0,0 +1,254 @@
+#include "mesh_buffers.hpp"
+
+#include <memory>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <type_traits>
+
+#include "vertex_triangle.hpp"
+#include "indexed_triangle.hpp"
+
+namespace rcl
+{
+
+namespace
+{
+    constexpr size_t MIN_TRIANGLES_FOR_PARALLEL = 1 << 16;
+
+    bool ValidTriangle(const MeshBuffers& buffers, size_t triangle)
+    {
+        const uint32_t* index = &buffers.indices[triangle * 3];
+        size_t vertexCount = buffers.positions.size();
+        return index[0] < vertexCount && index[1] < vertexCount && index[2] < vertexCount;
+    }
+
+    std::shared_ptr<Hittable> MakeVertexTriangle(const MeshBuffers& buffers, size_t triangle)
+    {
+        const uint32_t* index = &buffers.indices[triangle * 3];
+
+        Vertex corners[3];
+        for (int i = 0; i < 3; i++)
+        {
+            corners[i].coord = buffers.positions[index[i]];
+            corners[i].uv = buffers.uvs.empty() ? vec2(0.0f) : buffers.uvs[index[i]];
+        }
+
+        if (!buffers.normals.empty())
+        {
+            for (int i = 0; i < 3; i++)
+                corners[i].normal = buffers.normals[index[i]];
+        }
+        else
+        {
+            vec3 faceNormal = Cross(corners[1].coord - corners[0].coord, corners[2].coord - corners[0].coord);
+            if (faceNormal.LengthSquared() > 0)
+                faceNormal = faceNormal.Unit();
+            for (int i = 0; i < 3; i++)
+                corners[i].normal = faceNormal;
+        }
+
+        return std::make_shared<VertexTriangle>(corners[0], corners[1], corners[2]);
+    }
+
+    // Runs make(triangle) for every valid triangle in parallel ranges, returns the skipped count
+    template<typename Make>
+    size_t BuildInParallel(const MeshBuffers& buffers, HittableList& triangles, const Make& make)
+    {
+        size_t triangleCount = buffers.TriangleCount();
+
+        size_t numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0 || triangleCount < MIN_TRIANGLES_FOR_PARALLEL)
+            numThreads = 1;
+
+        std::vector<HittableList> parts(numThreads);
+        auto buildRange = [&](size_t part)
+        {
+            size_t first = triangleCount * part / numThreads;
+            size_t last = triangleCount * (part + 1) / numThreads;
+            size_t skipped = 0;
+
+            parts[part].objects.reserve(last - first);
+            for (size_t triangle = first; triangle < last; triangle++)
+            {
+                if (ValidTriangle(buffers, triangle))
+                    parts[part].Add(make(triangle));
+                else
+                    skipped++;
+            }
+            return skipped;
+        };
+
+        std::vector<std::future<size_t>> futures;
+        for (size_t i = 1; i < numThreads; i++)
+            futures.push_back(std::async(std::launch::async, buildRange, i));
+
+        size_t skipped = buildRange(0);
+        for (auto& future : futures)
+            skipped += future.get();
+
+        for (HittableList& part : parts)
+            triangles.Append(std::move(part));
+
+        return skipped;
+    }
+
+    // Spreads the low 10 bits of value so two zero bits follow each of them
+    uint32_t SpreadBits(uint32_t value)
+    {
+        value &= 0x3FF;
+        value = (value | (value << 16)) & 0x030000FF;
+        value = (value | (value << 8)) & 0x0300F00F;
+        value = (value | (value << 4)) & 0x030C30C3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+}
+
+size_t MeshBuffers::TriangleCount() const
+{
+    return indices.size() / 3;
+}
+
+void MeshBuffers::Clear()
+{
+    positions.clear();
+    normals.clear();
+    uvs.clear();
+    indices.clear();
+}
+
+double MeshBuffers::TriangleArea(size_t triangle) const
+{
+    const uint32_t* index = &indices[triangle * 3];
+    const vec3& a = positions[index[0]];
+    return 0.5 * Cross(positions[index[1]] - a, positions[index[2]] - a).Length();
+}
+
+vec3 MeshBuffers::TrianglePoint(size_t triangle, double u, double v) const
+{
+    const uint32_t* index = &indices[triangle * 3];
+    const vec3& a = positions[index[0]];
+    return a + (positions[index[1]] - a) * u + (positions[index[2]] - a) * v;
+}
+
+vec3 MeshBuffers::TriangleNormal(size_t triangle, double u, double v) const
+{
+    const uint32_t* index = &indices[triangle * 3];
+    vec3 normal;
+    if (normals.empty())
+    {
+        const vec3& a = positions[index[0]];
+        normal = Cross(positions[index[1]] - a, positions[index[2]] - a);
+    }
+    else
+    {
+        normal = normals[index[0]] * (1 - u - v) + normals[index[1]] * u + normals[index[2]] * v;
+    }
+    return normal.LengthSquared() > 0 ? normal.Unit() : normal;
+}
+
+size_t BuildTriangles(const MeshBuffers& buffers, HittableList& triangles)
+{
+    return BuildInParallel(buffers, triangles, [&buffers](size_t triangle)
+    {
+        return MakeVertexTriangle(buffers, triangle);
+    });
+}
+
+size_t BuildIndexedTriangles(std::shared_ptr<const MeshBuffers> buffers, HittableList& triangles)
+{
+    return BuildInParallel(*buffers, triangles, [&buffers](size_t triangle) -> std::shared_ptr<Hittable>
+    {
+        return std::make_shared<IndexedTriangle>(buffers, static_cast<uint32_t>(triangle));
+    });
+}
+
+void ReorderForLocality(MeshBuffers& buffers)
+{
+    size_t triangleCount = buffers.TriangleCount();
+    size_t vertexCount = buffers.positions.size();
+    if (triangleCount < 2)
+        return;
+
+    std::vector<vec3> centroids(triangleCount);
+    vec3 low(std::numeric_limits<float>::max());
+    vec3 high(std::numeric_limits<float>::lowest());
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        vec3 centroid(0.0f);
+        for (int i = 0; i < 3; i++)
+        {
+            uint32_t index = buffers.indices[triangle * 3 + i];
+            if (index < vertexCount)
+                centroid += buffers.positions[index];
+        }
+        centroid /= 3.0f;
+        centroids[triangle] = centroid;
+
+        low = vec3(std::min(low.x, centroid.x), std::min(low.y, centroid.y), std::min(low.z, centroid.z));
+        high = vec3(std::max(high.x, centroid.x), std::max(high.y, centroid.y), std::max(high.z, centroid.z));
+    }
+
+    // 10 bits per axis over the centroid bounds
+    vec3 extent = high - low;
+    float scale[3] = {extent.x > 0 ? 1023.0f / extent.x : 0.0f,
+                      extent.y > 0 ? 1023.0f / extent.y : 0.0f,
+                      extent.z > 0 ? 1023.0f / extent.z : 0.0f};
+
+    std::vector<std::pair<uint32_t, uint32_t>> order(triangleCount);
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        const vec3& c = centroids[triangle];
+        uint32_t code = (SpreadBits(static_cast<uint32_t>((c.x - low.x) * scale[0])) << 2)
+                      | (SpreadBits(static_cast<uint32_t>((c.y - low.y) * scale[1])) << 1)
+                      |  SpreadBits(static_cast<uint32_t>((c.z - low.z) * scale[2]));
+        order[triangle] = {code, static_cast<uint32_t>(triangle)};
+    }
+    std::sort(order.begin(), order.end());
+
+    // Vertices get new ids in the order the sorted triangles first touch them
+    const uint32_t UNSEEN = 0xFFFFFFFFu;
+    std::vector<uint32_t> remap(vertexCount, UNSEEN);
+    std::vector<uint32_t> indices(buffers.indices.size());
+    uint32_t nextVertex = 0;
+
+    for (size_t i = 0; i < triangleCount; i++)
+    {
+        for (int corner = 0; corner < 3; corner++)
+        {
+            uint32_t index = buffers.indices[order[i].second * 3 + corner];
+            if (index < vertexCount)
+            {
+                if (remap[index] == UNSEEN)
+                    remap[index] = nextVertex++;
+                index = remap[index];
+            }
+            indices[i * 3 + corner] = index;
+        }
+    }
+
+    // Vertices no triangle uses go last, keeping their relative order
+    for (size_t vertex = 0; vertex < vertexCount; vertex++)
+        if (remap[vertex] == UNSEEN)
+            remap[vertex] = nextVertex++;
+
+    auto permute = [&remap](auto& attribute)
+    {
+        if (attribute.empty())
+            return;
+        std::remove_reference_t<decltype(attribute)> reordered(attribute.size());
+        for (size_t vertex = 0; vertex < attribute.size(); vertex++)
+            reordered[remap[vertex]] = attribute[vertex];
+        attribute = std::move(reordered);
+    };
+
+    permute(buffers.positions);
+    permute(buffers.normals);
+    permute(buffers.uvs);
+    buffers.indices = std::move(indices);
+}
+
+}
\ No newline at end of file
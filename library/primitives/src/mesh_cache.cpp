@@ -0,0 +1,256 @@
+#include "mesh_cache.hpp"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <random>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define RCL_HAS_POSIX_RENAME
+#endif
+
+#include "functions.hpp"
+#include "mapped_file.hpp"
+#include "indexed_triangle.hpp"
+
+namespace rcl
+{
+
+namespace
+{
+    constexpr char CACHE_MAGIC[8] = {'R', 'C', 'L', 'B', 'V', 'H', 0, 0};
+    constexpr uint32_t CACHE_VERSION = 2;
+
+    constexpr uint32_t HAS_NORMALS = 1;
+    constexpr uint32_t HAS_UVS = 2;
+
+    // Followed by the MeshBuffers arrays (positions, normals, uvs, indices) and the nodes
+    struct CacheHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t key;
+        uint64_t vertexCount;
+        uint64_t indexCount;
+        uint64_t nodeCount;
+    };
+
+    // Children are stored before their parent, the root is the last node.
+    // A child that is not a node is the number of a triangle.
+    struct CachedNode
+    {
+        uint32_t left;
+        uint32_t right;
+        uint32_t flags;
+    };
+
+    constexpr uint32_t LEFT_IS_NODE = 1;
+    constexpr uint32_t RIGHT_IS_NODE = 2;
+
+    // Tells writers in different processes apart, a random draw where there is no process id
+    unsigned long WriterId()
+    {
+#ifdef RCL_HAS_POSIX_RENAME
+        return static_cast<unsigned long>(getpid());
+#else
+        static const unsigned long id = std::random_device()();
+        return id;
+#endif
+    }
+
+    // Returns false when a leaf is not a triangle of the mesh
+    bool Flatten(const BVHNode& node, const MeshBuffers& buffers, std::vector<CachedNode>& nodes, uint32_t& index)
+    {
+        CachedNode cached = {0, 0, 0};
+        const std::shared_ptr<Hittable>* children[2] = {&node.Left(), &node.Right()};
+        bool childIsNode[2] = {node.LeftIsNode(), node.RightIsNode()};
+        uint32_t* targets[2] = {&cached.left, &cached.right};
+
+        for (int i = 0; i < 2; i++)
+        {
+            if (childIsNode[i])
+            {
+                if (!Flatten(static_cast<const BVHNode&>(**children[i]), buffers, nodes, *targets[i]))
+                    return false;
+                continue;
+            }
+
+            const IndexedTriangle* triangle = dynamic_cast<const IndexedTriangle*>(children[i]->get());
+            if (!triangle || triangle->GetTriangle() >= buffers.TriangleCount())
+                return false;
+            *targets[i] = triangle->GetTriangle();
+        }
+
+        cached.flags = (node.LeftIsNode() ? LEFT_IS_NODE : 0) | (node.RightIsNode() ? RIGHT_IS_NODE : 0);
+        index = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(cached);
+        return true;
+    }
+
+    template<typename T>
+    void ReadArray(const char*& p, std::vector<T>& target, size_t count)
+    {
+        target.resize(count);
+        std::memcpy(target.data(), p, count * sizeof(T));
+        p += count * sizeof(T);
+    }
+
+    template<typename T>
+    void WriteArray(std::ofstream& file, const std::vector<T>& source)
+    {
+        file.write(reinterpret_cast<const char*>(source.data()), source.size() * sizeof(T));
+    }
+}
+
+uint64_t MeshCacheKey(const char* sourcePath, uint32_t importOptions)
+{
+    MappedFile source(sourcePath);
+    if (!source.IsOpen())
+        return 0;
+
+    uint32_t parameters[4] = {CACHE_VERSION, static_cast<uint32_t>(BVHNode::BUILDER_VERSION), sizeof(vec3), importOptions};
+    uint64_t key = HashBytes(parameters, sizeof(parameters));
+    key = HashBytes(source.Data(), source.Size(), key);
+
+    return key ? key : 1;
+}
+
+bool LoadMeshCache(const char* cachePath, uint64_t key, std::shared_ptr<MeshBuffers> buffers, HittableList& triangles)
+{
+    MappedFile file(cachePath);
+    if (!file.IsOpen() || file.Size() < sizeof(CacheHeader))
+        return false;
+
+    CacheHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 ||
+        header.version != CACHE_VERSION || header.key != key ||
+        header.indexCount == 0 || header.indexCount % 3 != 0 || header.nodeCount == 0)
+        return false;
+
+    bool hasNormals = header.flags & HAS_NORMALS;
+    bool hasUVs = header.flags & HAS_UVS;
+    size_t expectedSize = sizeof(CacheHeader)
+                        + header.vertexCount * sizeof(vec3) * (hasNormals ? 2 : 1)
+                        + header.vertexCount * (hasUVs ? sizeof(vec2) : 0)
+                        + header.indexCount * sizeof(uint32_t)
+                        + header.nodeCount * sizeof(CachedNode);
+    if (file.Size() != expectedSize)
+        return false;
+
+    const char* p = file.Data() + sizeof(CacheHeader);
+    buffers->Clear();
+    ReadArray(p, buffers->positions, header.vertexCount);
+    if (hasNormals) ReadArray(p, buffers->normals, header.vertexCount);
+    if (hasUVs) ReadArray(p, buffers->uvs, header.vertexCount);
+    ReadArray(p, buffers->indices, header.indexCount);
+
+    for (uint32_t index : buffers->indices)
+    {
+        if (index >= header.vertexCount)
+        {
+            buffers->Clear();
+            return false;
+        }
+    }
+
+    std::vector<CachedNode> nodes;
+    ReadArray(p, nodes, header.nodeCount);
+
+    size_t triangleCount = buffers->TriangleCount();
+    std::vector<std::shared_ptr<Hittable>> leaves(triangleCount);
+    auto leaf = [&](uint32_t triangle)
+    {
+        if (!leaves[triangle])
+            leaves[triangle] = std::make_shared<IndexedTriangle>(buffers, triangle);
+        return leaves[triangle];
+    };
+
+    std::vector<std::shared_ptr<Hittable>> built(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const CachedNode& node = nodes[i];
+        bool leftIsNode = node.flags & LEFT_IS_NODE;
+        bool rightIsNode = node.flags & RIGHT_IS_NODE;
+
+        // Children must already exist, anything else means a corrupted file
+        if ((leftIsNode ? node.left >= i : node.left >= triangleCount) ||
+            (rightIsNode ? node.right >= i : node.right >= triangleCount))
+        {
+            buffers->Clear();
+            return false;
+        }
+
+        built[i] = std::make_shared<BVHNode>
+        (
+            leftIsNode ? built[node.left] : leaf(node.left),
+            rightIsNode ? built[node.right] : leaf(node.right),
+            leftIsNode, rightIsNode
+        );
+    }
+
+    triangles = HittableList(built.back());
+    return true;
+}
+
+bool SaveMeshCache(const char* cachePath, uint64_t key, const MeshBuffers& buffers, const BVHNode& root)
+{
+    std::vector<CachedNode> nodes;
+    uint32_t rootIndex;
+    if (!Flatten(root, buffers, nodes, rootIndex))
+        return false;
+
+    bool hasNormals = !buffers.normals.empty();
+    bool hasUVs = !buffers.uvs.empty();
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.flags = (hasNormals ? HAS_NORMALS : 0) | (hasUVs ? HAS_UVS : 0);
+    header.key = key;
+    header.vertexCount = buffers.positions.size();
+    header.indexCount = buffers.indices.size();
+    header.nodeCount = nodes.size();
+
+    // Written aside under a name no other writer uses, writer id and a per process count, then
+    // renamed over the cache in one step, so readers see the old file or the new one, never a mix
+    static std::atomic<uint64_t> nextTemporary{0};
+    std::string temporaryPath = std::string(cachePath) + "." + std::to_string(WriterId()) + "." +
+                                std::to_string(nextTemporary.fetch_add(1)) + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return false;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        WriteArray(file, buffers.positions);
+        WriteArray(file, buffers.normals);
+        WriteArray(file, buffers.uvs);
+        WriteArray(file, buffers.indices);
+        WriteArray(file, nodes);
+        if (!file)
+        {
+            file.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+
+#ifndef RCL_HAS_POSIX_RENAME
+    // Only POSIX rename replaces an existing file
+    std::remove(cachePath);
+#endif
+    if (std::rename(temporaryPath.c_str(), cachePath) != 0)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+}
\ No newline at end of file
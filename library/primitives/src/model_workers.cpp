@@ -2,217 +2,603 @@
 
 #include <vector>
 #include <iostream>
+#include <cstdint>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <future>
+#include <thread>
+#include <algorithm>
+#include <array>
 
 #include "vector.hpp"
 #include "vertex_triangle.hpp"
+#include "mapped_file.hpp"
 
 namespace rcl
 {
 
 namespace
 {
-    void Triangulate(std::vector<Vertex>& verts, HittableList& triangles)
+    constexpr int64_t MISSING_INDEX = std::numeric_limits<int64_t>::min();
+
+    constexpr uint8_t RELATIVE_POSITION = 1;
+    constexpr uint8_t RELATIVE_UV = 2;
+    constexpr uint8_t RELATIVE_NORMAL = 4;
+
+    // Zero-based indices into the attribute arrays, MISSING_INDEX when the face omits one.
+    // Negative OBJ indices are first stored relative to the start of the chunk that read them,
+    // the matching relative bit stays set until ResolveChunk adds the chunk offset.
+    struct FaceCorner
+    {
+        int64_t position;
+        int64_t uv;
+        int64_t normal;
+        uint8_t relative;
+    };
+
+    struct ObjAttributes
+    {
+        std::vector<vec3> positions;
+        std::vector<vec2> uvs;
+        std::vector<vec3> normals;
+    };
+
+    struct ObjChunk
+    {
+        ObjAttributes attributes;
+        std::vector<FaceCorner> corners;
+        std::vector<uint32_t> faceSizes;
+        size_t malformedLines = 0;
+    };
+
+    constexpr size_t MIN_BYTES_PER_CHUNK = 1 << 20;
+
+    bool IsBlank(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    const char* SkipBlanks(const char* p, const char* end)
+    {
+        while (p < end && IsBlank(*p))
+            p++;
+        return p;
+    }
+
+    // A token ends on a blank, the end of the line or a trailing comment
+    bool AtTokenEnd(const char* p, const char* end)
+    {
+        return p == end || IsBlank(*p) || *p == '#';
+    }
+
+    bool ParseFloat(const char*& p, const char* end, float& value)
     {
-        int num = verts.size();
-        if(num < 3) return;
+        p = SkipBlanks(p, end);
+        if (p < end && *p == '+')
+            p++;
 
-        if(num == 3)
+        auto result = std::from_chars(p, end, value);
+        if (result.ec != std::errc() || !AtTokenEnd(result.ptr, end))
+            return false;
+
+        p = result.ptr;
+        return true;
+    }
+
+    // Parses up to count components, the missing ones stay zero
+    bool ParseComponents(const char* p, const char* end, float* components, int required, int count)
+    {
+        for (int i = 0; i < count; i++)
         {
-            triangles.Add(std::make_shared<VertexTriangle>(verts[0], verts[1], verts[2]));
-            return;
+            const char* next = SkipBlanks(p, end);
+            if (next == end || *next == '#')
+                return i >= required;
+
+            if (!ParseFloat(p, end, components[i]))
+                return false;
         }
+        return true;
+    }
+
+    // OBJ indices are one-based, negative ones count back from the last attribute read so far
+    bool ParseIndex(const char*& p, const char* end, size_t countSoFar, int64_t& index, uint8_t& relative, uint8_t bit)
+    {
+        long long raw;
+        auto result = std::from_chars(p, end, raw);
+        if (result.ec != std::errc() || raw == 0)
+            return false;
 
-        for(int i = 3; i < num; i++)
+        p = result.ptr;
+        if (raw > 0)
         {
-            triangles.Add(std::make_shared<VertexTriangle>(verts[0], verts[i-2], verts[i-1]));
+            index = raw - 1;
         }
+        else
+        {
+            index = static_cast<int64_t>(countSoFar) + raw;
+            relative |= bit;
+        }
+        return true;
     }
 
-    void ReadVertexInfo(std::string& str, std::vector<vec3>& vertPos,
-        std::vector<rcl::vec2>& vertTexCoord, std::vector<vec3>& vertNormal)
+    bool ParseCorners(const char* p, const char* end, ObjChunk& chunk)
     {
-        if (str.find("v ") == 0)
+        const ObjAttributes& attributes = chunk.attributes;
+        while (true)
         {
-            int spacePos;
-            rcl::vec3 vNewVertexPos(0.0f);
+            p = SkipBlanks(p, end);
+            if (p == end || *p == '#')
+                break;
 
-            str = str.substr(2, str.size());
-            spacePos = str.find(" ");
-            vNewVertexPos.x = std::stod(str.substr(0, spacePos));
+            FaceCorner corner = {MISSING_INDEX, MISSING_INDEX, MISSING_INDEX, 0};
+            if (!ParseIndex(p, end, attributes.positions.size(), corner.position, corner.relative, RELATIVE_POSITION))
+                return false;
 
-            str = str.substr(spacePos + 1, str.size());
-            spacePos = str.find(" ");
-            vNewVertexPos.y = std::stod(str.substr(0, spacePos));
+            if (p < end && *p == '/')
+            {
+                p++;
+                if (p < end && *p != '/')
+                    if (!ParseIndex(p, end, attributes.uvs.size(), corner.uv, corner.relative, RELATIVE_UV))
+                        return false;
 
-            str = str.substr(spacePos + 1, str.size());
-            vNewVertexPos.z = std::stod(str.substr(0, str.size()));
+                if (p < end && *p == '/')
+                {
+                    p++;
+                    if (!ParseIndex(p, end, attributes.normals.size(), corner.normal, corner.relative, RELATIVE_NORMAL))
+                        return false;
+                }
+            }
 
-            vertPos.push_back(vNewVertexPos);
+            if (!AtTokenEnd(p, end))
+                return false;
+
+            chunk.corners.push_back(corner);
         }
-        else if (str.find("vt ") == 0)
+        return true;
+    }
+
+    // Accepts v, v/vt, v//vn and v/vt/vn corners, a malformed face leaves no corners behind
+    bool ParseFace(const char* p, const char* end, ObjChunk& chunk)
+    {
+        size_t firstCorner = chunk.corners.size();
+        bool parsed = ParseCorners(p, end, chunk);
+
+        size_t faceSize = chunk.corners.size() - firstCorner;
+        if (!parsed || faceSize < 3)
         {
-            rcl::vec2 vNewTexCoord(0.0f);
-            int spacePos;
+            chunk.corners.resize(firstCorner);
+            return false;
+        }
 
-            str = str.substr(3, str.size());
-            spacePos = str.find(" ");
-            vNewTexCoord.x = std::stod(str.substr(0, spacePos));
+        chunk.faceSizes.push_back(static_cast<uint32_t>(faceSize));
+        return true;
+    }
 
-            str = str.substr(spacePos + 1, str.size());
-            vNewTexCoord.y = std::stod(str.substr(0, str.size()));
+    void ParseLine(const char* p, const char* end, ObjChunk& chunk)
+    {
+        ObjAttributes& attributes = chunk.attributes;
+        p = SkipBlanks(p, end);
+        if (end - p < 2)
+            return;
 
-            vertTexCoord.push_back(vNewTexCoord);
+        bool parsed = true;
+        if (p[0] == 'v' && IsBlank(p[1]))
+        {
+            float position[3] = {0, 0, 0};
+            parsed = ParseComponents(p + 2, end, position, 3, 3);
+            attributes.positions.push_back(vec3(position[0], position[1], position[2]));
+        }
+        else if (p[0] == 'v' && p[1] == 't' && end - p > 2 && IsBlank(p[2]))
+        {
+            float uv[2] = {0, 0};
+            parsed = ParseComponents(p + 3, end, uv, 1, 2);
+            attributes.uvs.push_back(vec2(uv[0], uv[1]));
+        }
+        else if (p[0] == 'v' && p[1] == 'n' && end - p > 2 && IsBlank(p[2]))
+        {
+            float normal[3] = {0, 0, 0};
+            parsed = ParseComponents(p + 3, end, normal, 3, 3);
+            attributes.normals.push_back(vec3(normal[0], normal[1], normal[2]));
         }
-        else if (str.find("vn ") == 0)
+        else if (p[0] == 'f' && IsBlank(p[1]))
         {
-            rcl::vec3 vNewVertexNormal(0.0f);
-            int spacePos;
+            parsed = ParseFace(p + 2, end, chunk);
+        }
 
-            str = str.substr(3, str.size());
-            spacePos = str.find(" ");
-            vNewVertexNormal.x = std::stod(str.substr(0, spacePos));
+        // Attributes are kept even when malformed, so later indices stay aligned
+        if (!parsed)
+            chunk.malformedLines++;
+    }
 
-            str = str.substr(spacePos + 1, str.size());
-            spacePos = str.find(" ");
-            vNewVertexNormal.y = std::stod(str.substr(0, spacePos));
+    void ParseRange(const char* begin, const char* end, ObjChunk& chunk)
+    {
+        const char* lineStart = begin;
+        while (lineStart < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+            if (!lineEnd)
+                lineEnd = end;
 
-            str = str.substr(spacePos + 1, str.size());
-            vNewVertexNormal.z = std::stod(str.substr(0, str.size()));
+            ParseLine(lineStart, lineEnd, chunk);
+            lineStart = lineEnd + 1;
+        }
+    }
 
-            vertNormal.push_back(vNewVertexNormal);
+    // Splits the file into chunks that start right after a newline
+    std::vector<const char*> SplitChunks(const char* begin, const char* end, size_t chunkCount)
+    {
+        std::vector<const char*> bounds = {begin};
+        size_t size = end - begin;
+
+        for (size_t i = 1; i < chunkCount; i++)
+        {
+            const char* split = std::max(begin + size * i / chunkCount, bounds.back());
+            const char* newline = static_cast<const char*>(std::memchr(split, '\n', end - split));
+            if (!newline)
+                break;
+            if (newline + 1 > bounds.back())
+                bounds.push_back(newline + 1);
         }
+
+        bounds.push_back(end);
+        return bounds;
     }
 
-    void ReadFaceInfo(std::string& str, std::vector<vec3>& vertPos,
-        std::vector<vec2>& vertTexCoord, std::vector<vec3>& vertNormal, HittableList& triangles)
+    // Runs task(i) for every chunk, the first one on the calling thread
+    template<typename Task>
+    void ForEachChunk(size_t chunkCount, const Task& task)
     {
-        std::vector<Vertex> newVertexes;
-        str = str.substr(2, str.size());
+        std::vector<std::future<void>> futures;
+        for (size_t i = 1; i < chunkCount; i++)
+            futures.push_back(std::async(std::launch::async, [&task, i]() { task(i); }));
+
+        if (chunkCount > 0)
+            task(0);
+        for (auto& future : futures)
+            future.wait();
+    }
 
-        if(str.find("//") != str.npos)
+    void ResolveChunk(ObjChunk& chunk, const size_t offsets[3])
+    {
+        for (FaceCorner& corner : chunk.corners)
         {
-            while (str.size())
-            {
-                Vertex newVertex;
-                int spacePos;
+            if (!corner.relative)
+                continue;
 
-                spacePos = str.find("//");
-                newVertex.coord = vertPos[std::stoi(str.substr(0, spacePos)) - 1];
-                str = str.substr(spacePos + 2, str.size());
+            if (corner.relative & RELATIVE_POSITION) corner.position += offsets[0];
+            if (corner.relative & RELATIVE_UV) corner.uv += offsets[1];
+            if (corner.relative & RELATIVE_NORMAL) corner.normal += offsets[2];
+            corner.relative = 0;
+        }
+    }
 
-                spacePos = str.find(" ");
-                newVertex.normal = vertNormal[std::stoi(str.substr(0, spacePos)) - 1];
+    template<typename T>
+    void AppendAt(std::vector<T>& target, size_t offset, const std::vector<T>& source)
+    {
+        std::copy(source.begin(), source.end(), target.begin() + offset);
+    }
 
-                newVertexes.push_back(newVertex);
+    bool InRange(int64_t index, size_t size)
+    {
+        return index >= 0 && index < static_cast<int64_t>(size);
+    }
 
-                if(spacePos == -1) break;
-                str = str.substr(spacePos, str.size());
+    bool MakeVertex(const ObjAttributes& attributes, const FaceCorner& corner, Vertex& vertex, bool& hasNormal)
+    {
+        if (!InRange(corner.position, attributes.positions.size()) ||
+            (corner.uv != MISSING_INDEX && !InRange(corner.uv, attributes.uvs.size())) ||
+            (corner.normal != MISSING_INDEX && !InRange(corner.normal, attributes.normals.size())))
+            return false;
+
+        vertex.coord = attributes.positions[corner.position];
+        vertex.uv = corner.uv == MISSING_INDEX ? vec2(0.0f) : attributes.uvs[corner.uv];
+        vertex.normal = corner.normal == MISSING_INDEX ? vec3(0.0f) : attributes.normals[corner.normal];
+        hasNormal = corner.normal != MISSING_INDEX;
+        return true;
+    }
 
-            }
-        }
-        else if (str.find("/") != str.npos)
+    // Faces are fanned around their first corner, corners without a normal get the face one
+    size_t BuildTriangles(const ObjAttributes& attributes, const ObjChunk& chunk, HittableList& triangles)
+    {
+        size_t skippedFaces = 0;
+        size_t triangleCount = 0;
+        for (uint32_t faceSize : chunk.faceSizes)
+            triangleCount += faceSize - 2;
+        triangles.objects.reserve(triangles.objects.size() + triangleCount);
+
+        std::vector<Vertex> face;
+        std::vector<char> hasNormal;
+        size_t cornerIndex = 0;
+
+        for (uint32_t faceSize : chunk.faceSizes)
         {
-            int slashPos;
-            int spacePos;
+            face.resize(faceSize);
+            hasNormal.resize(faceSize);
+
+            bool valid = true;
+            for (uint32_t i = 0; i < faceSize; i++)
+            {
+                bool normal = false;
+                valid &= MakeVertex(attributes, chunk.corners[cornerIndex + i], face[i], normal);
+                hasNormal[i] = normal;
+            }
+            cornerIndex += faceSize;
+
+            if (!valid)
+            {
+                skippedFaces++;
+                continue;
+            }
 
-            slashPos = str.find("/");
-            spacePos = str.find(" ", slashPos + 1);
-            slashPos = str.find("/", slashPos + 1);
+            for (uint32_t i = 2; i < faceSize; i++)
+            {
+                Vertex a = face[0];
+                Vertex b = face[i - 1];
+                Vertex c = face[i];
 
-            if(slashPos < spacePos)
-                while(str.size())
+                if (!hasNormal[0] || !hasNormal[i - 1] || !hasNormal[i])
                 {
-                    rcl::Vertex newVertex;
-                    int slashPos2;
-
-                    slashPos2 = str.find("/");
-                    newVertex.coord = vertPos[std::stoi(str.substr(0, slashPos2)) - 1];
-                    str = str.substr(slashPos2 + 1, str.size());
-
-                    slashPos2 = str.find("/");
-                    newVertex.uv = vertTexCoord[std::stoi(str.substr(0, slashPos2)) - 1];
-                    str = str.substr(slashPos2 + 1, str.size());
-
-                    slashPos2 = str.find(" ");
-                    newVertex.normal = vertNormal[std::stoi(str.substr(0, slashPos2)) - 1];
-                    newVertexes.push_back(newVertex);
-                    
-                    if(slashPos2 == -1) break;
-                    str = str.substr(slashPos2, str.size());
+                    vec3 faceNormal = Cross(b.coord - a.coord, c.coord - a.coord);
+                    if (faceNormal.LengthSquared() > 0)
+                        faceNormal = faceNormal.Unit();
+
+                    if (!hasNormal[0]) a.normal = faceNormal;
+                    if (!hasNormal[i - 1]) b.normal = faceNormal;
+                    if (!hasNormal[i]) c.normal = faceNormal;
                 }
-            else
-                while(str.size())
-                {
-                    rcl::Vertex newVertex;
-                    int slashPos2;
 
-                    slashPos2 = str.find("/");
-                    newVertex.coord = vertPos[std::stoi(str.substr(0, slashPos2)) - 1];
-                    str = str.substr(slashPos2 + 1, str.size());
+                triangles.Add(std::make_shared<VertexTriangle>(a, b, c));
+            }
+        }
 
-                    slashPos2 = str.find(" ");
-                    newVertex.uv = vertTexCoord[std::stoi(str.substr(0, slashPos2)) - 1];
-                    str = str.substr(1, str.size());
+        return skippedFaces;
+    }
+    struct CornerKey
+    {
+        int64_t position;
+        int64_t uv;
+        int64_t normal;
 
-                    newVertexes.push_back(newVertex);
-                }
+        bool operator==(const CornerKey& other) const
+        {
+            return position == other.position && uv == other.uv && normal == other.normal;
         }
-        else
+    };
+
+    uint64_t HashCorner(const CornerKey& key)
+    {
+        uint64_t hash = static_cast<uint64_t>(key.position) * 0x9E3779B97F4A7C15ull;
+        hash ^= static_cast<uint64_t>(key.uv) * 0xC2B2AE3D27D4EB4Full + (hash >> 29);
+        hash ^= static_cast<uint64_t>(key.normal) * 0x165667B19E3779F9ull + (hash >> 32);
+        return hash ^ (hash >> 31);
+    }
+
+    // Maps every distinct v/vt/vn triple to one vertex id, open addressing over a power of two table
+    class CornerTable
+    {
+    public:
+        explicit CornerTable(size_t expectedCorners)
+        {
+            size_t capacity = 16;
+            while (capacity < expectedCorners * 2)
+                capacity <<= 1;
+            keys.resize(capacity);
+            ids.assign(capacity, EMPTY);
+            mask = capacity - 1;
+        }
+
+        // Returns the id stored for key, or stores newId and returns it
+        uint32_t FindOrInsert(const CornerKey& key, uint32_t newId)
+        {
+            size_t slot = HashCorner(key) & mask;
+            while (ids[slot] != EMPTY)
+            {
+                if (keys[slot] == key)
+                    return ids[slot];
+                slot = (slot + 1) & mask;
+            }
+
+            keys[slot] = key;
+            ids[slot] = newId;
+            return newId;
+        }
+    private:
+        static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+        std::vector<CornerKey> keys;
+        std::vector<uint32_t> ids;
+        size_t mask;
+    };
+
+    // Turns fanned faces into an index buffer over unique corners. A corner without a normal in a
+    // mesh that has normals gets the face normal, such corners are never shared between triangles.
+    size_t Deduplicate(const ObjAttributes& attributes, const std::vector<ObjChunk>& chunks, MeshBuffers& buffers)
+    {
+        bool hasNormals = !attributes.normals.empty();
+        bool hasUVs = !attributes.uvs.empty();
+
+        size_t cornerCount = 0;
+        for (const ObjChunk& chunk : chunks)
+            cornerCount += chunk.corners.size();
+
+        CornerTable table(cornerCount);
+        buffers.positions.reserve(cornerCount / 2);
+        buffers.indices.reserve(cornerCount * 2);
+
+        auto addVertex = [&](const FaceCorner& corner, const vec3& faceNormal)
+        {
+            buffers.positions.push_back(attributes.positions[corner.position]);
+            if (hasUVs)
+                buffers.uvs.push_back(corner.uv == MISSING_INDEX ? vec2(0.0f) : attributes.uvs[corner.uv]);
+            if (hasNormals)
+                buffers.normals.push_back(corner.normal == MISSING_INDEX ? faceNormal : attributes.normals[corner.normal]);
+            return static_cast<uint32_t>(buffers.positions.size() - 1);
+        };
+
+        size_t skippedFaces = 0;
+        Vertex unused;
+        bool unusedNormal;
+
+        for (const ObjChunk& chunk : chunks)
         {
-            while (str.size())
+            size_t cornerIndex = 0;
+            for (uint32_t faceSize : chunk.faceSizes)
             {
-                rcl::Vertex newVertex;
-                int spacePos;
+                const FaceCorner* face = &chunk.corners[cornerIndex];
+                cornerIndex += faceSize;
 
-                spacePos = str.find(" ");
-                newVertex.coord = vertPos[std::stoi(str.substr(0, spacePos)) - 1];
-                str = str.substr(1, str.size());
+                bool valid = true;
+                for (uint32_t i = 0; i < faceSize; i++)
+                    valid &= MakeVertex(attributes, face[i], unused, unusedNormal);
+                if (!valid)
+                {
+                    skippedFaces++;
+                    continue;
+                }
 
-                newVertexes.push_back(newVertex);
+                for (uint32_t i = 2; i < faceSize; i++)
+                {
+                    const FaceCorner* corners[3] = {&face[0], &face[i - 1], &face[i]};
+
+                    vec3 faceNormal(0.0f);
+                    if (hasNormals)
+                    {
+                        const vec3& a = attributes.positions[corners[0]->position];
+                        faceNormal = Cross(attributes.positions[corners[1]->position] - a, attributes.positions[corners[2]->position] - a);
+                        if (faceNormal.LengthSquared() > 0)
+                            faceNormal = faceNormal.Unit();
+                    }
+
+                    for (const FaceCorner* corner : corners)
+                    {
+                        if (hasNormals && corner->normal == MISSING_INDEX)
+                        {
+                            buffers.indices.push_back(addVertex(*corner, faceNormal));
+                            continue;
+                        }
+
+                        CornerKey key = {corner->position, hasUVs ? corner->uv : MISSING_INDEX, corner->normal};
+                        uint32_t nextId = static_cast<uint32_t>(buffers.positions.size());
+                        uint32_t id = table.FindOrInsert(key, nextId);
+                        if (id == nextId)
+                            addVertex(*corner, faceNormal);
+                        buffers.indices.push_back(id);
+                    }
+                }
             }
         }
-        
-        Triangulate(newVertexes, triangles);
+
+        return skippedFaces;
     }
 
-    void ReadObjFile(std::ifstream& fstr, HittableList& triangles)
+    // Maps the file and parses it in line-aligned chunks, one per hardware thread unless chunkCount
+    // asks for some other number. Afterwards the attributes of all chunks are merged and every
+    // corner index refers to the merged arrays.
+    bool ParseOBJ(const char* path, ObjAttributes& attributes, std::vector<ObjChunk>& chunks, size_t chunkCount)
     {
-        std::string line;
-
-        std::vector<vec3> vertPos;
-        std::vector<vec2> vertTexCoord;
-        std::vector<vec3> vertNormal;
+        MappedFile file(path);
+        if (!file.IsOpen())
+        {
+            std::cerr << "Error: Unable to find or open the file " << path << std::endl;
+            return false;
+        }
 
-        int i = 0;
+        if (chunkCount == 0)
+        {
+            size_t numThreads = std::thread::hardware_concurrency();
+            chunkCount = std::max<size_t>(1, std::min<size_t>(numThreads, file.Size() / MIN_BYTES_PER_CHUNK));
+        }
+        std::vector<const char*> bounds = SplitChunks(file.Data(), file.Data() + file.Size(), chunkCount);
+        chunkCount = bounds.size() - 1;
 
-        while (fstr)
+        // Every chunk is parsed on its own, negative indices stay relative to the chunk start
+        chunks.assign(chunkCount, ObjChunk());
+        ForEachChunk(chunkCount, [&](size_t i)
         {
-            std::getline(fstr, line);
-            if(line.size() < 1) break;
+            ParseRange(bounds[i], bounds[i + 1], chunks[i]);
+        });
 
-            if(line.find("v") == 0)
-                ReadVertexInfo(line, vertPos, vertTexCoord, vertNormal);
+        // Prefix sums over the attribute counts give every chunk its place in the global arrays
+        std::vector<std::array<size_t, 3>> offsets(chunkCount + 1, {0, 0, 0});
+        size_t malformedLines = 0;
+        for (size_t i = 0; i < chunkCount; i++)
+        {
+            const ObjAttributes& local = chunks[i].attributes;
+            offsets[i + 1] = {offsets[i][0] + local.positions.size(), offsets[i][1] + local.uvs.size(), offsets[i][2] + local.normals.size()};
+            malformedLines += chunks[i].malformedLines;
+        }
 
-            if(line.find("f") == 0)
-                ReadFaceInfo(line, vertPos, vertTexCoord, vertNormal, triangles);
+        if (chunkCount == 1)
+        {
+            attributes = std::move(chunks[0].attributes);
+        }
+        else
+        {
+            attributes.positions.resize(offsets[chunkCount][0]);
+            attributes.uvs.resize(offsets[chunkCount][1]);
+            attributes.normals.resize(offsets[chunkCount][2]);
         }
+
+        ForEachChunk(chunkCount, [&](size_t i)
+        {
+            ResolveChunk(chunks[i], offsets[i].data());
+            if (chunkCount > 1)
+            {
+                AppendAt(attributes.positions, offsets[i][0], chunks[i].attributes.positions);
+                AppendAt(attributes.uvs, offsets[i][1], chunks[i].attributes.uvs);
+                AppendAt(attributes.normals, offsets[i][2], chunks[i].attributes.normals);
+                chunks[i].attributes = ObjAttributes();
+            }
+        });
+
+        if (malformedLines)
+            std::cerr << "Error: " << malformedLines << " malformed lines in " << path << std::endl;
+        return true;
+    }
+
+    void ReportSkippedFaces(const char* path, size_t skippedFaces)
+    {
+        if (skippedFaces)
+            std::cerr << "Error: " << skippedFaces << " faces with out of range indices skipped in " << path << std::endl;
     }
-        
 }
 
-void ImportOBJ(const char* path, HittableList& triangles)
+void ImportOBJ(const char* path, HittableList& triangles, size_t chunkCount)
 {
-    std::ifstream fstr(path);
+    ObjAttributes attributes;
+    std::vector<ObjChunk> chunks;
+    if (!ParseOBJ(path, attributes, chunks, chunkCount))
+        return;
+
+    std::vector<HittableList> chunkTriangles(chunks.size());
+    std::vector<size_t> skippedFaces(chunks.size(), 0);
 
-	if (!fstr.is_open())
-	{
-		std::cout << "Unable to find or open the file : " << path;
-		return;
-	}
+    // Triangles may point into any chunk, so all attributes are merged before the first one is built
+    ForEachChunk(chunks.size(), [&](size_t i)
+    {
+        skippedFaces[i] = BuildTriangles(attributes, chunks[i], chunkTriangles[i]);
+    });
+
+    size_t totalSkipped = 0;
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        triangles.Append(std::move(chunkTriangles[i]));
+        totalSkipped += skippedFaces[i];
+    }
+
+    ReportSkippedFaces(path, totalSkipped);
+}
+
+void ImportOBJ(const char* path, MeshBuffers& buffers, size_t chunkCount)
+{
+    buffers.Clear();
 
-	ReadObjFile(fstr, triangles);
+    ObjAttributes attributes;
+    std::vector<ObjChunk> chunks;
+    if (!ParseOBJ(path, attributes, chunks, chunkCount))
+        return;
 
-	fstr.close();
+    ReportSkippedFaces(path, Deduplicate(attributes, chunks, buffers));
 }
 
 }
\ No newline at end of file
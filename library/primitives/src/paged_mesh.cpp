@@ -0,0 +1,831 @@
+#include "paged_mesh.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <iterator>
+
+#include "quantized_bvh.hpp"
+#include "functions.hpp"
+
+namespace rcl
+{
+
+namespace
+{
+    constexpr char PAGE_MAGIC[8] = {'R', 'C', 'L', 'P', 'A', 'G', 'E', 0};
+    constexpr uint32_t PAGE_VERSION = 1;
+
+    constexpr uint32_t HAS_NORMALS = 1;
+    constexpr uint32_t HAS_UVS = 2;
+
+    // Cluster flag, set when the cluster spans more than 2^16 grid steps on some axis
+    constexpr uint32_t WIDE_POSITIONS = 1;
+
+    constexpr uint32_t GRID_MAX = (1u << 24) - 1;
+
+    // Three corners per triangle must fit the byte indices
+    constexpr uint32_t MAX_TRIANGLES_PER_CLUSTER = 85;
+
+    // Decoded clusters keep bounds per run of this many triangles, rays skip runs they miss
+    constexpr size_t TRIANGLES_PER_GROUP = 8;
+
+    // Clusters last used by each thread, checked before the shared cache is locked. The cache
+    // does not evict a cluster a front holds, it empties the fronts instead, see Fetch.
+    constexpr size_t FRONT_CACHE_SIZE = 32;
+
+    // Followed by the cluster data, the cluster table is at tableOffset
+    struct PageHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t clusterCount;
+        uint64_t triangleCount;
+        uint64_t tableOffset;
+        double origin[3];
+        double step;
+        double area;
+    };
+
+    std::atomic<uint64_t> nextMeshId{1};
+
+    // Cluster data: base grid cell (3 x uint32), per vertex grid offsets (3 x uint16, or uint32
+    // when wide), octahedral normals (2 x int16), quantized uvs (2 x uint16), then 3 byte indices
+    // per triangle
+    size_t ClusterBytes(uint32_t vertexCount, uint32_t triangleCount, uint32_t clusterFlags, uint32_t meshFlags)
+    {
+        size_t size = 3 * sizeof(uint32_t);
+        size += vertexCount * 3 * ((clusterFlags & WIDE_POSITIONS) ? sizeof(uint32_t) : sizeof(uint16_t));
+        if (meshFlags & HAS_NORMALS) size += vertexCount * 2 * sizeof(int16_t);
+        if (meshFlags & HAS_UVS) size += vertexCount * 2 * sizeof(uint16_t);
+        return size + triangleCount * 3;
+    }
+
+    // Writer and reader go through the same function, so equal cells give bit equal positions
+    vec3 GridPoint(const double origin[3], double step, const uint32_t cell[3])
+    {
+        return vec3(static_cast<float>(origin[0] + cell[0] * step),
+                    static_cast<float>(origin[1] + cell[1] * step),
+                    static_cast<float>(origin[2] + cell[2] * step));
+    }
+
+    void EncodeOctahedral(const vec3& normal, int16_t encoded[2])
+    {
+        double length = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+        double x = length > 0 ? normal.x / length : 0;
+        double y = length > 0 ? normal.y / length : 0;
+        if (normal.z < 0)
+        {
+            double foldedX = (1 - std::fabs(y)) * (x < 0 ? -1 : 1);
+            double foldedY = (1 - std::fabs(x)) * (y < 0 ? -1 : 1);
+            x = foldedX;
+            y = foldedY;
+        }
+        encoded[0] = static_cast<int16_t>(std::lround(std::clamp(x, -1.0, 1.0) * 32767));
+        encoded[1] = static_cast<int16_t>(std::lround(std::clamp(y, -1.0, 1.0) * 32767));
+    }
+
+    vec3 DecodeOctahedral(const int16_t encoded[2])
+    {
+        double x = encoded[0] / 32767.0;
+        double y = encoded[1] / 32767.0;
+        double z = 1 - std::fabs(x) - std::fabs(y);
+        if (z < 0)
+        {
+            double unfoldedX = (1 - std::fabs(y)) * (x < 0 ? -1 : 1);
+            double unfoldedY = (1 - std::fabs(x)) * (y < 0 ? -1 : 1);
+            x = unfoldedX;
+            y = unfoldedY;
+        }
+        return vec3(x, y, z).Unit();
+    }
+
+    template<typename T>
+    void Put(std::vector<char>& bytes, T value)
+    {
+        size_t at = bytes.size();
+        bytes.resize(at + sizeof(T));
+        std::memcpy(bytes.data() + at, &value, sizeof(T));
+    }
+
+    template<typename T>
+    T Take(const char*& p)
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+
+    // Median splits along the longest axis of the centroids until runs of clusterSize remain.
+    // Splits fall on multiples of clusterSize, so only the very last cluster can be short.
+    void PartitionForClusters(std::vector<uint32_t>& order, const std::vector<vec3>& centroids, size_t begin, size_t end, size_t clusterSize)
+    {
+        if (end - begin <= clusterSize)
+            return;
+
+        vec3 low = centroids[order[begin]];
+        vec3 high = low;
+        for (size_t i = begin + 1; i < end; i++)
+        {
+            const vec3& centroid = centroids[order[i]];
+            low = vec3(std::min(low.x, centroid.x), std::min(low.y, centroid.y), std::min(low.z, centroid.z));
+            high = vec3(std::max(high.x, centroid.x), std::max(high.y, centroid.y), std::max(high.z, centroid.z));
+        }
+
+        vec3 size = high - low;
+        int axis = size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+        size_t mid = begin + ((end - begin) / clusterSize + 1) / 2 * clusterSize;
+        std::nth_element(order.begin() + begin, order.begin() + mid, order.begin() + end,
+                         [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; });
+
+        PartitionForClusters(order, centroids, begin, mid, clusterSize);
+        PartitionForClusters(order, centroids, mid, end, clusterSize);
+    }
+
+    double TriangleArea(const vec3& a, const vec3& b, const vec3& c)
+    {
+        return 0.5 * Cross(b - a, c - a).Length();
+    }
+}
+
+class PagedMesh::ClusterProxy : public Hittable
+{
+public:
+    ClusterProxy(const PagedMesh* mesh, uint32_t cluster, const AABB& bbox)
+    : mesh(mesh), cluster(cluster), bbox(bbox)
+    {}
+
+    // The parent node only tested the union of both children, a miss here saves a fetch
+    bool hit(const Ray& ray, const Interval<double>& interval, HitRecord& record) const override
+    {
+        return bbox.Hit(ray, interval) && mesh->HitCluster(cluster, ray, interval, record);
+    }
+
+    const AABB& BoundingBox() const override { return bbox; }
+    double Area() const override { return mesh->clusters[cluster].area; }
+
+    // Sampling goes through the mesh, which picks clusters by area itself
+    vec3 RandomPointOnSurface() const override { return mesh->RandomPointOnSurface(); }
+    Ray RandomRayFromSurface() const override { return mesh->RandomRayFromSurface(); }
+    std::shared_ptr<Material> GetMaterial() const override { return nullptr; }
+private:
+    const PagedMesh* mesh;
+    uint32_t cluster;
+    AABB bbox;
+};
+
+bool WritePagedMesh(const char* path, const MeshBuffers& buffers, uint32_t trianglesPerCluster)
+{
+    using ClusterInfo = PagedMesh::ClusterInfo;
+
+    trianglesPerCluster = std::clamp(trianglesPerCluster, 1u, MAX_TRIANGLES_PER_CLUSTER);
+    bool hasNormals = !buffers.normals.empty();
+    bool hasUVs = !buffers.uvs.empty();
+
+    PageHeader header = {};
+    std::memcpy(header.magic, PAGE_MAGIC, sizeof(PAGE_MAGIC));
+    header.version = PAGE_VERSION;
+    header.flags = (hasNormals ? HAS_NORMALS : 0) | (hasUVs ? HAS_UVS : 0);
+
+    double low[3] = {std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+    double high[3] = {std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest(), std::numeric_limits<double>::lowest()};
+    for (const vec3& position : buffers.positions)
+    {
+        for (int axis = 0; axis < 3; axis++)
+        {
+            low[axis] = std::min(low[axis], static_cast<double>(position[axis]));
+            high[axis] = std::max(high[axis], static_cast<double>(position[axis]));
+        }
+    }
+
+    double extent = 0;
+    for (int axis = 0; axis < 3; axis++)
+    {
+        header.origin[axis] = buffers.positions.empty() ? 0 : low[axis];
+        extent = std::max(extent, buffers.positions.empty() ? 0 : high[axis] - low[axis]);
+    }
+    header.step = extent > 0 ? extent / GRID_MAX : 1;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+    {
+        std::cerr << "Error: Unable to write the paged mesh " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<ClusterInfo> table;
+    std::vector<char> bytes;
+    std::unordered_map<uint32_t, uint8_t> local;
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> corners;
+    uint64_t offset = sizeof(header);
+    size_t skipped = 0;
+
+    // Valid triangles, ordered so every run of trianglesPerCluster is one compact cluster
+    size_t triangleCount = buffers.TriangleCount();
+    size_t vertexCount = buffers.positions.size();
+    std::vector<uint32_t> order;
+    std::vector<vec3> centroids(triangleCount);
+    order.reserve(triangleCount);
+    for (size_t triangle = 0; triangle < triangleCount; triangle++)
+    {
+        const uint32_t* index = &buffers.indices[triangle * 3];
+        if (index[0] >= vertexCount || index[1] >= vertexCount || index[2] >= vertexCount)
+        {
+            skipped++;
+            continue;
+        }
+        centroids[triangle] = (buffers.positions[index[0]] + buffers.positions[index[1]] + buffers.positions[index[2]]) / 3;
+        order.push_back(static_cast<uint32_t>(triangle));
+    }
+    PartitionForClusters(order, centroids, 0, order.size(), trianglesPerCluster);
+
+    for (size_t first = 0; first < order.size(); first += trianglesPerCluster)
+    {
+        size_t last = std::min(order.size(), first + trianglesPerCluster);
+        local.clear();
+        vertices.clear();
+        corners.clear();
+
+        for (size_t i = first; i < last; i++)
+        {
+            const uint32_t* index = &buffers.indices[order[i] * size_t(3)];
+            for (int corner = 0; corner < 3; corner++)
+            {
+                auto inserted = local.emplace(index[corner], static_cast<uint8_t>(vertices.size()));
+                if (inserted.second)
+                    vertices.push_back(index[corner]);
+                corners.push_back(inserted.first->second);
+            }
+        }
+
+        // Snap to the grid, the cluster stores offsets from its lowest cell
+        std::vector<uint32_t> cells(vertices.size() * 3);
+        uint32_t base[3] = {GRID_MAX, GRID_MAX, GRID_MAX};
+        uint32_t top[3] = {0, 0, 0};
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            const vec3& position = buffers.positions[vertices[v]];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                double cell = std::round((position[axis] - header.origin[axis]) / header.step);
+                uint32_t clamped = static_cast<uint32_t>(std::clamp(cell, 0.0, static_cast<double>(GRID_MAX)));
+                cells[v * 3 + axis] = clamped;
+                base[axis] = std::min(base[axis], clamped);
+                top[axis] = std::max(top[axis], clamped);
+            }
+        }
+
+        ClusterInfo info = {};
+        info.vertexCount = static_cast<uint16_t>(vertices.size());
+        info.triangleCount = static_cast<uint16_t>(corners.size() / 3);
+        for (int axis = 0; axis < 3; axis++)
+            if (top[axis] - base[axis] > 0xFFFF)
+                info.flags |= WIDE_POSITIONS;
+
+        bytes.clear();
+        for (int axis = 0; axis < 3; axis++)
+            Put(bytes, base[axis]);
+
+        // Bounds come from the snapped positions, those are what rays are tested against
+        std::vector<vec3> snapped(vertices.size());
+        vec3 lowCorner, highCorner;
+        for (size_t v = 0; v < vertices.size(); v++)
+        {
+            uint32_t* cell = &cells[v * 3];
+            for (int axis = 0; axis < 3; axis++)
+            {
+                if (info.flags & WIDE_POSITIONS)
+                    Put(bytes, static_cast<uint32_t>(cell[axis] - base[axis]));
+                else
+                    Put(bytes, static_cast<uint16_t>(cell[axis] - base[axis]));
+            }
+
+            snapped[v] = GridPoint(header.origin, header.step, cell);
+            lowCorner = v == 0 ? snapped[v] : vec3(std::min(lowCorner.x, snapped[v].x), std::min(lowCorner.y, snapped[v].y), std::min(lowCorner.z, snapped[v].z));
+            highCorner = v == 0 ? snapped[v] : vec3(std::max(highCorner.x, snapped[v].x), std::max(highCorner.y, snapped[v].y), std::max(highCorner.z, snapped[v].z));
+        }
+        for (int axis = 0; axis < 3; axis++)
+        {
+            info.bounds[axis] = lowCorner[axis];
+            info.bounds[axis + 3] = highCorner[axis];
+        }
+
+        if (hasNormals)
+        {
+            for (uint32_t vertex : vertices)
+            {
+                int16_t encoded[2];
+                EncodeOctahedral(buffers.normals[vertex], encoded);
+                Put(bytes, encoded[0]);
+                Put(bytes, encoded[1]);
+            }
+        }
+
+        if (hasUVs)
+        {
+            vec2 uvLow = buffers.uvs[vertices[0]];
+            vec2 uvHigh = uvLow;
+            for (uint32_t vertex : vertices)
+            {
+                const vec2& uv = buffers.uvs[vertex];
+                uvLow = vec2(std::min(uvLow.x, uv.x), std::min(uvLow.y, uv.y));
+                uvHigh = vec2(std::max(uvHigh.x, uv.x), std::max(uvHigh.y, uv.y));
+            }
+
+            info.uvMin[0] = uvLow.x;
+            info.uvMin[1] = uvLow.y;
+            info.uvScale[0] = (uvHigh.x - uvLow.x) / 65535.0f;
+            info.uvScale[1] = (uvHigh.y - uvLow.y) / 65535.0f;
+
+            for (uint32_t vertex : vertices)
+            {
+                const vec2& uv = buffers.uvs[vertex];
+                Put(bytes, static_cast<uint16_t>(info.uvScale[0] > 0 ? std::lround((uv.x - uvLow.x) / info.uvScale[0]) : 0));
+                Put(bytes, static_cast<uint16_t>(info.uvScale[1] > 0 ? std::lround((uv.y - uvLow.y) / info.uvScale[1]) : 0));
+            }
+        }
+
+        bytes.insert(bytes.end(), corners.begin(), corners.end());
+
+        double area = 0;
+        for (size_t i = 0; i < corners.size(); i += 3)
+            area += TriangleArea(snapped[corners[i]], snapped[corners[i + 1]], snapped[corners[i + 2]]);
+        info.area = static_cast<float>(area);
+        header.area += area;
+
+        info.offset = offset;
+        info.size = static_cast<uint32_t>(bytes.size());
+        offset += bytes.size();
+        header.triangleCount += info.triangleCount;
+        table.push_back(info);
+
+        file.write(bytes.data(), bytes.size());
+    }
+
+    header.clusterCount = table.size();
+    header.tableOffset = offset;
+    file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(ClusterInfo));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    if (skipped)
+        std::cerr << "Error: " << skipped << " triangles with out of range indices skipped in " << path << std::endl;
+
+    if (!file)
+    {
+        std::cerr << "Error: Unable to write the paged mesh " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+size_t PagedMesh::Cluster::Bytes() const
+{
+    return sizeof(Cluster) + positions.capacity() * sizeof(vec3) + normals.capacity() * sizeof(vec3)
+         + uvs.capacity() * sizeof(vec2) + indices.capacity() + groups.capacity() * sizeof(AABB);
+}
+
+PagedMesh::PagedMesh(const char* path, std::shared_ptr<Material> mat, size_t cacheBytes)
+: mat(mat), id(nextMeshId++), cacheBytes(cacheBytes)
+{
+    if (!Open(path))
+    {
+        file.Close();
+        clusters.clear();
+        clusterAreas.Clear();
+        triangleCount = 0;
+    }
+}
+
+bool PagedMesh::Open(const char* path)
+{
+    if (!file.Open(path))
+    {
+        std::cerr << "Error: Unable to find or open the file " << path << std::endl;
+        return false;
+    }
+
+    PageHeader header;
+    if (file.Size() < sizeof(header))
+    {
+        std::cerr << "Error: Invalid paged mesh " << path << std::endl;
+        return false;
+    }
+    std::memcpy(&header, file.Data(), sizeof(header));
+
+    bool valid = std::memcmp(header.magic, PAGE_MAGIC, sizeof(PAGE_MAGIC)) == 0 && header.version == PAGE_VERSION &&
+                 header.step > 0 && header.tableOffset >= sizeof(header) && header.tableOffset <= file.Size() &&
+                 header.clusterCount <= (file.Size() - header.tableOffset) / sizeof(ClusterInfo) &&
+                 header.clusterCount <= std::numeric_limits<uint32_t>::max();
+    if (!valid)
+    {
+        std::cerr << "Error: Invalid paged mesh " << path << std::endl;
+        return false;
+    }
+
+    clusters.resize(header.clusterCount);
+    std::memcpy(clusters.data(), file.Data() + header.tableOffset, clusters.size() * sizeof(ClusterInfo));
+
+    for (int axis = 0; axis < 3; axis++)
+        origin[axis] = header.origin[axis];
+    step = header.step;
+    hasNormals = header.flags & HAS_NORMALS;
+    hasUVs = header.flags & HAS_UVS;
+
+    // Everything Decode relies on is checked once here, it does no bounds checks of its own
+    HittableList proxies;
+    proxies.objects.reserve(clusters.size());
+    std::vector<double> areas;
+    areas.reserve(clusters.size());
+    for (uint32_t i = 0; i < clusters.size(); i++)
+    {
+        const ClusterInfo& info = clusters[i];
+        if (info.offset < sizeof(header) || info.offset > header.tableOffset || info.size > header.tableOffset - info.offset ||
+            info.triangleCount == 0 || info.triangleCount > MAX_TRIANGLES_PER_CLUSTER ||
+            info.vertexCount == 0 || info.vertexCount > info.triangleCount * 3u ||
+            info.size != ClusterBytes(info.vertexCount, info.triangleCount, info.flags, header.flags))
+        {
+            std::cerr << "Error: Corrupted cluster " << i << " in paged mesh " << path << std::endl;
+            return false;
+        }
+
+        AABB bbox(vec3(info.bounds[0], info.bounds[1], info.bounds[2]), vec3(info.bounds[3], info.bounds[4], info.bounds[5]));
+        proxies.Add(std::make_shared<ClusterProxy>(this, i, bbox));
+
+        triangleCount += info.triangleCount;
+        areas.push_back(info.area);
+    }
+    clusterAreas.Build(areas);
+
+    if (!proxies.objects.empty())
+        root = HittableList(std::make_shared<QuantizedBVH<uint8_t>>(proxies));
+    return true;
+}
+
+bool PagedMesh::IsOpen() const
+{
+    return file.IsOpen();
+}
+
+size_t PagedMesh::ClusterCount() const
+{
+    return clusters.size();
+}
+
+size_t PagedMesh::TriangleCount() const
+{
+    return triangleCount;
+}
+
+PagedMesh::CacheStats PagedMesh::GetCacheStats() const
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return CacheStats{hits.load(), misses.load(), evictions.load(), residentBytes, cache.size()};
+}
+
+std::shared_ptr<const PagedMesh::Cluster> PagedMesh::Decode(uint32_t index) const
+{
+    const ClusterInfo& info = clusters[index];
+    const char* p = file.Data() + info.offset;
+    auto cluster = std::make_shared<Cluster>();
+
+    uint32_t base[3];
+    for (int axis = 0; axis < 3; axis++)
+        base[axis] = Take<uint32_t>(p);
+
+    cluster->positions.resize(info.vertexCount);
+    for (vec3& position : cluster->positions)
+    {
+        uint32_t cell[3];
+        for (int axis = 0; axis < 3; axis++)
+            cell[axis] = base[axis] + ((info.flags & WIDE_POSITIONS) ? Take<uint32_t>(p) : Take<uint16_t>(p));
+        position = GridPoint(origin, step, cell);
+    }
+
+    if (hasNormals)
+    {
+        cluster->normals.resize(info.vertexCount);
+        for (vec3& normal : cluster->normals)
+        {
+            int16_t encoded[2];
+            encoded[0] = Take<int16_t>(p);
+            encoded[1] = Take<int16_t>(p);
+            normal = DecodeOctahedral(encoded);
+        }
+    }
+
+    if (hasUVs)
+    {
+        cluster->uvs.resize(info.vertexCount);
+        for (vec2& uv : cluster->uvs)
+        {
+            float u = info.uvMin[0] + Take<uint16_t>(p) * info.uvScale[0];
+            float v = info.uvMin[1] + Take<uint16_t>(p) * info.uvScale[1];
+            uv = vec2(u, v);
+        }
+    }
+
+    cluster->indices.assign(p, p + info.triangleCount * 3);
+    for (uint8_t corner : cluster->indices)
+    {
+        if (corner >= info.vertexCount)
+        {
+            std::cerr << "Error: Corrupted cluster " << index << " in paged mesh, it is not rendered" << std::endl;
+            cluster->indices.clear();
+            break;
+        }
+    }
+
+    size_t triangles = cluster->indices.size() / 3;
+    cluster->groups.reserve((triangles + TRIANGLES_PER_GROUP - 1) / TRIANGLES_PER_GROUP);
+    for (size_t first = 0; first < triangles; first += TRIANGLES_PER_GROUP)
+    {
+        vec3 low = cluster->positions[cluster->indices[first * 3]];
+        vec3 high = low;
+        for (size_t corner = first * 3; corner < std::min(triangles, first + TRIANGLES_PER_GROUP) * 3; corner++)
+        {
+            const vec3& position = cluster->positions[cluster->indices[corner]];
+            low = vec3(std::min(low.x, position.x), std::min(low.y, position.y), std::min(low.z, position.z));
+            high = vec3(std::max(high.x, position.x), std::max(high.y, position.y), std::max(high.z, position.z));
+        }
+        cluster->groups.push_back(AABB(low, high));
+    }
+
+    return cluster;
+}
+
+// The cluster is pinned by the calling thread's front cache, the pointer is valid until its next Fetch.
+// A front holds clusters of any number of meshes, each entry tagged with its mesh and the generation
+// it was fetched in, so rays crossing several meshes keep what they fetched from each. When a mesh's
+// cache asks for its clusters back, the thread gives them up at its next Fetch from that mesh.
+// Render threads end with the render, and their fronts with them.
+const PagedMesh::Cluster* PagedMesh::Fetch(uint32_t index) const
+{
+    struct FrontEntry
+    {
+        uint64_t mesh = 0;
+        uint64_t generation = 0;
+        uint32_t cluster = 0;
+        std::shared_ptr<const Cluster> data;
+    };
+    struct Front
+    {
+        // Mesh and generation of the last Fetch, stale entries are only looked for when they change
+        uint64_t mesh = 0;
+        uint64_t generation = 0;
+        FrontEntry entries[FRONT_CACHE_SIZE];
+    };
+    thread_local Front front;
+
+    uint64_t generation = frontGeneration.load(std::memory_order_relaxed);
+    if (front.mesh != id || front.generation != generation)
+    {
+        for (FrontEntry& entry : front.entries)
+            if (entry.data && entry.mesh == id && entry.generation != generation)
+                entry = FrontEntry();
+        front.mesh = id;
+        front.generation = generation;
+    }
+
+    // Meshes are spread over the slots, the same cluster of two meshes lands in different ones
+    FrontEntry& slot = front.entries[(index + static_cast<uint32_t>(id) * 0x9E3779B9u) % FRONT_CACHE_SIZE];
+    if (slot.data && slot.mesh == id && slot.cluster == index)
+    {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return slot.data.get();
+    }
+    // Given back before the shared cache is asked, so it may evict the cluster
+    slot = FrontEntry();
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto found = cache.find(index);
+        if (found != cache.end())
+        {
+            recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, found->second.position);
+            hits.fetch_add(1, std::memory_order_relaxed);
+            slot = FrontEntry{id, generation, index, found->second.cluster};
+            return slot.data.get();
+        }
+    }
+
+    // Decoding happens unlocked, two threads missing the same cluster both decode it
+    // and the second one adopts the first one's copy
+    misses.fetch_add(1, std::memory_order_relaxed);
+    std::shared_ptr<const Cluster> decoded = Decode(index);
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto found = cache.find(index);
+        if (found != cache.end())
+        {
+            decoded = found->second.cluster;
+            recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, found->second.position);
+        }
+        else
+        {
+            recentlyUsed.push_front(index);
+            cache.emplace(index, CacheEntry{decoded, recentlyUsed.begin()});
+            residentBytes += decoded->Bytes();
+
+            // Least recently used first. The newest cluster always stays, so a budget below one
+            // cluster still renders. Clusters in some thread's front are skipped, counting only
+            // takes the lock, so a cluster held by nothing but the cache stays that way here.
+            bool pinned = false;
+            auto candidate = std::prev(recentlyUsed.end());
+            while (residentBytes > cacheBytes && candidate != recentlyUsed.begin())
+            {
+                auto evicted = cache.find(*candidate);
+                if (evicted->second.cluster.use_count() > 1)
+                {
+                    pinned = true;
+                    --candidate;
+                    continue;
+                }
+                residentBytes -= evicted->second.cluster->Bytes();
+                cache.erase(evicted);
+                candidate = std::prev(recentlyUsed.erase(candidate));
+                evictions.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Over budget because of the fronts, each thread gives this mesh's clusters back at its
+            // next Fetch from it, and the following miss evicts what they gave back
+            if (residentBytes > cacheBytes && pinned)
+                frontGeneration.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    slot = FrontEntry{id, generation, index, std::move(decoded)};
+    return slot.data.get();
+}
+
+bool PagedMesh::HitCluster(uint32_t index, const Ray& ray, const Interval<double>& interval, HitRecord& record) const
+{
+    const Cluster* cluster = Fetch(index);
+
+    double closest = interval.max;
+    size_t hitTriangle = 0;
+    double hitU = 0, hitV = 0;
+    bool hitAnything = false;
+
+    size_t triangleCount = cluster->indices.size() / 3;
+    for (size_t triangle = 0; triangle < triangleCount * 3; triangle += 3)
+    {
+        if (triangle % (TRIANGLES_PER_GROUP * 3) == 0 &&
+            !cluster->groups[triangle / (TRIANGLES_PER_GROUP * 3)].Hit(ray, Interval<double>(interval.min, closest)))
+        {
+            triangle += (TRIANGLES_PER_GROUP - 1) * 3;
+            continue;
+        }
+
+        const vec3& a = cluster->positions[cluster->indices[triangle]];
+        vec3 e1 = cluster->positions[cluster->indices[triangle + 1]] - a;
+        vec3 e2 = cluster->positions[cluster->indices[triangle + 2]] - a;
+        vec3 P = Cross(ray.direction, e2);
+        double dotPe1 = Dot(P, e1);
+
+        if (std::fabs(dotPe1) <= 1e-8)
+            continue;
+
+        double invDotPe1 = 1 / dotPe1;
+        vec3 T = ray.origin - a;
+        double u = Dot(P, T) * invDotPe1;
+        if (u > 1 || u < 0)
+            continue;
+
+        vec3 Q = Cross(T, e1);
+        double v = Dot(Q, ray.direction) * invDotPe1;
+        if (u + v > 1 || v < 0)
+            continue;
+
+        double t = Dot(Q, e2) * invDotPe1;
+        if (!interval.Contains(t) || t >= closest)
+            continue;
+
+        closest = t;
+        hitTriangle = triangle;
+        hitU = u;
+        hitV = v;
+        hitAnything = true;
+    }
+
+    if (!hitAnything)
+        return false;
+
+    const uint8_t* corner = &cluster->indices[hitTriangle];
+    double w = 1 - hitU - hitV;
+
+    record.distance = closest;
+    record.point = ray.At(closest);
+    record.uv = hasUVs ? w * cluster->uvs[corner[0]] + hitU * cluster->uvs[corner[1]] + hitV * cluster->uvs[corner[2]]
+                       : vec2(hitU, hitV);
+    const vec3& a = cluster->positions[corner[0]];
+    vec3 e1 = cluster->positions[corner[1]] - a;
+    vec3 e2 = cluster->positions[corner[2]] - a;
+    record.uvDensity = hasUVs ? HitRecord::TriangleUVDensity(e1, e2, cluster->uvs[corner[0]], cluster->uvs[corner[1]], cluster->uvs[corner[2]])
+                              : HitRecord::TriangleUVDensity(e1, e2, vec2(0, 0), vec2(1, 0), vec2(0, 1));
+
+    vec3 normal;
+    if (hasNormals)
+        normal = cluster->normals[corner[0]] * w + cluster->normals[corner[1]] * hitU + cluster->normals[corner[2]] * hitV;
+    else
+        normal = Cross(e1, e2);
+    record.SetNormal(ray, normal.LengthSquared() > 0 ? normal.Unit() : normal);
+
+    return true;
+}
+
+bool PagedMesh::hit(const Ray& ray, const Interval<double>& interval, HitRecord& record) const
+{
+    if (root.hit(ray, interval, record))
+    {
+        record.mat = mat;
+        record.object = this;
+        return true;
+    }
+    return false;
+}
+
+const AABB& PagedMesh::BoundingBox() const
+{
+    return root.BoundingBox();
+}
+
+double PagedMesh::Area() const
+{
+    return clusterAreas.Total();
+}
+
+// Picks a triangle of the cluster by area and a uniform point on it
+vec3 PagedMesh::SamplePoint(const Cluster& cluster, vec3& normal) const
+{
+    size_t triangles = cluster.indices.size() / 3;
+    double areas[MAX_TRIANGLES_PER_CLUSTER];
+    double total = 0;
+    for (size_t i = 0; i < triangles; i++)
+    {
+        const uint8_t* corner = &cluster.indices[i * 3];
+        total += TriangleArea(cluster.positions[corner[0]], cluster.positions[corner[1]], cluster.positions[corner[2]]);
+        areas[i] = total;
+    }
+
+    size_t triangle = std::upper_bound(areas, areas + triangles, RandomDouble01() * total) - areas;
+    const uint8_t* corner = &cluster.indices[std::min(triangle, triangles - 1) * 3];
+
+    double u, v;
+    RandomBarycentric(u, v);
+
+    const vec3& a = cluster.positions[corner[0]];
+    const vec3& b = cluster.positions[corner[1]];
+    const vec3& c = cluster.positions[corner[2]];
+    if (hasNormals)
+        normal = cluster.normals[corner[0]] * (1 - u - v) + cluster.normals[corner[1]] * u + cluster.normals[corner[2]] * v;
+    else
+        normal = Cross(b - a, c - a);
+    if (normal.LengthSquared() > 0)
+        normal = normal.Unit();
+
+    return a + (b - a) * u + (c - a) * v;
+}
+
+vec3 PagedMesh::RandomPointOnSurface() const
+{
+    if (clusterAreas.Empty())
+        return vec3(0);
+
+    const Cluster* cluster = Fetch(static_cast<uint32_t>(clusterAreas.Sample()));
+    if (cluster->indices.empty())
+        return vec3(0);
+
+    vec3 normal;
+    return SamplePoint(*cluster, normal);
+}
+
+Ray PagedMesh::RandomRayFromSurface() const
+{
+    if (clusterAreas.Empty())
+        return Ray(vec3(0), vec3(0, 1, 0));
+
+    const Cluster* cluster = Fetch(static_cast<uint32_t>(clusterAreas.Sample()));
+    if (cluster->indices.empty())
+        return Ray(vec3(0), vec3(0, 1, 0));
+
+    vec3 normal;
+    vec3 point = SamplePoint(*cluster, normal);
+    return Ray(point, Ray::RandomCosineOnHemisphere(normal));
+}
+
+std::shared_ptr<Material> PagedMesh::GetMaterial() const
+{
+    return mat;
+}
+
+}
\ No newline at end of file
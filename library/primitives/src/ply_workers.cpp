@@ -0,0 +1,400 @@
+#include "model_workers.hpp"
+
+#include <vector>
+#include <string>
+#include <iostream>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <charconv>
+#include <utility>
+
+#include "mapped_file.hpp"
+
+namespace rcl
+{
+
+namespace
+{
+    enum class PlyFormat
+    {
+        Ascii,
+        BinaryLittleEndian,
+        BinaryBigEndian
+    };
+
+    enum class PlyType
+    {
+        Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Invalid
+    };
+
+    struct PlyProperty
+    {
+        std::string name;
+        PlyType type;
+        bool isList;
+        PlyType countType;
+    };
+
+    struct PlyElement
+    {
+        std::string name;
+        size_t count;
+        std::vector<PlyProperty> properties;
+    };
+
+    // Destination of a vertex property: position, normal and uv components in that order
+    enum VertexSlot
+    {
+        SLOT_X, SLOT_Y, SLOT_Z, SLOT_NX, SLOT_NY, SLOT_NZ, SLOT_U, SLOT_V, SLOT_COUNT, SLOT_NONE = SLOT_COUNT
+    };
+
+    PlyType ParseType(const std::string& name)
+    {
+        if (name == "char" || name == "int8") return PlyType::Int8;
+        if (name == "uchar" || name == "uint8") return PlyType::UInt8;
+        if (name == "short" || name == "int16") return PlyType::Int16;
+        if (name == "ushort" || name == "uint16") return PlyType::UInt16;
+        if (name == "int" || name == "int32") return PlyType::Int32;
+        if (name == "uint" || name == "uint32") return PlyType::UInt32;
+        if (name == "float" || name == "float32") return PlyType::Float32;
+        if (name == "double" || name == "float64") return PlyType::Float64;
+        return PlyType::Invalid;
+    }
+
+    size_t TypeSize(PlyType type)
+    {
+        switch (type)
+        {
+            case PlyType::Int8: case PlyType::UInt8: return 1;
+            case PlyType::Int16: case PlyType::UInt16: return 2;
+            case PlyType::Int32: case PlyType::UInt32: case PlyType::Float32: return 4;
+            case PlyType::Float64: return 8;
+            default: return 0;
+        }
+    }
+
+    VertexSlot SlotOf(const std::string& name)
+    {
+        if (name == "x") return SLOT_X;
+        if (name == "y") return SLOT_Y;
+        if (name == "z") return SLOT_Z;
+        if (name == "nx") return SLOT_NX;
+        if (name == "ny") return SLOT_NY;
+        if (name == "nz") return SLOT_NZ;
+        if (name == "u" || name == "s" || name == "texture_u" || name == "texture_s") return SLOT_U;
+        if (name == "v" || name == "t" || name == "texture_v" || name == "texture_t") return SLOT_V;
+        return SLOT_NONE;
+    }
+
+    bool HostIsLittleEndian()
+    {
+        uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    // Reads scalars from the body in any of the three encodings, failed stays set after an overrun
+    class PlyReader
+    {
+    public:
+        bool failed = false;
+
+        PlyReader(const char* begin, const char* end, PlyFormat format)
+        : p(begin), end(end), format(format),
+          swapBytes(format != PlyFormat::Ascii && (format == PlyFormat::BinaryLittleEndian) != HostIsLittleEndian())
+        {}
+
+        double Read(PlyType type)
+        {
+            if (format == PlyFormat::Ascii)
+                return ReadText();
+
+            size_t size = TypeSize(type);
+            if (static_cast<size_t>(end - p) < size)
+            {
+                failed = true;
+                return 0;
+            }
+
+            unsigned char bytes[8];
+            std::memcpy(bytes, p, size);
+            p += size;
+            if (swapBytes)
+                for (size_t i = 0; i < size / 2; i++)
+                    std::swap(bytes[i], bytes[size - 1 - i]);
+
+            switch (type)
+            {
+                case PlyType::Int8: return Cast<int8_t>(bytes);
+                case PlyType::UInt8: return Cast<uint8_t>(bytes);
+                case PlyType::Int16: return Cast<int16_t>(bytes);
+                case PlyType::UInt16: return Cast<uint16_t>(bytes);
+                case PlyType::Int32: return Cast<int32_t>(bytes);
+                case PlyType::UInt32: return Cast<uint32_t>(bytes);
+                case PlyType::Float32: return Cast<float>(bytes);
+                case PlyType::Float64: return Cast<double>(bytes);
+                default: failed = true; return 0;
+            }
+        }
+
+        // Length of a list of itemType, which must fit in what is left of the body. Text items
+        // take at least a byte each.
+        size_t ReadCount(PlyType type, PlyType itemType)
+        {
+            double count = Read(type);
+            size_t itemSize = format == PlyFormat::Ascii ? 1 : TypeSize(itemType);
+            if (failed || !std::isfinite(count) || count < 0 || count > static_cast<double>(static_cast<size_t>(end - p) / itemSize))
+            {
+                failed = true;
+                return 0;
+            }
+            return static_cast<size_t>(count);
+        }
+
+        // Elements take at least this many bytes each, lets a corrupted count be rejected before
+        // anything is allocated for it. An ASCII value is a digit and a separator at the least.
+        bool CanHold(const PlyElement& element) const
+        {
+            size_t minimumSize = 0;
+            for (const PlyProperty& property : element.properties)
+                minimumSize += format == PlyFormat::Ascii ? 2 : TypeSize(property.isList ? property.countType : property.type);
+            return minimumSize == 0 || element.count <= static_cast<size_t>(end - p) / minimumSize;
+        }
+
+        void Skip(const PlyProperty& property)
+        {
+            size_t count = property.isList ? ReadCount(property.countType, property.type) : 1;
+            for (size_t i = 0; i < count && !failed; i++)
+                Read(property.type);
+        }
+    private:
+        const char* p;
+        const char* end;
+        PlyFormat format;
+        bool swapBytes;
+
+        template<typename T>
+        static double Cast(const unsigned char* bytes)
+        {
+            T value;
+            std::memcpy(&value, bytes, sizeof(T));
+            return static_cast<double>(value);
+        }
+
+        double ReadText()
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n'))
+                p++;
+            if (p < end && *p == '+')
+                p++;
+
+            double value = 0;
+            auto result = std::from_chars(p, end, value);
+            if (result.ec != std::errc())
+            {
+                failed = true;
+                return 0;
+            }
+            p = result.ptr;
+            return value;
+        }
+    };
+
+    // Parses everything up to end_header, body is set to the first byte after it
+    bool ParseHeader(const char* begin, const char* end, PlyFormat& format, std::vector<PlyElement>& elements, const char*& body)
+    {
+        const char* lineStart = begin;
+        bool sawMagic = false;
+        bool sawFormat = false;
+
+        while (lineStart < end)
+        {
+            const char* lineEnd = static_cast<const char*>(std::memchr(lineStart, '\n', end - lineStart));
+            if (!lineEnd)
+                return false;
+
+            std::vector<std::string> tokens;
+            const char* p = lineStart;
+            while (p < lineEnd)
+            {
+                while (p < lineEnd && (*p == ' ' || *p == '\t' || *p == '\r'))
+                    p++;
+                const char* tokenStart = p;
+                while (p < lineEnd && *p != ' ' && *p != '\t' && *p != '\r')
+                    p++;
+                if (p > tokenStart)
+                    tokens.emplace_back(tokenStart, p);
+            }
+            lineStart = lineEnd + 1;
+
+            if (tokens.empty() || tokens[0] == "comment" || tokens[0] == "obj_info")
+                continue;
+
+            if (!sawMagic)
+            {
+                if (tokens[0] != "ply")
+                    return false;
+                sawMagic = true;
+            }
+            else if (tokens[0] == "format" && tokens.size() >= 2)
+            {
+                if (tokens[1] == "ascii") format = PlyFormat::Ascii;
+                else if (tokens[1] == "binary_little_endian") format = PlyFormat::BinaryLittleEndian;
+                else if (tokens[1] == "binary_big_endian") format = PlyFormat::BinaryBigEndian;
+                else return false;
+                sawFormat = true;
+            }
+            else if (tokens[0] == "element" && tokens.size() >= 3)
+            {
+                size_t count = 0;
+                const std::string& countToken = tokens[2];
+                auto result = std::from_chars(countToken.data(), countToken.data() + countToken.size(), count);
+                if (result.ec != std::errc())
+                    return false;
+                elements.push_back(PlyElement{tokens[1], count, {}});
+            }
+            else if (tokens[0] == "property" && !elements.empty())
+            {
+                PlyProperty property;
+                if (tokens.size() >= 5 && tokens[1] == "list")
+                    property = PlyProperty{tokens[4], ParseType(tokens[3]), true, ParseType(tokens[2])};
+                else if (tokens.size() >= 3)
+                    property = PlyProperty{tokens[2], ParseType(tokens[1]), false, PlyType::Invalid};
+                else
+                    return false;
+
+                if (property.type == PlyType::Invalid || (property.isList && property.countType == PlyType::Invalid))
+                    return false;
+                elements.back().properties.push_back(property);
+            }
+            else if (tokens[0] == "end_header")
+            {
+                body = lineStart;
+                return sawFormat;
+            }
+        }
+        return false;
+    }
+
+    void ReadVertices(PlyReader& reader, const PlyElement& element, MeshBuffers& buffers)
+    {
+        std::vector<VertexSlot> slots;
+        bool present[SLOT_COUNT] = {};
+        for (const PlyProperty& property : element.properties)
+        {
+            VertexSlot slot = property.isList ? SLOT_NONE : SlotOf(property.name);
+            slots.push_back(slot);
+            if (slot != SLOT_NONE)
+                present[slot] = true;
+        }
+
+        bool hasNormals = present[SLOT_NX] && present[SLOT_NY] && present[SLOT_NZ];
+        bool hasUVs = present[SLOT_U] && present[SLOT_V];
+
+        buffers.positions.resize(element.count);
+        if (hasNormals) buffers.normals.resize(element.count);
+        if (hasUVs) buffers.uvs.resize(element.count);
+
+        for (size_t vertex = 0; vertex < element.count && !reader.failed; vertex++)
+        {
+            float values[SLOT_COUNT] = {};
+            for (size_t i = 0; i < slots.size(); i++)
+            {
+                if (slots[i] == SLOT_NONE)
+                    reader.Skip(element.properties[i]);
+                else
+                    values[slots[i]] = static_cast<float>(reader.Read(element.properties[i].type));
+            }
+
+            buffers.positions[vertex] = vec3(values[SLOT_X], values[SLOT_Y], values[SLOT_Z]);
+            if (hasNormals) buffers.normals[vertex] = vec3(values[SLOT_NX], values[SLOT_NY], values[SLOT_NZ]);
+            if (hasUVs) buffers.uvs[vertex] = vec2(values[SLOT_U], values[SLOT_V]);
+        }
+    }
+
+    // Polygons are fanned around their first corner
+    void ReadFaces(PlyReader& reader, const PlyElement& element, MeshBuffers& buffers)
+    {
+        buffers.indices.reserve(buffers.indices.size() + element.count * 3);
+        std::vector<uint32_t> polygon;
+
+        for (size_t face = 0; face < element.count && !reader.failed; face++)
+        {
+            for (const PlyProperty& property : element.properties)
+            {
+                if (!property.isList || (property.name != "vertex_indices" && property.name != "vertex_index"))
+                {
+                    reader.Skip(property);
+                    continue;
+                }
+
+                size_t count = reader.ReadCount(property.countType, property.type);
+                polygon.resize(count);
+                for (size_t i = 0; i < count && !reader.failed; i++)
+                    polygon[i] = static_cast<uint32_t>(reader.Read(property.type));
+                if (reader.failed)
+                    return;
+
+                for (size_t i = 2; i < count; i++)
+                {
+                    buffers.indices.push_back(polygon[0]);
+                    buffers.indices.push_back(polygon[i - 1]);
+                    buffers.indices.push_back(polygon[i]);
+                }
+            }
+        }
+    }
+}
+
+void ImportPLY(const char* path, MeshBuffers& buffers)
+{
+    buffers.Clear();
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+    {
+        std::cerr << "Error: Unable to find or open the file " << path << std::endl;
+        return;
+    }
+
+    PlyFormat format = PlyFormat::Ascii;
+    std::vector<PlyElement> elements;
+    const char* body = nullptr;
+    if (!ParseHeader(file.Data(), file.Data() + file.Size(), format, elements, body))
+    {
+        std::cerr << "Error: Invalid PLY header in " << path << std::endl;
+        return;
+    }
+
+    PlyReader reader(body, file.Data() + file.Size(), format);
+    for (const PlyElement& element : elements)
+    {
+        if (!reader.CanHold(element))
+            reader.failed = true;
+        else if (element.name == "vertex")
+        {
+            ReadVertices(reader, element, buffers);
+        }
+        else if (element.name == "face")
+        {
+            ReadFaces(reader, element, buffers);
+        }
+        else
+        {
+            for (size_t i = 0; i < element.count && !reader.failed; i++)
+                for (const PlyProperty& property : element.properties)
+                    reader.Skip(property);
+        }
+
+        if (reader.failed)
+        {
+            std::cerr << "Error: Unexpected end of data in " << path << std::endl;
+            buffers.Clear();
+            return;
+        }
+    }
+}
+
+}
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "quad.hpp"
 
 #include <iostream>
+#include <cmath>
 
 rcl::Quad::Quad(const rcl::vec3& Q, const rcl::vec3& u, const rcl::vec3& v, std::shared_ptr<rcl::Material> mat) 
 : Q(Q), u(u), v(v), mat(mat) 
@@ -10,6 +11,7 @@ rcl::Quad::Quad(const rcl::vec3& Q, const rcl::vec3& u, const rcl::vec3& v, std:
 
     D = rcl::Dot(normal, Q);
     w = n / n.LengthSquared();
+    uvDensity = 1.0f / std::sqrt(static_cast<float>(n.Length()));
 
     SetBoundingBox();
 }
@@ -26,6 +28,11 @@ const rcl::AABB& rcl::Quad::BoundingBox() const
     return bbox;
 }
 
+double rcl::Quad::Area() const
+{
+    return rcl::Cross(u, v).Length();
+}
+
 bool rcl::Quad::hit(const rcl::Ray& ray, const rcl::Interval<double>& interval, rcl::HitRecord& record) const
 {
     double denom = rcl::Dot(normal, ray.direction);
@@ -53,6 +60,7 @@ bool rcl::Quad::hit(const rcl::Ray& ray, const rcl::Interval<double>& interval,
     auto temp = (intersect - Q);
     record.uv.v = rcl::Dot(temp, v) / v.LengthSquared();
     record.uv.u = rcl::Dot(temp, u) / u.LengthSquared();
+    record.uvDensity = uvDensity;
     record.SetNormal(ray, normal);
     record.object = this;
 
@@ -79,11 +87,17 @@ rcl::vec3 rcl::Quad::RandomPointOnSurface() const
 rcl::Ray rcl::Quad::RandomRayFromSurface() const
 {
     rcl::vec3 origin = RandomPointOnSurface();
-    rcl::vec3 dir = rcl::Ray::RandomOnHemisphere(normal);
+    rcl::vec3 dir = rcl::Ray::RandomCosineOnHemisphere(normal);
     return rcl::Ray(origin, dir);    
 }
 
 std::shared_ptr<rcl::Material> rcl::Quad::GetMaterial() const
 {
     return mat;
+}
+
+bool rcl::Quad::FaceNormal(rcl::vec3& normal) const
+{
+    normal = this->normal;
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "model_workers.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdint>
+
+#include "mapped_file.hpp"
+
+namespace rcl
+{
+
+namespace
+{
+    constexpr char MESH_MAGIC[8] = {'R', 'C', 'L', 'M', 'E', 'S', 'H', 0};
+    constexpr uint32_t MESH_VERSION = 1;
+
+    constexpr uint32_t HAS_NORMALS = 1;
+    constexpr uint32_t HAS_UVS = 2;
+
+    // Followed by positions, normals, uvs and indices as raw little-endian arrays in that order.
+    // Every array size is a multiple of 4 bytes, so each one starts aligned for its element type.
+    struct MeshHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t flags;
+        uint64_t vertexCount;
+        uint64_t indexCount;
+    };
+
+    static_assert(sizeof(vec3) == 3 * sizeof(float), "vec3 has to be tightly packed to be mapped from disk");
+    static_assert(sizeof(vec2) == 2 * sizeof(float), "vec2 has to be tightly packed to be mapped from disk");
+
+    template<typename T>
+    void ReadArray(const char*& p, std::vector<T>& target, size_t count)
+    {
+        target.resize(count);
+        std::memcpy(target.data(), p, count * sizeof(T));
+        p += count * sizeof(T);
+    }
+
+    template<typename T>
+    void WriteArray(std::ofstream& file, const std::vector<T>& source)
+    {
+        file.write(reinterpret_cast<const char*>(source.data()), source.size() * sizeof(T));
+    }
+}
+
+void ImportRCLMesh(const char* path, MeshBuffers& buffers)
+{
+    buffers.Clear();
+
+    MappedFile file(path);
+    if (!file.IsOpen())
+    {
+        std::cerr << "Error: Unable to find or open the file " << path << std::endl;
+        return;
+    }
+
+    if (file.Size() < sizeof(MeshHeader))
+    {
+        std::cerr << "Error: Truncated mesh file " << path << std::endl;
+        return;
+    }
+
+    MeshHeader header;
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC)) != 0 || header.version != MESH_VERSION)
+    {
+        std::cerr << "Error: " << path << " is not a version " << MESH_VERSION << " RCL mesh" << std::endl;
+        return;
+    }
+
+    bool hasNormals = header.flags & HAS_NORMALS;
+    bool hasUVs = header.flags & HAS_UVS;
+    size_t expectedSize = sizeof(MeshHeader)
+                        + header.vertexCount * sizeof(vec3) * (hasNormals ? 2 : 1)
+                        + header.vertexCount * (hasUVs ? sizeof(vec2) : 0)
+                        + header.indexCount * sizeof(uint32_t);
+    if (file.Size() != expectedSize || header.indexCount % 3 != 0)
+    {
+        std::cerr << "Error: Corrupted mesh file " << path << std::endl;
+        return;
+    }
+
+    // The arrays are bulk copies out of the mapping, nothing is decoded
+    const char* p = file.Data() + sizeof(MeshHeader);
+    ReadArray(p, buffers.positions, header.vertexCount);
+    if (hasNormals) ReadArray(p, buffers.normals, header.vertexCount);
+    if (hasUVs) ReadArray(p, buffers.uvs, header.vertexCount);
+    ReadArray(p, buffers.indices, header.indexCount);
+}
+
+bool ExportRCLMesh(const char* path, const MeshBuffers& buffers)
+{
+    bool hasNormals = !buffers.normals.empty();
+    bool hasUVs = !buffers.uvs.empty();
+    if ((hasNormals && buffers.normals.size() != buffers.positions.size()) ||
+        (hasUVs && buffers.uvs.size() != buffers.positions.size()))
+    {
+        std::cerr << "Error: Mesh attribute arrays differ in length, " << path << " not written" << std::endl;
+        return false;
+    }
+
+    MeshHeader header;
+    std::memcpy(header.magic, MESH_MAGIC, sizeof(MESH_MAGIC));
+    header.version = MESH_VERSION;
+    header.flags = (hasNormals ? HAS_NORMALS : 0) | (hasUVs ? HAS_UVS : 0);
+    header.vertexCount = buffers.positions.size();
+    header.indexCount = buffers.indices.size();
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Unable to open " << path << " for writing" << std::endl;
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteArray(file, buffers.positions);
+    WriteArray(file, buffers.normals);
+    WriteArray(file, buffers.uvs);
+    WriteArray(file, buffers.indices);
+
+    if (!file)
+    {
+        std::cerr << "Error: Failed to write " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
\ No newline at end of file
@@ -35,6 +35,8 @@ bool Sphere::hit(const Ray& ray, const Interval<double>& interval, HitRecord& re
     record.mat = mat;
     record.object = this;
     get_sphere_uv(outward_normal, record.uv);
+    // u runs around the circumference 2 pi r, v from pole to pole over pi r
+    record.uvDensity = static_cast<float>(1.0 / (PI * radius * std::sqrt(2.0)));
 
     return true;
 }
@@ -44,16 +46,21 @@ const AABB& Sphere::BoundingBox() const
     return bbox;
 }
 
+double Sphere::Area() const
+{
+    return 4 * PI * radius * radius;
+}
+
 vec3 Sphere::RandomPointOnSurface() const
 {
-    return vec3::RandomUnitVector() * radius;
+    return center + vec3::RandomUnitVector() * radius;
 }
     
 Ray Sphere::RandomRayFromSurface() const
 {
     vec3 origin = RandomPointOnSurface();
     vec3 n = (origin - center).Unit();
-    vec3 dir = Ray::RandomOnHemisphere(n);
+    vec3 dir = Ray::RandomCosineOnHemisphere(n);
     return Ray(origin, dir);    
 }
 
@@ -10,6 +10,19 @@ rcl::VertexTriangle::VertexTriangle(rcl::Vertex a, rcl::Vertex b, rcl::Vertex c)
     SetBoundingBox();
 }
 
+void rcl::VertexTriangle::SetVertices(const rcl::Vertex& newA, const rcl::Vertex& newB, const rcl::Vertex& newC)
+{
+    a = newA;
+    b = newB;
+    c = newC;
+    SetBoundingBox();
+}
+
+const rcl::Vertex& rcl::VertexTriangle::GetVertex(int index) const
+{
+    return index == 0 ? a : index == 1 ? b : c;
+}
+
 void rcl::VertexTriangle::SetBoundingBox()
 {
     auto bbox_diagonal1 = rcl::AABB(a.coord, b.coord);
@@ -22,6 +35,11 @@ const rcl::AABB& rcl::VertexTriangle::BoundingBox() const
     return bbox;
 }
     
+double rcl::VertexTriangle::Area() const
+{
+    return 0.5 * rcl::Cross(b.coord - a.coord, c.coord - a.coord).Length();
+}
+
 std::shared_ptr<rcl::Material> rcl::VertexTriangle::GetMaterial() const
 {
     return nullptr;
@@ -59,8 +77,11 @@ const
 
     record.distance = t;
     record.point = ray.At(t);
-    record.uv = t * a.uv + u * b.uv + v * c.uv;
-    record.SetNormal(ray, t * a.normal + u * b.normal + v * c.normal);
+    record.uv = (1 - u - v) * a.uv + u * b.uv + v * c.uv;
+    record.uvDensity = rcl::HitRecord::TriangleUVDensity(e1, e2, a.uv, b.uv, c.uv);
+
+    rcl::vec3 normal = (1 - u - v) * a.normal + u * b.normal + v * c.normal;
+    record.SetNormal(ray, normal.LengthSquared() > 0 ? normal.Unit() : normal);
     //record.mat = std::make_shared<rcl::Lambertian>(rcl::vec3(0.0f));
 
     return true;
@@ -68,30 +89,28 @@ const
     
 rcl::vec3 rcl::VertexTriangle::RandomPointOnSurface() const
 {
-    return a.coord + (b.coord - a.coord) * RandomDouble01() + (c.coord - a.coord) * RandomDouble01();
+    double u, v;
+    rcl::RandomBarycentric(u, v);
+    return a.coord + (b.coord - a.coord) * u + (c.coord - a.coord) * v;
 }
     
 rcl::Ray rcl::VertexTriangle::RandomRayFromSurface() const
 {
-    rcl::vec3 P = RandomPointOnSurface();
-    rcl::vec3 v0 = c.coord - a.coord;
-    rcl::vec3 v1 = b.coord - a.coord;
-    rcl::vec3 v2 = P - a.coord;
-    
-    double d00 = rcl::Dot(v0, v0);
-    double d01 = rcl::Dot(v0, v1);
-    double d11 = rcl::Dot(v1, v1);
-    double d02 = rcl::Dot(v0, v2);
-    double d12 = rcl::Dot(v1, v2);
-
-    double denom = d00 * d11 - d01*d01;
+    double u, v;
+    rcl::RandomBarycentric(u, v);
 
-    double beta = (d11 * d02 - d01 * d12) / denom;
-    double gamma = (d00 * d12 - d01 * d02) / denom;
-    double alpha = 1 - beta - gamma;
-
-    rcl::vec3 n = a.normal * alpha + b.normal * beta + c.normal * gamma;
-    rcl::vec3 dir = rcl::Ray::RandomOnHemisphere(n);
+    rcl::vec3 P = a.coord + (b.coord - a.coord) * u + (c.coord - a.coord) * v;
+    rcl::vec3 n = a.normal * (1 - u - v) + b.normal * u + c.normal * v;
+    rcl::vec3 dir = rcl::Ray::RandomCosineOnHemisphere(n);
 
     return rcl::Ray(P, dir);    
+}
+
+bool rcl::VertexTriangle::FaceNormal(rcl::vec3& normal) const
+{
+    rcl::vec3 n = rcl::Cross(b.coord - a.coord, c.coord - a.coord);
+    if (n.LengthSquared() <= 0)
+        return false;
+    normal = n.Unit();
+    return true;
 }
\ No newline at end of file
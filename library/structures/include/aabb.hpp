@@ -21,6 +21,7 @@ struct AABB
     int LongestAxis() const;
     double Volume() const;
     double DiagonalLength() const;
+    double SurfaceArea() const;
 
     void PadToMinimum();
 
@@ -38,6 +38,8 @@ private:
     rcl::vec3 pixel00Loc;   
     rcl::vec3 pixelDelta_u;
     rcl::vec3 pixelDelta_v;
+    // Angle one pixel subtends, the spread of the camera's ray cones
+    float pixelSpread;
 
     rcl::vec3 u, v, w;
 
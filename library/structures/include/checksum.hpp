@@ -0,0 +1,23 @@
+#ifndef RCL_CHECKSUM
+#define RCL_CHECKSUM
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rcl
+{
+    // CRC-32 as used by PNG chunks, zlib's gzip and ISO 3309. Pass a previous result to continue
+    // over several buffers, crc32(b, n2, crc32(a, n1)) is the CRC of a followed by b.
+    // Uses carry-less multiplication (PCLMUL) when the processor has it, eight tables otherwise.
+    uint32_t crc32(const unsigned char* data, size_t length, uint32_t crc = 0);
+    // CRC-32 of two buffers back to back, from their own CRCs and the second one's length
+    uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t length2);
+
+    // Adler-32 of data (RFC 1950), pass a previous result to continue over several buffers.
+    // Sums 32 bytes per step with SSSE3 when the processor has it.
+    uint32_t adler32(const unsigned char* data, size_t length, uint32_t adler = 1);
+    // Adler-32 of two buffers back to back, from their own checksums and the second one's length
+    uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t length2);
+}
+
+#endif
\ No newline at end of file
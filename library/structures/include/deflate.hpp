@@ -0,0 +1,32 @@
+#ifndef RCL_DEFLATE
+#define RCL_DEFLATE
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "checksum.hpp"
+
+namespace rcl
+{
+    // zlib stream (RFC 1950) holding data DEFLATE compressed (RFC 1951). Levels follow zlib:
+    // 0 only stores, 1 to 3 take the first good match, 4 to 9 look one byte ahead for a longer
+    // one and search longer hash chains. Every block is written stored, with the fixed codes or
+    // with its own codes, whichever comes out smallest.
+    std::vector<unsigned char> zlib_compress(const unsigned char* data, size_t length, int level = 6);
+
+    // Inverse of zlib_compress for any valid zlib stream, checks the Adler-32 too. Huffman codes
+    // are decoded with lookup tables over the next 10 bits, longer codes through a second table.
+    // size_hint, the expected output size if known, saves growing the output.
+    bool zlib_decompress(const unsigned char* data, size_t length, std::vector<unsigned char>& output, size_t size_hint = 0);
+
+    // Pieces for building a zlib stream from segments compressed separately, possibly in parallel.
+    // deflate_segment appends the raw DEFLATE blocks of data[start, end); up to 32K bytes before
+    // start serve as dictionary, so the split costs little. Segments other than the last end with
+    // a sync flush and can be concatenated in order between zlib_header and zlib_trailer.
+    void zlib_header(int level, std::vector<unsigned char>& output);
+    void zlib_trailer(uint32_t adler, std::vector<unsigned char>& output);
+    void deflate_segment(const unsigned char* data, size_t start, size_t end, int level, bool last, std::vector<unsigned char>& output);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,207 @@
+#ifndef RCL_HDR
+#define RCL_HDR
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+namespace rcl
+{
+
+namespace
+{
+    // Runs shorter than this are cheaper as literals
+    const int RGBE_MIN_RUN = 4;
+
+    bool isLittleEndian()
+    {
+        const uint16_t probe = 1;
+        unsigned char first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+    void swapFloatBytes(unsigned char* bytes, size_t count)
+    {
+        for (size_t i = 0; i < count; i++, bytes += 4)
+        {
+            std::swap(bytes[0], bytes[3]);
+            std::swap(bytes[1], bytes[2]);
+        }
+    }
+
+    // Shared exponent encoding from the float's own exponent bits: the largest component's
+    // exponent E gives the RGBE exponent E + 2 and the mantissa scale 2^(134 - E) = 2^(8 - e),
+    // what frexp would give without calling it. Negative components are stored as zero.
+    void floatToRGBE(const float* rgb, unsigned char* rgbe)
+    {
+        float r = std::max(rgb[0], 0.0f);
+        float g = std::max(rgb[1], 0.0f);
+        float b = std::max(rgb[2], 0.0f);
+        float v = std::min(std::max(r, std::max(g, b)), 1.0e38f);
+        if (!(v >= 1.0e-32f))
+        {
+            rgbe[0] = rgbe[1] = rgbe[2] = rgbe[3] = 0;
+            return;
+        }
+
+        uint32_t bits;
+        std::memcpy(&bits, &v, 4);
+        uint32_t exponent = (bits >> 23) & 0xFF;
+        uint32_t scaleBits = (261 - exponent) << 23;
+        float scale;
+        std::memcpy(&scale, &scaleBits, 4);
+
+        rgbe[0] = static_cast<unsigned char>(r * scale);
+        rgbe[1] = static_cast<unsigned char>(g * scale);
+        rgbe[2] = static_cast<unsigned char>(b * scale);
+        rgbe[3] = static_cast<unsigned char>(exponent + 2);
+    }
+
+    // Factor of each RGBE exponent, mantissas are taken at the middle of their step as Radiance does
+    struct RGBEScales
+    {
+        float scales[256];
+
+        RGBEScales()
+        {
+            scales[0] = 0;
+            for (int e = 1; e < 256; e++)
+                scales[e] = static_cast<float>(std::ldexp(1.0, e - 136));
+        }
+    };
+
+    void rgbeToFloat(const unsigned char* rgbe, float* rgb)
+    {
+        static const RGBEScales table;
+        float scale = table.scales[rgbe[3]];
+        rgb[0] = rgbe[3] ? (rgbe[0] + 0.5f) * scale : 0.0f;
+        rgb[1] = rgbe[3] ? (rgbe[1] + 0.5f) * scale : 0.0f;
+        rgb[2] = rgbe[3] ? (rgbe[2] + 0.5f) * scale : 0.0f;
+    }
+
+    // One channel of a scanline, stride bytes apart, as runs of repeated bytes (count + 128, byte)
+    // and literals (count, bytes), counts up to 127 and 128
+    void encodeRGBERuns(const unsigned char* data, int count, int stride, std::vector<unsigned char>& out)
+    {
+        int current = 0;
+        while (current < count)
+        {
+            // Find the next run worth encoding
+            int runStart = current;
+            int runLength = 0;
+            int previousRunLength = 0;
+            while (runLength < RGBE_MIN_RUN && runStart < count)
+            {
+                runStart += runLength;
+                previousRunLength = runLength;
+                runLength = 1;
+                while (runStart + runLength < count && runLength < 127 &&
+                       data[runStart * stride] == data[(runStart + runLength) * stride])
+                    runLength++;
+            }
+
+            // A short run right before the long one
+            if (previousRunLength > 1 && previousRunLength == runStart - current)
+            {
+                out.push_back(static_cast<unsigned char>(128 + previousRunLength));
+                out.push_back(data[current * stride]);
+                current = runStart;
+            }
+
+            while (current < runStart)
+            {
+                int literals = std::min(128, runStart - current);
+                out.push_back(static_cast<unsigned char>(literals));
+                for (int i = 0; i < literals; i++)
+                    out.push_back(data[(current + i) * stride]);
+                current += literals;
+            }
+
+            if (runLength >= RGBE_MIN_RUN)
+            {
+                out.push_back(static_cast<unsigned char>(128 + runLength));
+                out.push_back(data[runStart * stride]);
+                current += runLength;
+            }
+        }
+    }
+
+    // Reads one scanline of width RGBE pixels starting at in, false when the data runs out or is
+    // malformed. Handles run length encoded, flat and old style (1, 1, 1, repeat) scanlines.
+    bool decodeRGBEScanline(const unsigned char*& in, const unsigned char* end, int width, unsigned char* rgbe)
+    {
+        if (end - in < 4)
+            return false;
+
+        bool encoded = width >= 8 && width <= 0x7FFF && in[0] == 2 && in[1] == 2 && !(in[2] & 0x80);
+        if (!encoded)
+        {
+            int shift = 0;
+            int x = 0;
+            while (x < width)
+            {
+                if (end - in < 4)
+                    return false;
+                if (in[0] == 1 && in[1] == 1 && in[2] == 1)
+                {
+                    if (x == 0 || shift > 16)
+                        return false;
+                    int repeat = in[3] << shift;
+                    if (repeat > width - x)
+                        return false;
+                    for (int i = 0; i < repeat; i++, x++)
+                        std::memcpy(rgbe + 4 * x, rgbe + 4 * (x - 1), 4);
+                    shift += 8;
+                }
+                else
+                {
+                    std::memcpy(rgbe + 4 * x, in, 4);
+                    x++;
+                    shift = 0;
+                }
+                in += 4;
+            }
+            return true;
+        }
+
+        if (((in[2] << 8) | in[3]) != width)
+            return false;
+        in += 4;
+
+        for (int channel = 0; channel < 4; channel++)
+        {
+            int x = 0;
+            while (x < width)
+            {
+                if (in >= end)
+                    return false;
+                int count = *in++;
+                if (count > 128)
+                {
+                    count -= 128;
+                    if (count > width - x || in >= end)
+                        return false;
+                    unsigned char value = *in++;
+                    for (int i = 0; i < count; i++)
+                        rgbe[4 * (x + i) + channel] = value;
+                }
+                else
+                {
+                    if (count == 0 || count > width - x || end - in < count)
+                        return false;
+                    for (int i = 0; i < count; i++)
+                        rgbe[4 * (x + i) + channel] = in[i];
+                    in += count;
+                }
+                x += count;
+            }
+        }
+        return true;
+    }
+}
+
+}
+#endif
\ No newline at end of file
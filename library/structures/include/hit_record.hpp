@@ -2,6 +2,8 @@
 #define RCL_HIT_RECORD
 
 #include <memory>
+#include <cmath>
+#include <algorithm>
 
 #include "ray.hpp"
 
@@ -20,12 +22,35 @@ struct HitRecord
     double distance;
     bool frontFace;
     mutable const rcl::Hittable* object;
+    // UV units per unit of distance along the surface around the hit, 0 when the primitive
+    // does not tell. Turns the ray cone into a texture footprint.
+    float uvDensity = 0;
     
     void SetNormal(const rcl::Ray& ray, const rcl::vec3& outward_normal)
     {
         frontFace = rcl::Dot(ray.direction, outward_normal) < 0;
         normal = frontFace ? outward_normal : -outward_normal;
     }
+
+    // uvDensity of a triangle from the edges leaving its first corner and the corners' UVs:
+    // the square root of its area in UV over its area in space
+    static float TriangleUVDensity
+    (const rcl::vec3& e1, const rcl::vec3& e2, const rcl::vec2& uv0, const rcl::vec2& uv1, const rcl::vec2& uv2)
+    {
+        rcl::vec2 d1 = uv1 - uv0;
+        rcl::vec2 d2 = uv2 - uv0;
+        float uvArea = std::fabs(d1.u * d2.v - d1.v * d2.u);
+        float area = rcl::Cross(e1, e2).Length();
+        return area > 0 ? std::sqrt(uvArea / area) : 0.0f;
+    }
+
+    // Width in UV units of the area the ray's cone covers around the hit, stretched by the angle
+    // it meets the surface at. Grazing angles are capped so the footprint stays finite.
+    float UVFootprint(const rcl::Ray& ray) const
+    {
+        float cosine = std::fabs(rcl::Dot(ray.direction, normal));
+        return ray.ConeWidth(static_cast<float>(distance)) * uvDensity / std::max(cosine, 0.125f);
+    }
 };
 
 }
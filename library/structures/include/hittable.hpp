@@ -21,10 +21,17 @@ public:
     virtual bool hit(const Ray& ray, const Interval<double>& interval, HitRecord& record) const = 0;
 
     virtual const AABB& BoundingBox() const = 0;
+    virtual double Area() const = 0;
 
     virtual vec3 RandomPointOnSurface() const = 0;
+    // Origin uniform over the surface, direction cosine weighted about its normal, as a
+    // Lambertian emitter shines
     virtual Ray RandomRayFromSurface() const = 0;
     virtual std::shared_ptr<Material> GetMaterial() const = 0;
+
+    // Unit normal shared by the whole surface, false for curved or compound objects.
+    // Light hierarchies use it to bound the directions an emitter can shine in.
+    virtual bool FaceNormal(vec3& /*normal*/) const { return false; }
 };
 
 }
@@ -60,5 +60,18 @@ public:
     }
 };
 
+// Radiance an emitter gives off, zero without a material. Lights emit the same over their whole
+// surface, so any point of it stands for all of them.
+inline rcl::vec3 EmitterRadiance(const rcl::Hittable& emitter)
+{
+    std::shared_ptr<rcl::Material> mat = emitter.GetMaterial();
+    if (!mat)
+        return rcl::vec3(0);
+
+    rcl::HitRecord rec;
+    rec.point = emitter.RandomPointOnSurface();
+    return mat->IntenseEmitted(rec);
+}
+
 }
 #endif
\ No newline at end of file
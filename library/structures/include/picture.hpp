@@ -5,30 +5,78 @@
 
 #include "vector.hpp"
 #include "camera.hpp"
+#include "resolve.hpp"
 
 namespace rcl
 {
 
+// Non-owning window onto rows of pixels, stride pixels apart. Valid while the pixels are.
+class PictureView
+{
+public:
+    PictureView() = default;
+    PictureView(rcl::vec3* data, int width, int height, int stride);
+
+    // The part at (x, y) of size width * height, clipped to this one
+    PictureView View(int x, int y, int width, int height) const;
+
+    rcl::vec3* Row(int h) const;
+    rcl::vec3 GetPixel(int h, int w) const;
+    void WritePixel(int h, int w, const rcl::vec3& data) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetStride() const;
+private:
+    rcl::vec3* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+};
+
+// Pixels top row first. Owns its storage, from AllocatePixels, unless made over the caller's
+// pixels. Moving hands the storage over, copying always makes an owned copy.
 class Picture
 {
 public:
-    Picture(rcl::Camera cam);
+    Picture(const rcl::Camera& cam);
     Picture(int width, int height);
     Picture(const char* path);
+    // Over width * height pixels the caller keeps alive, nothing is copied or freed
+    Picture(rcl::vec3* pixels, int width, int height);
+    // Copies the pixels of the view
+    explicit Picture(const PictureView& view);
     Picture(const Picture& other);
+    Picture(Picture&& other) noexcept;
     Picture();
 
     ~Picture();
     
     Picture& operator=(const Picture& other);
+    Picture& operator=(Picture&& other) noexcept;
 
     void Import(const char* path);
-    void Export(const char* path) const;
+    // By extension: .png, .ppm, or .pfm and .hdr keeping values above 1.
+    // compressionLevel applies to PNG, 0 to 9 as in zlib
+    void Export(const char* path, int compressionLevel = 6) const;
+    // Linear pixels through settings on their way out. PNG and PPM rows are tone mapped, gamma
+    // corrected and quantized in one pass, with no resolved copy of the picture.
+    void Export(const char* path, const rcl::ResolveSettings& settings, int compressionLevel = 6) const;
 
     rcl::vec3 GetPixel(const rcl::vec2& uv) const;
     void WritePixel(const int height, const int width, const rcl::vec3& data);
 
     void GammaCorection();
+    // Exposure, tone and transfer curves over all pixels in place
+    void Resolve(const rcl::ResolveSettings& settings);
+
+    // All pixels, or the part at (x, y) of size width * height
+    PictureView View();
+    PictureView View(int x, int y, int width, int height);
+
+    rcl::vec3* GetData();
+    const rcl::vec3* GetData() const;
+    bool OwnsData() const;
 
     int GetWidth() const;
     int GetHeight() const;
@@ -37,6 +85,9 @@ private:
     rcl::vec3* data;
     int width;
     int height;
+    bool owner;
+
+    void Release();
 };
 
 }
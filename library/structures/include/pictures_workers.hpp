@@ -1,15 +1,100 @@
 #ifndef RCL_PICTURES_WORKERS
 #define RCL_PICTURES_WORKERS
 
+#include <fstream>
+#include <vector>
+#include <cstdint>
+
 #include "vector.hpp"
+#include "resolve.hpp"
 
 namespace rcl
 {
+    // Pixel storage of Picture and the importers, zeroed and aligned to PIXEL_ALIGNMENT bytes.
+    // Buffers of PIXEL_MAP_BYTES or more are mapped from the system directly: their pages are zero
+    // until first written instead of cleared up front, and go back to the system when freed.
+    const size_t PIXEL_ALIGNMENT = 64;
+    const size_t PIXEL_MAP_BYTES = 2 * 1024 * 1024;
+    rcl::vec3* AllocatePixels(size_t count);
+    // count as allocated, it tells how the buffer was obtained
+    void FreePixels(rcl::vec3* data, size_t count);
+
+    // The importers allocate data with AllocatePixels
     void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data);
-    void ExportPNG(const char* path, int width, int height, const rcl::vec3* const & data);
+    // compressionLevel 0 to 9 as in zlib, 0 writes the pixels uncompressed
+    void ExportPNG(const char* path, int width, int height, const rcl::vec3* const & data, int compressionLevel = 6);
 
+    // Reads text (P3) and binary (P6) files with 8 or 16-bit samples
     void ImportPPM(const char* path, int& width, int& height, rcl::vec3*& data);
-    void ExportPPM(const char* path, int width, int height, const rcl::vec3* const & data);
+    // Binary (P6), bitDepth 8 or 16
+    void ExportPPM(const char* path, int width, int height, const rcl::vec3* const & data, int bitDepth = 8);
+
+    // Portable float map: linear RGB as 32-bit floats, read and written a whole body or row at once.
+    // One channel maps are read as gray.
+    void ImportPFM(const char* path, int& width, int& height, rcl::vec3*& data);
+    void ExportPFM(const char* path, int width, int height, const rcl::vec3* const & data);
+
+    // Radiance RGBE (.hdr): linear RGB as 8-bit mantissas sharing an exponent, scanlines run length
+    // encoded. Only the usual -Y +X orientation is read.
+    void ImportHDR(const char* path, int& width, int& height, rcl::vec3*& data);
+    void ExportHDR(const char* path, int width, int height, const rcl::vec3* const & data);
+
+    // Writes an image while it is still being produced: rows are handed over top to bottom, any
+    // number at a time, and are on disk when WriteRows returns, as IDAT chunks of their own for
+    // PNG. Only the rows of the current call are held in 8 bits, plus the previous row and the
+    // last 32K of filtered data the PNG filter and compressor refer to, so the full image never is.
+    // The rows can be linear, SetResolve tone maps and gamma corrects them while quantizing.
+    // ExportPNG and ExportPPM write through it too, with all rows at once.
+    class ImageStreamWriter
+    {
+    public:
+        enum class Format
+        {
+            PNG,
+            // Binary PPM (P6) with 8 or 16-bit samples
+            PPM,
+            PPM16
+        };
+
+        ImageStreamWriter() = default;
+        // Format from the extension, as Picture::Export picks it
+        ImageStreamWriter(const char* path, int width, int height, int compressionLevel = 6);
+        ImageStreamWriter(const ImageStreamWriter&) = delete;
+        ImageStreamWriter& operator=(const ImageStreamWriter&) = delete;
+        ~ImageStreamWriter();
+
+        // False, with an error, when the file cannot be created. compressionLevel applies to PNG.
+        bool Open(const char* path, int width, int height, int compressionLevel = 6);
+        bool Open(const char* path, int width, int height, Format format, int compressionLevel = 6);
+        // Appends the next count rows, count * width pixels
+        bool WriteRows(const rcl::vec3* rows, int count);
+        // Ends the file, false when rows are missing or writing failed
+        bool Close();
+        // Applied to the rows on their way to 8 or 16 bits, none by default
+        void SetResolve(const rcl::ResolveSettings& settings);
+
+        bool IsOpen() const;
+        int GetWidth() const;
+        int GetHeight() const;
+        int GetRowsWritten() const;
+    private:
+        std::ofstream file;
+        Format format = Format::PNG;
+        int width = 0;
+        int height = 0;
+        int compressionLevel = 6;
+        int rowsWritten = 0;
+        rcl::ResolveSettings resolve;
+
+        // Last row in 8 bits, the next row is filtered against it
+        std::vector<unsigned char> previousRow;
+        // End of the filtered data so far, dictionary for compressing the next rows
+        std::vector<unsigned char> window;
+        uint32_t adler = 1;
+
+        void WritePNGRows(const rcl::vec3* rows, int count);
+        void WritePPMRows(const rcl::vec3* rows, int count);
+    };
 }
 
 #endif
\ No newline at end of file
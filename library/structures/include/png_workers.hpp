@@ -3,9 +3,13 @@
 
 #include <vector>
 #include <cstring>
+#include <cstdint>
+#include <cstdlib>
 #include <algorithm>
 #include <iostream>
 
+#include "deflate.hpp"
+
 namespace rcl
 {
     // Huffman tree node for DEFLATE decompression
@@ -701,6 +705,65 @@ namespace rcl
         }
     }
 
+    // Filters one row for writing, the inverse of unfilter_scanline. previous is null on the first row.
+    void filter_scanline(unsigned char* filtered, const unsigned char* current, const unsigned char* previous,
+                         unsigned char filter_type, int bytes_per_pixel, int row_bytes)
+    {
+        for (int i = 0; i < row_bytes; i++)
+        {
+            int left = (i >= bytes_per_pixel) ? current[i - bytes_per_pixel] : 0;
+            int up = previous ? previous[i] : 0;
+            int up_left = (previous && i >= bytes_per_pixel) ? previous[i - bytes_per_pixel] : 0;
+
+            int predicted = 0;
+            switch (filter_type)
+            {
+                case 1: predicted = left; break;
+                case 2: predicted = up; break;
+                case 3: predicted = (left + up) / 2; break;
+                case 4:
+                {
+                    int p = left + up - up_left;
+                    int pa = abs(p - left);
+                    int pb = abs(p - up);
+                    int pc = abs(p - up_left);
+                    if (pa <= pb && pa <= pc) predicted = left;
+                    else if (pb <= pc) predicted = up;
+                    else predicted = up_left;
+                    break;
+                }
+            }
+            filtered[i] = static_cast<unsigned char>(current[i] - predicted);
+        }
+    }
+
+    // Filters a row with each of the five filters and keeps the one whose bytes, read as signed,
+    // have the smallest absolute sum. Small residuals compress best, this is libpng's heuristic.
+    unsigned char filter_scanline_adaptive(unsigned char* filtered, const unsigned char* current,
+                                           const unsigned char* previous, int bytes_per_pixel, int row_bytes)
+    {
+        std::vector<unsigned char> candidate(row_bytes);
+        unsigned char best_type = 0;
+        uint64_t best_sum = UINT64_MAX;
+
+        for (unsigned char filter_type = 0; filter_type < 5; filter_type++)
+        {
+            filter_scanline(candidate.data(), current, previous, filter_type, bytes_per_pixel, row_bytes);
+
+            uint64_t sum = 0;
+            for (int i = 0; i < row_bytes && sum < best_sum; i++)
+                sum += abs(static_cast<signed char>(candidate[i]));
+
+            if (sum < best_sum)
+            {
+                best_sum = sum;
+                best_type = filter_type;
+                std::memcpy(filtered, candidate.data(), row_bytes);
+            }
+        }
+        return best_type;
+    }
+
     // Utility functions for reading PNG data
     uint32_t read_uint32_be(std::istream& stream) 
     {
@@ -712,31 +775,12 @@ namespace rcl
         return value;
     }
 
-    // CRC-32 calculation for PNG chunks
-uint32_t crc32(const unsigned char* data, size_t length) 
+void write_uint32_be(std::ostream& stream, uint32_t value)
 {
-    static uint32_t crc_table[256];
-    static bool table_computed = false;
-    
-    if (!table_computed) {
-        for (uint32_t n = 0; n < 256; n++) {
-            uint32_t c = n;
-            for (int k = 0; k < 8; k++) {
-                if (c & 1)
-                    c = 0xedb88320L ^ (c >> 1);
-                else
-                    c = c >> 1;
-            }
-            crc_table[n] = c;
-        }
-        table_computed = true;
-    }
-    
-    uint32_t c = 0xffffffff;
-    for (size_t n = 0; n < length; n++) {
-        c = crc_table[(c ^ data[n]) & 0xff] ^ (c >> 8);
-    }
-    return c ^ 0xffffffff;
+    stream.put((value >> 24) & 0xFF);
+    stream.put((value >> 16) & 0xFF);
+    stream.put((value >> 8) & 0xFF);
+    stream.put(value & 0xFF);
 }
 
 // Write a PNG chunk with proper CRC
@@ -756,64 +800,17 @@ void write_chunk(std::ofstream& file, const char* type, const unsigned char* dat
         file.write(reinterpret_cast<const char*>(data), length);
     }
     
-    // Calculate and write CRC
-    std::vector<unsigned char> crc_data;
-    crc_data.insert(crc_data.end(), type, type + 4);
+    // CRC over type and data, without gathering them
+    uint32_t crc = crc32(reinterpret_cast<const unsigned char*>(type), 4);
     if (data && length > 0) {
-        crc_data.insert(crc_data.end(), data, data + length);
+        crc = crc32(data, length, crc);
     }
     
-    uint32_t crc = crc32(crc_data.data(), crc_data.size());
     file.put((crc >> 24) & 0xFF);
     file.put((crc >> 16) & 0xFF);
     file.put((crc >> 8) & 0xFF);
     file.put(crc & 0xFF);
 }
 
-// Simple deflate compression (creates uncompressed blocks)
-std::vector<unsigned char> simple_deflate(const std::vector<unsigned char>& input) 
-{
-    std::vector<unsigned char> output;
-    
-    // Zlib header (CMF=0x78, FLG=0x01 for default compression)
-    output.push_back(0x78);
-    output.push_back(0x01);
-    
-    size_t remaining = input.size();
-    size_t pos = 0;
-    
-    while (remaining > 0) {
-        size_t block_size = std::min(remaining, static_cast<size_t>(65535));
-        bool is_final = (remaining == block_size);
-        
-        // Block header: BFINAL(1) + BTYPE(2) = 000 for uncompressed, non-final
-        // or 001 for uncompressed, final
-        output.push_back(is_final ? 0x01 : 0x00);
-        
-        // Length (little-endian)
-        uint16_t len = static_cast<uint16_t>(block_size);
-        uint16_t nlen = ~len;
-        
-        output.push_back(len & 0xFF);
-        output.push_back((len >> 8) & 0xFF);
-        output.push_back(nlen & 0xFF);
-        output.push_back((nlen >> 8) & 0xFF);
-        
-        // Copy data
-        output.insert(output.end(), input.begin() + pos, input.begin() + pos + block_size);
-        
-        pos += block_size;
-        remaining -= block_size;
-    }
-    
-    // Adler-32 checksum (simplified - just use 1 for now)
-    output.push_back(0x00);
-    output.push_back(0x00);
-    output.push_back(0x00);
-    output.push_back(0x01);
-    
-    return output;
-}
-
 }
 #endif
\ No newline at end of file
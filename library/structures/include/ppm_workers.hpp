@@ -1,6 +1,8 @@
 #ifndef RCL_PPM
 #define RCL_PPM
 
+#include <vector>
+
 namespace rcl
 {
 
@@ -44,6 +46,37 @@ namespace
             data[i].b = ((float)b) / maxVal;
         }
     }
+
+    // Binary samples, one byte each below maxVal 256, two bytes big endian from there. The body
+    // is read in one block and converted through a table of the byte values.
+    void readP6Format(std::ifstream& file, rcl::vec3*& data, int size, int maxVal)
+    {
+        int bytesPerSample = maxVal < 256 ? 1 : 2;
+        size_t samples = static_cast<size_t>(size) * 3;
+        std::vector<unsigned char> body(samples * bytesPerSample);
+        file.read(reinterpret_cast<char*>(body.data()), body.size());
+        if (file.gcount() != static_cast<std::streamsize>(body.size()))
+        {
+            std::cerr << "Error: Failed to read pixel data" << std::endl;
+            return;
+        }
+
+        float* out = &data[0].r;
+        if (bytesPerSample == 1)
+        {
+            float values[256];
+            for (int v = 0; v < 256; v++)
+                values[v] = static_cast<float>(v) / maxVal;
+            for (size_t i = 0; i < samples; i++)
+                out[i] = values[body[i]];
+        }
+        else
+        {
+            float scale = 1.0f / maxVal;
+            for (size_t i = 0; i < samples; i++)
+                out[i] = static_cast<float>(body[2 * i] << 8 | body[2 * i + 1]) * scale;
+        }
+    }
 }
 
 }
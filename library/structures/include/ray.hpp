@@ -11,13 +11,22 @@ struct Ray
 public:
     rcl::vec3 origin;
     rcl::vec3 direction;
+    // Cone around the ray for texture filtering: its width at the origin and how much that grows
+    // per unit of distance, both 0 for an infinitely thin ray
+    float coneWidth = 0;
+    float coneSpread = 0;
 
     Ray(rcl::vec3 origin = rcl::vec3(0), rcl::vec3 direction = rcl::vec3(0, 0, -1));
-    Ray(const rcl::Ray& original);
+    Ray(const rcl::Ray& original) = default;
+    rcl::Ray& operator=(const rcl::Ray& original) = default;
 
     rcl::vec3 At(float t) const;
+    // Cone width after distance t
+    float ConeWidth(float t) const;
     
     static rcl::vec3 RandomOnHemisphere(const rcl::vec3& normal);
+    // Cosine weighted about normal, the directions a Lambertian surface emits or reflects in
+    static rcl::vec3 RandomCosineOnHemisphere(const rcl::vec3& normal);
     static rcl::vec3 GetRandomDiskRay();
     static rcl::vec3 RandomCosineDirection();
 };
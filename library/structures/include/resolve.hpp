@@ -0,0 +1,51 @@
+#ifndef RCL_RESOLVE
+#define RCL_RESOLVE
+
+#include <cstdint>
+
+#include "vector.hpp"
+
+namespace rcl
+{
+
+enum class ToneCurve
+{
+    None,
+    // x / (x + 1) per channel
+    Reinhard,
+    // Narkowicz's fit of the ACES filmic curve, clipped to [0, 1]
+    ACES
+};
+
+enum class TransferCurve
+{
+    Linear,
+    // Square root, what Picture::GammaCorection applies
+    Gamma2,
+    // The sRGB curve, input clipped to [0, 1]
+    SRGB
+};
+
+// Turns linear radiance into display values: scale by 2^exposure, tone curve and transfer curve
+// per channel, then for integer output dithering and quantization, all in one pass over the
+// pixels. Runs 8 samples at a time with AVX2 when the processor has it, and over rows in parallel.
+struct ResolveSettings
+{
+    // In stops
+    float exposure = 0;
+    ToneCurve toneCurve = ToneCurve::None;
+    TransferCurve transfer = TransferCurve::Linear;
+    // Triangular noise of up to one step added before quantizing, grain instead of banding
+    bool dither = false;
+};
+
+// rows * width pixels from in to out, which may be the same
+void Resolve(const vec3* in, vec3* out, int width, int rows, const ResolveSettings& settings);
+// To 3 samples per pixel. 8-bit values map [k/256, (k+1)/256) to k as the exporters always did,
+// 16-bit ones round to the nearest of 65535 steps. firstRow places the rows in the image so the
+// dither pattern continues across calls.
+void Resolve(const vec3* in, uint8_t* out, int width, int rows, const ResolveSettings& settings, int firstRow = 0);
+void Resolve(const vec3* in, uint16_t* out, int width, int rows, const ResolveSettings& settings, int firstRow = 0);
+
+}
+#endif
\ No newline at end of file
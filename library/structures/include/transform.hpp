@@ -0,0 +1,35 @@
+#ifndef RCL_TRANSFORM
+#define RCL_TRANSFORM
+
+#include "vector.hpp"
+#include "aabb.hpp"
+
+namespace rcl
+{
+
+// Affine transform stored as a row-major 3x4 matrix: linear part plus translation
+struct Transform
+{
+    double m[3][4];
+
+    Transform();
+
+    static Transform Translate(const rcl::vec3& offset);
+    static Transform Scale(const rcl::vec3& factor);
+    static Transform Rotate(const rcl::vec3& axis, double degrees);
+
+    // Applies other first, then this
+    Transform operator*(const Transform& other) const;
+
+    Transform Inverse() const;
+    double Determinant() const;
+
+    rcl::vec3 ApplyPoint(const rcl::vec3& p) const;
+    rcl::vec3 ApplyVector(const rcl::vec3& v) const;
+    // Multiplies by the transposed linear part, maps normals when called on the inverse
+    rcl::vec3 ApplyTransposed(const rcl::vec3& v) const;
+    rcl::AABB ApplyBox(const rcl::AABB& box) const;
+};
+
+}
+#endif
\ No newline at end of file
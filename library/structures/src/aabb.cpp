@@ -50,6 +50,11 @@ double rcl::AABB::DiagonalLength() const
     return (v1 - v2).Length();
 }
 
+double rcl::AABB::SurfaceArea() const
+{
+    return 2 * (x.Size() * y.Size() + y.Size() * z.Size() + z.Size() * x.Size());
+}
+
 void rcl::AABB::PadToMinimum()
 {
     double delta = 0.0001;
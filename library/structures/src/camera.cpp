@@ -19,7 +19,9 @@ rcl::Ray Camera::GetRay(int i, int j, rcl::vec3 offset) const
     rcl::vec3 pixelCenter = pixel00Loc + ((j + offset.x) * pixelDelta_u) + ((i + offset.y) * pixelDelta_v);
     rcl::vec3 rayDirection = pixelCenter - rayOrigin;
 
-    return rcl::Ray(rayOrigin, rayDirection);
+    rcl::Ray ray(rayOrigin, rayDirection);
+    ray.coneSpread = pixelSpread;
+    return ray;
 }
 
 unsigned int Camera::GetPixelsTotal() const
@@ -58,6 +60,7 @@ void Camera::Initialize()
     // Calculate the horizontal and vertical delta vectors from pixel to pixel.
     pixelDelta_u = viewport_u / imageWidth;
     pixelDelta_v = viewport_v / imageHeight;
+    pixelSpread = static_cast<float>(viewportHeight / imageHeight / focusDistance);
 
     // Calculate the location of the upper left pixel.
     rcl::vec3 viewportUpperLeft = lookFrom - focusDistance * w - viewport_u/2 - viewport_v/2;
@@ -0,0 +1,320 @@
+#include "checksum.hpp"
+
+#include <algorithm>
+
+// The x86 paths are compiled for their instruction sets function by function and only called
+// after checking the processor, so the library still runs anywhere
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RCL_CHECKSUM_X86
+#include <immintrin.h>
+#endif
+
+namespace rcl
+{
+
+namespace
+{
+    const uint32_t CRC_POLYNOMIAL = 0xEDB88320u;
+    const uint32_t ADLER_MOD = 65521;
+    // Largest n for which 255n(n+1)/2 + (n+1)(ADLER_MOD-1) fits 32 bits
+    const size_t ADLER_NMAX = 5552;
+
+    // tables[0] advances the CRC over one byte, tables[k] over one byte followed by k zeros,
+    // so eight bytes can be looked up independently
+    struct CrcTables
+    {
+        uint32_t tables[8][256];
+
+        CrcTables()
+        {
+            for (uint32_t n = 0; n < 256; n++)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? CRC_POLYNOMIAL ^ (c >> 1) : c >> 1;
+                tables[0][n] = c;
+            }
+            for (uint32_t n = 0; n < 256; n++)
+                for (int k = 1; k < 8; k++)
+                    tables[k][n] = (tables[k - 1][n] >> 8) ^ tables[0][tables[k - 1][n] & 0xFF];
+        }
+    };
+
+    // Built on first use, the static's initialization is thread safe
+    const CrcTables& crc_tables()
+    {
+        static const CrcTables tables;
+        return tables;
+    }
+
+    uint32_t load_le32(const unsigned char* p)
+    {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+               static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+    }
+
+    // Slice-by-8 on the inverted CRC
+    uint32_t crc32_tables(const unsigned char* data, size_t length, uint32_t c)
+    {
+        const uint32_t (*t)[256] = crc_tables().tables;
+        while (length >= 8)
+        {
+            uint32_t one = c ^ load_le32(data);
+            uint32_t two = load_le32(data + 4);
+            c = t[7][one & 0xFF] ^ t[6][(one >> 8) & 0xFF] ^ t[5][(one >> 16) & 0xFF] ^ t[4][one >> 24] ^
+                t[3][two & 0xFF] ^ t[2][(two >> 8) & 0xFF] ^ t[1][(two >> 16) & 0xFF] ^ t[0][two >> 24];
+            data += 8;
+            length -= 8;
+        }
+        while (length--)
+            c = t[0][(c ^ *data++) & 0xFF] ^ (c >> 8);
+        return c;
+    }
+
+    // Product of two polynomials modulo the CRC-32 polynomial, bit reflected like the CRC itself
+    uint32_t crc32_multiply_mod(uint32_t a, uint32_t b)
+    {
+        uint32_t m = 1u << 31;
+        uint32_t p = 0;
+        for (;;)
+        {
+            if (a & m)
+            {
+                p ^= b;
+                if ((a & (m - 1)) == 0)
+                    break;
+            }
+            m >>= 1;
+            b = (b & 1) ? (b >> 1) ^ CRC_POLYNOMIAL : b >> 1;
+        }
+        return p;
+    }
+
+    uint32_t adler32_scalar(const unsigned char* data, size_t length, uint32_t a, uint32_t b)
+    {
+        while (length > 0)
+        {
+            size_t n = std::min(length, ADLER_NMAX);
+            length -= n;
+            while (n--)
+            {
+                a += *data++;
+                b += a;
+            }
+            a %= ADLER_MOD;
+            b %= ADLER_MOD;
+        }
+        return (b << 16) | a;
+    }
+
+#ifdef RCL_CHECKSUM_X86
+    bool has_pclmul()
+    {
+        static const bool supported = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+        return supported;
+    }
+
+    bool has_ssse3()
+    {
+        static const bool supported = __builtin_cpu_supports("ssse3");
+        return supported;
+    }
+
+    // Folds four 128-bit lanes over the data with carry-less multiplies by x^n mod P, then reduces
+    // the remainder to 32 bits (Intel, "Fast CRC Computation Using PCLMULQDQ"). length is a
+    // multiple of 16 and at least 64, c the inverted CRC.
+    __attribute__((target("pclmul,sse4.1")))
+    uint32_t crc32_pclmul(const unsigned char* data, size_t length, uint32_t c)
+    {
+        // x^(4*128+32), x^(4*128-32), x^(128+32), x^(128-32) and x^64 mod P, the polynomial and
+        // its Barrett constant, all bit reflected
+        const __m128i fold4 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+        const __m128i fold1 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+        const __m128i fold64 = _mm_set_epi64x(0, 0x0163cd6124);
+        const __m128i barrett = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+        const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+
+        __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+        __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32));
+        __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48));
+        x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(c)));
+        data += 64;
+        length -= 64;
+
+        while (length >= 64)
+        {
+            __m128i x5 = _mm_clmulepi64_si128(x1, fold4, 0x00);
+            __m128i x6 = _mm_clmulepi64_si128(x2, fold4, 0x00);
+            __m128i x7 = _mm_clmulepi64_si128(x3, fold4, 0x00);
+            __m128i x8 = _mm_clmulepi64_si128(x4, fold4, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, fold4, 0x11);
+            x2 = _mm_clmulepi64_si128(x2, fold4, 0x11);
+            x3 = _mm_clmulepi64_si128(x3, fold4, 0x11);
+            x4 = _mm_clmulepi64_si128(x4, fold4, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+            x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)));
+            x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 32)));
+            x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 48)));
+            data += 64;
+            length -= 64;
+        }
+
+        // Four lanes into one, then the remaining 16 byte blocks
+        __m128i lanes[3] = {x2, x3, x4};
+        for (const __m128i& next : lanes)
+        {
+            __m128i x5 = _mm_clmulepi64_si128(x1, fold1, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, fold1, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, next), x5);
+        }
+        while (length >= 16)
+        {
+            __m128i x5 = _mm_clmulepi64_si128(x1, fold1, 0x00);
+            x1 = _mm_clmulepi64_si128(x1, fold1, 0x11);
+            x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+            data += 16;
+            length -= 16;
+        }
+
+        // 128 bits to 64
+        __m128i x2r = _mm_clmulepi64_si128(x1, fold1, 0x10);
+        x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+        x2r = _mm_srli_si128(x1, 4);
+        x1 = _mm_and_si128(x1, low32);
+        x1 = _mm_clmulepi64_si128(x1, fold64, 0x00);
+        x1 = _mm_xor_si128(x1, x2r);
+
+        // Barrett reduction to 32 bits
+        x2r = _mm_and_si128(x1, low32);
+        x2r = _mm_clmulepi64_si128(x2r, barrett, 0x10);
+        x2r = _mm_and_si128(x2r, low32);
+        x2r = _mm_clmulepi64_si128(x2r, barrett, 0x00);
+        x1 = _mm_xor_si128(x1, x2r);
+        return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+    }
+
+    // 32 bytes per step: the low sum gains their plain sum, the high sum the sum weighted by
+    // 32 down to 1 plus 32 times the low sum before the step. length is a multiple of 32.
+    __attribute__((target("ssse3")))
+    uint32_t adler32_ssse3(const unsigned char* data, size_t length, uint32_t a, uint32_t b)
+    {
+        const __m128i weights1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+        const __m128i weights2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i ones = _mm_set1_epi16(1);
+
+        size_t blocks = length / 32;
+        while (blocks > 0)
+        {
+            size_t n = std::min(blocks, ADLER_NMAX / 32);
+            blocks -= n;
+
+            // Low sums before each step, added up and scaled by 32 at the end
+            __m128i previous = _mm_cvtsi32_si128(static_cast<int>(a * n));
+            __m128i high = _mm_cvtsi32_si128(static_cast<int>(b));
+            __m128i low = zero;
+            for (size_t i = 0; i < n; i++)
+            {
+                __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+                __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+                previous = _mm_add_epi32(previous, low);
+                low = _mm_add_epi32(low, _mm_sad_epu8(bytes1, zero));
+                high = _mm_add_epi32(high, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, weights1), ones));
+                low = _mm_add_epi32(low, _mm_sad_epu8(bytes2, zero));
+                high = _mm_add_epi32(high, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, weights2), ones));
+                data += 32;
+            }
+            high = _mm_add_epi32(high, _mm_slli_epi32(previous, 5));
+
+            low = _mm_add_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(2, 3, 0, 1)));
+            low = _mm_add_epi32(low, _mm_shuffle_epi32(low, _MM_SHUFFLE(1, 0, 3, 2)));
+            high = _mm_add_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(2, 3, 0, 1)));
+            high = _mm_add_epi32(high, _mm_shuffle_epi32(high, _MM_SHUFFLE(1, 0, 3, 2)));
+            a = (a + static_cast<uint32_t>(_mm_cvtsi128_si32(low))) % ADLER_MOD;
+            b = static_cast<uint32_t>(_mm_cvtsi128_si32(high)) % ADLER_MOD;
+        }
+        return (b << 16) | a;
+    }
+#endif
+}
+
+uint32_t crc32(const unsigned char* data, size_t length, uint32_t crc)
+{
+    uint32_t c = ~crc;
+#ifdef RCL_CHECKSUM_X86
+    if (length >= 64 && has_pclmul())
+    {
+        size_t blocks = length & ~static_cast<size_t>(15);
+        c = crc32_pclmul(data, blocks, c);
+        data += blocks;
+        length -= blocks;
+    }
+#endif
+    return ~crc32_tables(data, length, c);
+}
+
+// CRC-32 of A followed by B from those of A and B: A's CRC is shifted over B's length,
+// a multiplication by x^(8 * length2) done by squaring
+uint32_t crc32_combine(uint32_t crc1, uint32_t crc2, size_t length2)
+{
+    // x^(2^n) modulo the polynomial, starting from x^1
+    struct Table
+    {
+        uint32_t powers[32];
+        Table()
+        {
+            uint32_t p = 1u << 30;
+            for (int n = 0; n < 32; n++)
+            {
+                powers[n] = p;
+                p = crc32_multiply_mod(p, p);
+            }
+        }
+    };
+    static const Table table;
+
+    // x^(8 * length2), from the bits of length2 shifted by 3
+    uint32_t shift = 1u << 31;
+    int k = 3;
+    for (uint64_t n = length2; n; n >>= 1, k++)
+        if (n & 1)
+            shift = crc32_multiply_mod(table.powers[k & 31], shift);
+
+    return crc32_multiply_mod(shift, crc1) ^ crc2;
+}
+
+uint32_t adler32(const unsigned char* data, size_t length, uint32_t adler)
+{
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+#ifdef RCL_CHECKSUM_X86
+    if (length >= 64 && has_ssse3())
+    {
+        size_t blocks = length & ~static_cast<size_t>(31);
+        adler = adler32_ssse3(data, blocks, a, b);
+        a = adler & 0xFFFF;
+        b = adler >> 16;
+        data += blocks;
+        length -= blocks;
+    }
+#endif
+    return adler32_scalar(data, length, a, b);
+}
+
+// Adler-32 of A followed by B from those of A and B: B's low sum is unchanged but offset by A's,
+// its high sum gains A's low sum once per byte of B
+uint32_t adler32_combine(uint32_t adler1, uint32_t adler2, size_t length2)
+{
+    uint32_t remainder = static_cast<uint32_t>(length2 % ADLER_MOD);
+    uint32_t a1 = adler1 & 0xFFFF;
+    uint32_t b1 = adler1 >> 16;
+    uint32_t a2 = adler2 & 0xFFFF;
+    uint32_t b2 = adler2 >> 16;
+
+    uint32_t a = (a1 + a2 + ADLER_MOD - 1) % ADLER_MOD;
+    uint32_t b = static_cast<uint32_t>((static_cast<uint64_t>(remainder) * a1 + b1 + b2 + ADLER_MOD - remainder) % ADLER_MOD);
+    return (b << 16) | a;
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,1152 @@
+#include "deflate.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <utility>
+
+namespace rcl
+{
+
+namespace
+{
+    const int WINDOW_SIZE = 32768;
+    const int WINDOW_MASK = WINDOW_SIZE - 1;
+    const int MIN_MATCH = 3;
+    const int MAX_MATCH = 258;
+    const int HASH_BITS = 15;
+    const int HASH_SIZE = 1 << HASH_BITS;
+    // Shortest matches this far back cost more than their three literals
+    const int TOO_FAR = 4096;
+    const size_t BLOCK_SYMBOLS = 1 << 15;
+    const size_t MAX_STORED = 65535;
+
+    const int LITERAL_CODES = 286;
+    const int DISTANCE_CODES = 30;
+    const int CODE_LENGTH_CODES = 19;
+    const int END_OF_BLOCK = 256;
+    const int MAX_BITS = 15;
+    const int MAX_CODE_LENGTH_BITS = 7;
+
+    const int length_base[29] = {3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258};
+    const int length_extra[29] = {0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0};
+    const int distance_base[30] = {1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577};
+    const int distance_extra[30] = {0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13};
+    const int code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    // Search parameters per level, the same as zlib's: stop early once a match is good or nice
+    // enough, defer to the next byte only below max_lazy, and follow at most max_chain candidates
+    struct LevelConfig
+    {
+        int good_length;
+        int max_lazy;
+        int nice_length;
+        int max_chain;
+        bool lazy;
+    };
+
+    const LevelConfig level_configs[10] = {
+        {0, 0, 0, 0, false},
+        {4, 4, 8, 4, false},
+        {4, 5, 16, 8, false},
+        {4, 6, 32, 32, false},
+        {4, 4, 16, 16, true},
+        {8, 16, 32, 32, true},
+        {8, 16, 128, 128, true},
+        {8, 32, 128, 256, true},
+        {32, 128, 258, 1024, true},
+        {32, 258, 258, 4096, true}
+    };
+
+    // Literal when distance is 0, otherwise a match of length bytes
+    struct Symbol
+    {
+        uint16_t value;
+        uint16_t distance;
+    };
+
+    struct Code
+    {
+        uint16_t bits;
+        uint8_t length;
+    };
+
+    struct CodeTables
+    {
+        uint8_t length_code[MAX_MATCH + 1];
+        uint8_t distance_code[WINDOW_SIZE + 1];
+
+        CodeTables()
+        {
+            for (int code = 0; code < 28; code++)
+                for (int length = length_base[code]; length < length_base[code] + (1 << length_extra[code]); length++)
+                    length_code[length] = static_cast<uint8_t>(code);
+            length_code[MAX_MATCH] = 28;
+
+            for (int code = 0; code < DISTANCE_CODES; code++)
+                for (int distance = distance_base[code]; distance < distance_base[code] + (1 << distance_extra[code]); distance++)
+                    distance_code[distance] = static_cast<uint8_t>(code);
+        }
+    };
+
+    const CodeTables& code_tables()
+    {
+        static const CodeTables tables;
+        return tables;
+    }
+
+    // Bits go out least significant first, as DEFLATE packs them
+    class BitWriter
+    {
+    private:
+        std::vector<unsigned char>& output;
+        uint64_t buffer;
+        int count;
+
+    public:
+        BitWriter(std::vector<unsigned char>& out) : output(out), buffer(0), count(0) {}
+
+        void put(uint32_t value, int bits)
+        {
+            buffer |= static_cast<uint64_t>(value) << count;
+            count += bits;
+            while (count >= 8)
+            {
+                output.push_back(static_cast<unsigned char>(buffer));
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+
+        void put(const Code& code)
+        {
+            put(code.bits, code.length);
+        }
+
+        void align_to_byte()
+        {
+            if (count > 0)
+                put(0, 8 - count);
+        }
+
+        // Only on a byte boundary
+        void put_bytes(const unsigned char* bytes, size_t size)
+        {
+            output.insert(output.end(), bytes, bytes + size);
+        }
+    };
+
+    // Length limited Huffman code lengths. Optimal lengths from a Huffman tree, then if any is
+    // too long the deepest codes are shortened and shallower ones lengthened until the code is
+    // complete again, and the lengths are handed out by frequency.
+    void build_code_lengths(const uint32_t* frequencies, int count, int max_bits, uint8_t* lengths)
+    {
+        std::fill(lengths, lengths + count, 0);
+
+        std::vector<int> used;
+        for (int i = 0; i < count; i++)
+            if (frequencies[i] > 0)
+                used.push_back(i);
+
+        // A code needs two symbols to be complete, pad with unused ones
+        for (int i = 0; i < count && used.size() < 2; i++)
+            if (frequencies[i] == 0)
+                used.push_back(i);
+        if (used.size() < 2)
+            return;
+
+        std::vector<uint64_t> weights(used.size());
+        std::vector<int> parents(2 * used.size() - 1, -1);
+        typedef std::pair<uint64_t, int> Entry;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        for (size_t i = 0; i < used.size(); i++)
+        {
+            weights[i] = frequencies[used[i]];
+            queue.push(Entry(weights[i], static_cast<int>(i)));
+        }
+
+        int next = static_cast<int>(used.size());
+        while (queue.size() > 1)
+        {
+            Entry a = queue.top(); queue.pop();
+            Entry b = queue.top(); queue.pop();
+            parents[a.second] = next;
+            parents[b.second] = next;
+            queue.push(Entry(a.first + b.first, next));
+            next++;
+        }
+
+        // Parents come after their children, so depths fill in walking down from the root
+        std::vector<int> depths(parents.size(), 0);
+        for (int node = static_cast<int>(parents.size()) - 2; node >= 0; node--)
+            depths[node] = depths[parents[node]] + 1;
+
+        std::vector<uint32_t> length_counts(max_bits + 1, 0);
+        for (size_t i = 0; i < used.size(); i++)
+            length_counts[std::min(depths[i], max_bits)]++;
+
+        uint32_t total = 0;
+        for (int bits = max_bits; bits > 0; bits--)
+            total += length_counts[bits] << (max_bits - bits);
+        while (total != (1u << max_bits))
+        {
+            length_counts[max_bits]--;
+            for (int bits = max_bits - 1; bits > 0; bits--)
+            {
+                if (length_counts[bits])
+                {
+                    length_counts[bits]--;
+                    length_counts[bits + 1] += 2;
+                    break;
+                }
+            }
+            total--;
+        }
+
+        // Rarest symbols get the longest codes
+        std::stable_sort(used.begin(), used.end(), [frequencies](int a, int b)
+        {
+            return frequencies[a] < frequencies[b];
+        });
+        size_t symbol = 0;
+        for (int bits = max_bits; bits > 0; bits--)
+            for (uint32_t i = 0; i < length_counts[bits]; i++)
+                lengths[used[symbol++]] = static_cast<uint8_t>(bits);
+    }
+
+    // Canonical codes for the lengths (RFC 1951 3.2.2), bit reversed for the LSB first stream
+    void build_codes(const uint8_t* lengths, int count, Code* codes)
+    {
+        uint16_t length_counts[MAX_BITS + 1] = {0};
+        for (int i = 0; i < count; i++)
+            length_counts[lengths[i]]++;
+        length_counts[0] = 0;
+
+        uint16_t next_code[MAX_BITS + 1] = {0};
+        uint16_t code = 0;
+        for (int bits = 1; bits <= MAX_BITS; bits++)
+        {
+            code = (code + length_counts[bits - 1]) << 1;
+            next_code[bits] = code;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            int length = lengths[i];
+            codes[i].length = static_cast<uint8_t>(length);
+            codes[i].bits = 0;
+            if (length == 0)
+                continue;
+
+            uint16_t value = next_code[length]++;
+            uint16_t reversed = 0;
+            for (int bit = 0; bit < length; bit++)
+                reversed |= ((value >> bit) & 1) << (length - 1 - bit);
+            codes[i].bits = reversed;
+        }
+    }
+
+    // Run length coded code lengths of a dynamic block header, symbol in the low byte, repeat in the high
+    std::vector<uint16_t> run_length_code(const uint8_t* lengths, int count)
+    {
+        std::vector<uint16_t> symbols;
+        int i = 0;
+        while (i < count)
+        {
+            int value = lengths[i];
+            int run = 1;
+            while (i + run < count && lengths[i + run] == value)
+                run++;
+            i += run;
+
+            if (value == 0)
+            {
+                while (run >= 11)
+                {
+                    int repeat = std::min(run, 138);
+                    symbols.push_back(static_cast<uint16_t>(18 | (repeat - 11) << 8));
+                    run -= repeat;
+                }
+                if (run >= 3)
+                {
+                    symbols.push_back(static_cast<uint16_t>(17 | (run - 3) << 8));
+                    run = 0;
+                }
+            }
+            else
+            {
+                symbols.push_back(static_cast<uint16_t>(value));
+                run--;
+                while (run >= 3)
+                {
+                    int repeat = std::min(run, 6);
+                    symbols.push_back(static_cast<uint16_t>(16 | (repeat - 3) << 8));
+                    run -= repeat;
+                }
+            }
+
+            for (; run > 0; run--)
+                symbols.push_back(static_cast<uint16_t>(value));
+        }
+        return symbols;
+    }
+
+    const int code_length_extra[CODE_LENGTH_CODES] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,2,3,7};
+
+    class Deflater
+    {
+    private:
+        // Compresses data[start, end), bytes before start only serve as dictionary
+        const unsigned char* data;
+        size_t start;
+        size_t end;
+        LevelConfig config;
+        BitWriter writer;
+
+        std::vector<int32_t> head;
+        std::vector<int32_t> prev;
+
+        std::vector<Symbol> symbols;
+        uint32_t literal_frequencies[LITERAL_CODES];
+        uint32_t distance_frequencies[DISTANCE_CODES];
+        size_t block_start;
+
+        uint32_t hash(size_t pos) const
+        {
+            uint32_t bytes = data[pos] | data[pos + 1] << 8 | data[pos + 2] << 16;
+            return (bytes * 2654435761u) >> (32 - HASH_BITS);
+        }
+
+        void insert(size_t pos)
+        {
+            if (pos + MIN_MATCH > end)
+                return;
+            uint32_t h = hash(pos);
+            prev[pos & WINDOW_MASK] = head[h];
+            head[h] = static_cast<int32_t>(pos);
+        }
+
+        // Longest match at pos longer than at_least, 0 if there is none
+        int find_match(size_t pos, int at_least, int& distance) const
+        {
+            int max_length = static_cast<int>(std::min<size_t>(MAX_MATCH, end - pos));
+            int best = std::max(at_least, MIN_MATCH - 1);
+            if (best >= max_length)
+                return 0;
+
+            int chain = config.max_chain;
+            if (at_least >= config.good_length)
+                chain >>= 2;
+            int nice = std::min(config.nice_length, max_length);
+            int64_t limit = static_cast<int64_t>(pos) - WINDOW_SIZE;
+
+            const unsigned char* current = data + pos;
+            int32_t candidate = head[hash(pos)];
+            int found = 0;
+            while (candidate >= 0 && candidate > limit && chain-- > 0)
+            {
+                const unsigned char* match = data + candidate;
+                if (match[best] == current[best] && match[0] == current[0] && match[1] == current[1])
+                {
+                    int matched = 2;
+                    while (matched < max_length && match[matched] == current[matched])
+                        matched++;
+
+                    if (matched > best)
+                    {
+                        best = matched;
+                        found = matched;
+                        distance = static_cast<int>(pos - candidate);
+                        if (matched >= nice)
+                            break;
+                    }
+                }
+
+                int32_t next = prev[candidate & WINDOW_MASK];
+                if (next >= candidate)
+                    break;
+                candidate = next;
+            }
+            return found;
+        }
+
+        void add_literal(unsigned char byte)
+        {
+            symbols.push_back(Symbol{byte, 0});
+            literal_frequencies[byte]++;
+        }
+
+        void add_match(int match_length, int distance)
+        {
+            const CodeTables& tables = code_tables();
+            symbols.push_back(Symbol{static_cast<uint16_t>(match_length), static_cast<uint16_t>(distance)});
+            literal_frequencies[257 + tables.length_code[match_length]]++;
+            distance_frequencies[tables.distance_code[distance]]++;
+        }
+
+        // Emits bytes [block_start, block_end) from the collected symbols
+        void flush_block(size_t block_end, bool last)
+        {
+            literal_frequencies[END_OF_BLOCK]++;
+
+            uint8_t literal_lengths[LITERAL_CODES];
+            uint8_t distance_lengths[DISTANCE_CODES];
+            build_code_lengths(literal_frequencies, LITERAL_CODES, MAX_BITS, literal_lengths);
+            build_code_lengths(distance_frequencies, DISTANCE_CODES, MAX_BITS, distance_lengths);
+
+            int literal_count = LITERAL_CODES;
+            while (literal_count > 257 && literal_lengths[literal_count - 1] == 0)
+                literal_count--;
+            int distance_count = DISTANCE_CODES;
+            while (distance_count > 1 && distance_lengths[distance_count - 1] == 0)
+                distance_count--;
+
+            // Runs may cross from one table into the next, but like zlib they are kept apart:
+            // zlib_decompress reads such runs, full_inflate, the old decoder still used as a
+            // fallback, reads the two tables separately
+            std::vector<uint16_t> header = run_length_code(literal_lengths, literal_count);
+            std::vector<uint16_t> distance_header = run_length_code(distance_lengths, distance_count);
+            header.insert(header.end(), distance_header.begin(), distance_header.end());
+
+            uint32_t code_length_frequencies[CODE_LENGTH_CODES] = {0};
+            for (uint16_t entry : header)
+                code_length_frequencies[entry & 0xFF]++;
+            uint8_t code_length_lengths[CODE_LENGTH_CODES];
+            build_code_lengths(code_length_frequencies, CODE_LENGTH_CODES, MAX_CODE_LENGTH_BITS, code_length_lengths);
+            int code_length_count = CODE_LENGTH_CODES;
+            while (code_length_count > 4 && code_length_lengths[code_length_order[code_length_count - 1]] == 0)
+                code_length_count--;
+
+            // Sizes in bits of the three ways to write the block
+            uint64_t extra_bits = 0;
+            for (int code = 0; code < 29; code++)
+                extra_bits += static_cast<uint64_t>(literal_frequencies[257 + code]) * length_extra[code];
+            for (int code = 0; code < DISTANCE_CODES; code++)
+                extra_bits += static_cast<uint64_t>(distance_frequencies[code]) * distance_extra[code];
+
+            uint64_t dynamic_bits = 3 + 5 + 5 + 4 + 3 * code_length_count + extra_bits;
+            for (uint16_t entry : header)
+                dynamic_bits += code_length_lengths[entry & 0xFF] + code_length_extra[entry & 0xFF];
+            uint64_t fixed_bits = 3 + extra_bits;
+            for (int i = 0; i < LITERAL_CODES; i++)
+            {
+                dynamic_bits += static_cast<uint64_t>(literal_frequencies[i]) * literal_lengths[i];
+                fixed_bits += static_cast<uint64_t>(literal_frequencies[i]) * (i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8);
+            }
+            for (int i = 0; i < DISTANCE_CODES; i++)
+            {
+                dynamic_bits += static_cast<uint64_t>(distance_frequencies[i]) * distance_lengths[i];
+                fixed_bits += static_cast<uint64_t>(distance_frequencies[i]) * 5;
+            }
+            size_t stored_size = block_end - block_start;
+            uint64_t stored_bits = (stored_size / MAX_STORED + 1) * 40 + 8 * static_cast<uint64_t>(stored_size);
+
+            if (stored_bits <= fixed_bits && stored_bits <= dynamic_bits)
+            {
+                write_stored(data + block_start, stored_size, last);
+            }
+            else if (fixed_bits <= dynamic_bits)
+            {
+                Code literal_codes[288];
+                Code distance_codes[DISTANCE_CODES];
+                uint8_t fixed_literal[288];
+                uint8_t fixed_distance[DISTANCE_CODES];
+                for (int i = 0; i < 288; i++)
+                    fixed_literal[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+                std::fill(fixed_distance, fixed_distance + DISTANCE_CODES, 5);
+                build_codes(fixed_literal, 288, literal_codes);
+                build_codes(fixed_distance, DISTANCE_CODES, distance_codes);
+
+                writer.put(last ? 1 : 0, 1);
+                writer.put(1, 2);
+                write_symbols(literal_codes, distance_codes);
+            }
+            else
+            {
+                Code literal_codes[LITERAL_CODES];
+                Code distance_codes[DISTANCE_CODES];
+                Code code_length_codes[CODE_LENGTH_CODES];
+                build_codes(literal_lengths, LITERAL_CODES, literal_codes);
+                build_codes(distance_lengths, DISTANCE_CODES, distance_codes);
+                build_codes(code_length_lengths, CODE_LENGTH_CODES, code_length_codes);
+
+                writer.put(last ? 1 : 0, 1);
+                writer.put(2, 2);
+                writer.put(literal_count - 257, 5);
+                writer.put(distance_count - 1, 5);
+                writer.put(code_length_count - 4, 4);
+                for (int i = 0; i < code_length_count; i++)
+                    writer.put(code_length_lengths[code_length_order[i]], 3);
+                for (uint16_t entry : header)
+                {
+                    int symbol = entry & 0xFF;
+                    writer.put(code_length_codes[symbol]);
+                    if (code_length_extra[symbol])
+                        writer.put(entry >> 8, code_length_extra[symbol]);
+                }
+                write_symbols(literal_codes, distance_codes);
+            }
+
+            symbols.clear();
+            std::fill(literal_frequencies, literal_frequencies + LITERAL_CODES, 0);
+            std::fill(distance_frequencies, distance_frequencies + DISTANCE_CODES, 0);
+            block_start = block_end;
+        }
+
+        void write_symbols(const Code* literal_codes, const Code* distance_codes)
+        {
+            const CodeTables& tables = code_tables();
+            for (const Symbol& symbol : symbols)
+            {
+                if (symbol.distance == 0)
+                {
+                    writer.put(literal_codes[symbol.value]);
+                    continue;
+                }
+
+                int length_code = tables.length_code[symbol.value];
+                writer.put(literal_codes[257 + length_code]);
+                if (length_extra[length_code])
+                    writer.put(symbol.value - length_base[length_code], length_extra[length_code]);
+
+                int distance_code = tables.distance_code[symbol.distance];
+                writer.put(distance_codes[distance_code]);
+                if (distance_extra[distance_code])
+                    writer.put(symbol.distance - distance_base[distance_code], distance_extra[distance_code]);
+            }
+            writer.put(literal_codes[END_OF_BLOCK]);
+        }
+
+        void write_stored(const unsigned char* bytes, size_t size, bool last)
+        {
+            do
+            {
+                size_t chunk = std::min(size, MAX_STORED);
+                size -= chunk;
+                writer.put(last && size == 0 ? 1 : 0, 1);
+                writer.put(0, 2);
+                writer.align_to_byte();
+                writer.put(static_cast<uint32_t>(chunk), 16);
+                writer.put(static_cast<uint32_t>(~chunk & 0xFFFF), 16);
+                writer.put_bytes(bytes, chunk);
+                bytes += chunk;
+            }
+            while (size > 0);
+        }
+
+        void maybe_flush(size_t pos)
+        {
+            if (symbols.size() >= BLOCK_SYMBOLS)
+                flush_block(pos, false);
+        }
+
+        // Greedy parsing, for the fast levels
+        void compress_fast()
+        {
+            size_t pos = start;
+            while (pos < end)
+            {
+                int distance = 0;
+                int match_length = find_match(pos, MIN_MATCH - 1, distance);
+                if (match_length == MIN_MATCH && distance > TOO_FAR)
+                    match_length = 0;
+                insert(pos);
+
+                if (match_length >= MIN_MATCH)
+                {
+                    add_match(match_length, distance);
+                    // Long matches are skipped over without hashing, as zlib does
+                    if (match_length <= config.max_lazy)
+                        for (int i = 1; i < match_length; i++)
+                            insert(pos + i);
+                    pos += match_length;
+                }
+                else
+                {
+                    add_literal(data[pos]);
+                    pos++;
+                }
+                maybe_flush(pos);
+            }
+        }
+
+        // Lazy parsing: a match is only taken if the next byte does not start a longer one
+        void compress_lazy()
+        {
+            size_t pos = start;
+            int previous_length = 0;
+            int previous_distance = 0;
+            bool literal_pending = false;
+
+            while (pos < end)
+            {
+                int distance = 0;
+                int match_length = 0;
+                if (previous_length < config.max_lazy)
+                {
+                    match_length = find_match(pos, previous_length, distance);
+                    if (match_length == MIN_MATCH && distance > TOO_FAR)
+                        match_length = 0;
+                }
+                insert(pos);
+
+                if (previous_length >= MIN_MATCH && match_length <= previous_length)
+                {
+                    // The match started at the byte before
+                    add_match(previous_length, previous_distance);
+                    size_t match_end = pos - 1 + previous_length;
+                    for (size_t i = pos + 1; i < match_end; i++)
+                        insert(i);
+                    pos = match_end;
+                    previous_length = 0;
+                    literal_pending = false;
+                    maybe_flush(pos);
+                    continue;
+                }
+
+                if (literal_pending)
+                {
+                    add_literal(data[pos - 1]);
+                    maybe_flush(pos);
+                }
+                literal_pending = true;
+                previous_length = match_length;
+                previous_distance = distance;
+                pos++;
+            }
+
+            if (literal_pending)
+                add_literal(data[pos - 1]);
+        }
+
+    public:
+        Deflater(const unsigned char* data, size_t start, size_t end, int level, std::vector<unsigned char>& output)
+        : data(data), start(start), end(end), config(level_configs[level]), writer(output), block_start(start)
+        {
+            std::fill(literal_frequencies, literal_frequencies + LITERAL_CODES, 0);
+            std::fill(distance_frequencies, distance_frequencies + DISTANCE_CODES, 0);
+        }
+
+        // Not last ends on a sync flush, an empty stored block, so the next segment starts on a byte
+        void compress(bool last)
+        {
+            if (config.max_chain == 0)
+            {
+                write_stored(data + start, end - start, last);
+            }
+            else
+            {
+                head.assign(HASH_SIZE, -1);
+                prev.assign(WINDOW_SIZE, -1);
+                symbols.reserve(BLOCK_SYMBOLS + 1);
+
+                for (size_t pos = start > WINDOW_SIZE ? start - WINDOW_SIZE : 0; pos < start; pos++)
+                    insert(pos);
+
+                if (config.lazy)
+                    compress_lazy();
+                else
+                    compress_fast();
+                flush_block(end, last);
+            }
+
+            if (!last)
+                write_stored(nullptr, 0, false);
+            writer.align_to_byte();
+        }
+    };
+}
+
+namespace
+{
+    // Decoding table entry: value << 16 | kind << 13 | extra bits << 8 | code bits. A subtable
+    // entry holds the subtable's offset as value and its index bits as extra bits.
+    const uint32_t ENTRY_LITERAL = 0;
+    const uint32_t ENTRY_BASE = 1;
+    const uint32_t ENTRY_END = 2;
+    const uint32_t ENTRY_SUBTABLE = 3;
+    const uint32_t ENTRY_INVALID = 4;
+
+    const int LITERAL_TABLE_BITS = 10;
+    const int DISTANCE_TABLE_BITS = 8;
+    const int CODE_LENGTH_TABLE_BITS = 7;
+
+    uint32_t make_entry(uint32_t value, uint32_t kind, uint32_t extra, uint32_t bits)
+    {
+        return value << 16 | kind << 13 | extra << 8 | bits;
+    }
+
+    uint32_t entry_value(uint32_t entry) { return entry >> 16; }
+    uint32_t entry_kind(uint32_t entry) { return (entry >> 13) & 7; }
+    uint32_t entry_extra(uint32_t entry) { return (entry >> 8) & 0x1F; }
+    uint32_t entry_bits(uint32_t entry) { return entry & 0xFF; }
+
+    // What each symbol decodes to, before its code length is added
+    uint32_t literal_template(int symbol)
+    {
+        if (symbol < 256) return make_entry(symbol, ENTRY_LITERAL, 0, 0);
+        if (symbol == END_OF_BLOCK) return make_entry(0, ENTRY_END, 0, 0);
+        if (symbol < 286) return make_entry(length_base[symbol - 257], ENTRY_BASE, length_extra[symbol - 257], 0);
+        return make_entry(0, ENTRY_INVALID, 0, 0);
+    }
+
+    uint32_t distance_template(int symbol)
+    {
+        if (symbol < DISTANCE_CODES) return make_entry(distance_base[symbol], ENTRY_BASE, distance_extra[symbol], 0);
+        return make_entry(0, ENTRY_INVALID, 0, 0);
+    }
+
+    uint32_t code_length_template(int symbol)
+    {
+        return make_entry(symbol, ENTRY_LITERAL, 0, 0);
+    }
+
+    uint32_t reverse_bits(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int bit = 0; bit < length; bit++)
+            reversed |= ((code >> bit) & 1) << (length - 1 - bit);
+        return reversed;
+    }
+
+    // Lookup table over the next table_bits input bits for canonical codes with these lengths.
+    // Longer codes continue in a subtable sized for the longest code sharing its first bits.
+    // False for an over-subscribed code, unused slots of an incomplete one decode as invalid.
+    bool build_decode_table(const uint8_t* lengths, int count, int table_bits,
+                            uint32_t (*symbol_template)(int), std::vector<uint32_t>& table)
+    {
+        int length_counts[MAX_BITS + 1] = {0};
+        for (int i = 0; i < count; i++)
+            length_counts[lengths[i]]++;
+        length_counts[0] = 0;
+
+        int left = 1;
+        for (int bits = 1; bits <= MAX_BITS; bits++)
+        {
+            left = (left << 1) - length_counts[bits];
+            if (left < 0)
+                return false;
+        }
+
+        uint32_t first_code[MAX_BITS + 1] = {0};
+        uint32_t code = 0;
+        for (int bits = 1; bits <= MAX_BITS; bits++)
+        {
+            code = (code + length_counts[bits - 1]) << 1;
+            first_code[bits] = code;
+        }
+
+        uint32_t mask = (1u << table_bits) - 1;
+        table.assign(size_t(1) << table_bits, make_entry(0, ENTRY_INVALID, 0, 0));
+
+        // Subtable sizes first, from the longest code behind each primary slot
+        uint8_t subtable_bits[1 << LITERAL_TABLE_BITS] = {0};
+        uint32_t next_code[MAX_BITS + 1];
+        std::copy(first_code, first_code + MAX_BITS + 1, next_code);
+        for (int symbol = 0; symbol < count; symbol++)
+        {
+            int length = lengths[symbol];
+            if (length <= table_bits)
+                continue;
+            uint32_t reversed = reverse_bits(next_code[length]++, length);
+            uint8_t& bits = subtable_bits[reversed & mask];
+            bits = std::max<uint8_t>(bits, static_cast<uint8_t>(length - table_bits));
+        }
+        for (uint32_t slot = 0; slot <= mask; slot++)
+        {
+            if (subtable_bits[slot] == 0)
+                continue;
+            table[slot] = make_entry(static_cast<uint32_t>(table.size()), ENTRY_SUBTABLE, subtable_bits[slot], table_bits);
+            table.resize(table.size() + (size_t(1) << subtable_bits[slot]), make_entry(0, ENTRY_INVALID, 0, 0));
+        }
+
+        std::copy(first_code, first_code + MAX_BITS + 1, next_code);
+        for (int symbol = 0; symbol < count; symbol++)
+        {
+            int length = lengths[symbol];
+            if (length == 0)
+                continue;
+            uint32_t reversed = reverse_bits(next_code[length]++, length);
+
+            if (length <= table_bits)
+            {
+                uint32_t entry = symbol_template(symbol) | length;
+                for (uint32_t slot = reversed; slot <= mask; slot += 1u << length)
+                    table[slot] = entry;
+            }
+            else
+            {
+                uint32_t subtable = table[reversed & mask];
+                uint32_t rest_bits = length - table_bits;
+                uint32_t entry = symbol_template(symbol) | rest_bits;
+                for (uint32_t slot = reversed >> table_bits; slot < (1u << entry_extra(subtable)); slot += 1u << rest_bits)
+                    table[entry_value(subtable) + slot] = entry;
+            }
+        }
+        return true;
+    }
+
+    struct FixedTables
+    {
+        std::vector<uint32_t> literals;
+        std::vector<uint32_t> distances;
+
+        FixedTables()
+        {
+            uint8_t literal_lengths[288];
+            for (int i = 0; i < 288; i++)
+                literal_lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+            uint8_t distance_lengths[32];
+            std::fill(distance_lengths, distance_lengths + 32, 5);
+
+            build_decode_table(literal_lengths, 288, LITERAL_TABLE_BITS, literal_template, literals);
+            build_decode_table(distance_lengths, 32, DISTANCE_TABLE_BITS, distance_template, distances);
+        }
+    };
+
+    const FixedTables& fixed_tables()
+    {
+        static const FixedTables tables;
+        return tables;
+    }
+
+    class Inflater
+    {
+    private:
+        const unsigned char* in;
+        const unsigned char* in_end;
+        // Bits above count may already hold the next input bits, a refill ORs the same bits in again
+        uint64_t buffer;
+        int count;
+        // Zero bytes made up past the end of input
+        size_t overrun;
+
+        std::vector<unsigned char>& out;
+        size_t out_pos;
+
+        std::vector<uint32_t> literal_table;
+        std::vector<uint32_t> distance_table;
+
+        // Tops the buffer up to at least 56 bits, eight bytes at a time away from the end of input
+        bool refill()
+        {
+            if (in_end - in >= 8)
+            {
+                uint64_t word = 0;
+                for (int i = 7; i >= 0; i--)
+                    word = word << 8 | in[i];
+                buffer |= word << count;
+                in += (63 - count) >> 3;
+                count |= 56;
+                return true;
+            }
+
+            while (count <= 56)
+            {
+                if (in < in_end)
+                    buffer |= static_cast<uint64_t>(*in++) << count;
+                else
+                    overrun++;
+                count += 8;
+            }
+            // A valid stream never reads more than the checksum's worth past its last block
+            return overrun <= 8;
+        }
+
+        uint32_t take(int bits)
+        {
+            uint32_t value = static_cast<uint32_t>(buffer & ((uint64_t(1) << bits) - 1));
+            buffer >>= bits;
+            count -= bits;
+            return value;
+        }
+
+        uint32_t decode(const std::vector<uint32_t>& table, int table_bits)
+        {
+            uint32_t entry = table[buffer & ((1u << table_bits) - 1)];
+            if (entry_kind(entry) == ENTRY_SUBTABLE)
+            {
+                take(table_bits);
+                entry = table[entry_value(entry) + (buffer & ((1u << entry_extra(entry)) - 1))];
+            }
+            take(entry_bits(entry));
+            return entry;
+        }
+
+        // Room for n more bytes, plus the slack the word sized copies may overwrite
+        void reserve(size_t n)
+        {
+            if (out_pos + n + 8 > out.size())
+                out.resize(std::max(out.size() * 2, out_pos + n + 8 + 4096));
+        }
+
+        // Puts the whole bytes still buffered back into the input
+        bool align_to_byte()
+        {
+            take(count & 7);
+            size_t unread = count >> 3;
+            if (unread < overrun)
+                return false;
+            in -= unread - overrun;
+            overrun = 0;
+            buffer = 0;
+            count = 0;
+            return true;
+        }
+
+        bool stored_block()
+        {
+            if (!align_to_byte() || in_end - in < 4)
+                return false;
+            uint32_t length = in[0] | in[1] << 8;
+            uint32_t check = in[2] | in[3] << 8;
+            in += 4;
+            if (length != (~check & 0xFFFF) || static_cast<size_t>(in_end - in) < length)
+                return false;
+
+            reserve(length);
+            std::memcpy(&out[out_pos], in, length);
+            out_pos += length;
+            in += length;
+            return true;
+        }
+
+        bool dynamic_tables()
+        {
+            if (!refill())
+                return false;
+            int literal_count = take(5) + 257;
+            int distance_count = take(5) + 1;
+            int code_length_count = take(4) + 4;
+            if (literal_count > LITERAL_CODES || distance_count > DISTANCE_CODES)
+                return false;
+
+            uint8_t code_length_lengths[CODE_LENGTH_CODES] = {0};
+            for (int i = 0; i < code_length_count; i++)
+            {
+                if (!refill())
+                    return false;
+                code_length_lengths[code_length_order[i]] = static_cast<uint8_t>(take(3));
+            }
+
+            std::vector<uint32_t> code_length_table;
+            if (!build_decode_table(code_length_lengths, CODE_LENGTH_CODES, CODE_LENGTH_TABLE_BITS, code_length_template, code_length_table))
+                return false;
+
+            // Repeats may run on from the literal lengths into the distance lengths
+            uint8_t lengths[LITERAL_CODES + DISTANCE_CODES];
+            int total = literal_count + distance_count;
+            int filled = 0;
+            while (filled < total)
+            {
+                if (!refill())
+                    return false;
+                uint32_t entry = decode(code_length_table, CODE_LENGTH_TABLE_BITS);
+                if (entry_kind(entry) != ENTRY_LITERAL)
+                    return false;
+
+                uint32_t symbol = entry_value(entry);
+                if (symbol < 16)
+                {
+                    lengths[filled++] = static_cast<uint8_t>(symbol);
+                    continue;
+                }
+
+                uint8_t value = 0;
+                int repeat;
+                if (symbol == 16)
+                {
+                    if (filled == 0)
+                        return false;
+                    value = lengths[filled - 1];
+                    repeat = 3 + take(2);
+                }
+                else if (symbol == 17)
+                {
+                    repeat = 3 + take(3);
+                }
+                else
+                {
+                    repeat = 11 + take(7);
+                }
+
+                if (filled + repeat > total)
+                    return false;
+                std::fill(lengths + filled, lengths + filled + repeat, value);
+                filled += repeat;
+            }
+
+            if (lengths[END_OF_BLOCK] == 0)
+                return false;
+            return build_decode_table(lengths, literal_count, LITERAL_TABLE_BITS, literal_template, literal_table)
+                && build_decode_table(lengths + literal_count, distance_count, DISTANCE_TABLE_BITS, distance_template, distance_table);
+        }
+
+        bool huffman_block(const std::vector<uint32_t>& literals, const std::vector<uint32_t>& distances)
+        {
+            for (;;)
+            {
+                // 56 bits cover the longest length code, distance code and their extra bits
+                if (!refill())
+                    return false;
+
+                uint32_t entry = decode(literals, LITERAL_TABLE_BITS);
+                uint32_t kind = entry_kind(entry);
+                if (kind == ENTRY_LITERAL)
+                {
+                    reserve(1);
+                    out[out_pos++] = static_cast<unsigned char>(entry_value(entry));
+                    continue;
+                }
+                if (kind == ENTRY_END)
+                    return true;
+                if (kind != ENTRY_BASE)
+                    return false;
+
+                size_t length = entry_value(entry) + take(entry_extra(entry));
+                entry = decode(distances, DISTANCE_TABLE_BITS);
+                if (entry_kind(entry) != ENTRY_BASE)
+                    return false;
+                size_t distance = entry_value(entry) + take(entry_extra(entry));
+                if (distance > out_pos)
+                    return false;
+
+                reserve(length);
+                unsigned char* dst = &out[out_pos];
+                const unsigned char* src = dst - distance;
+                out_pos += length;
+
+                if (distance >= 8)
+                {
+                    // Whole words, each read lies behind everything written so far
+                    for (size_t i = 0; i < length; i += 8)
+                        std::memcpy(dst + i, src + i, 8);
+                }
+                else if (distance == 1)
+                {
+                    std::memset(dst, *src, length);
+                }
+                else
+                {
+                    for (size_t i = 0; i < length; i++)
+                        dst[i] = src[i];
+                }
+            }
+        }
+
+    public:
+        Inflater(const unsigned char* data, size_t length, std::vector<unsigned char>& output)
+        : in(data), in_end(data + length), buffer(0), count(0), overrun(0), out(output), out_pos(0) {}
+
+        // Decodes blocks up to the final one, in is left at the first byte after the stream
+        bool inflate()
+        {
+            bool last = false;
+            while (!last)
+            {
+                if (!refill())
+                    return false;
+                last = take(1) != 0;
+                uint32_t type = take(2);
+
+                bool ok;
+                if (type == 0)
+                {
+                    ok = stored_block();
+                }
+                else if (type == 1)
+                {
+                    ok = huffman_block(fixed_tables().literals, fixed_tables().distances);
+                }
+                else if (type == 2)
+                {
+                    ok = dynamic_tables() && huffman_block(literal_table, distance_table);
+                }
+                else
+                {
+                    ok = false;
+                }
+                if (!ok)
+                    return false;
+            }
+
+            out.resize(out_pos);
+            return align_to_byte();
+        }
+
+        const unsigned char* position() const
+        {
+            return in;
+        }
+    };
+}
+
+std::vector<unsigned char> zlib_compress(const unsigned char* data, size_t length, int level)
+{
+    level = std::clamp(level, 0, 9);
+
+    std::vector<unsigned char> output;
+    output.reserve(level == 0 ? length + length / MAX_STORED * 5 + 16 : length / 2 + 64);
+
+    zlib_header(level, output);
+
+    Deflater deflater(data, 0, length, level, output);
+    deflater.compress(true);
+
+    zlib_trailer(adler32(data, length), output);
+    return output;
+}
+
+void zlib_header(int level, std::vector<unsigned char>& output)
+{
+    // CMF: deflate with a 32K window. FLG: the level hint, plus check bits making the pair a multiple of 31
+    unsigned char cmf = 0x78;
+    unsigned char flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    unsigned char flg = static_cast<unsigned char>(flevel << 6);
+    flg += (31 - (cmf * 256 + flg) % 31) % 31;
+    output.push_back(cmf);
+    output.push_back(flg);
+}
+
+void zlib_trailer(uint32_t adler, std::vector<unsigned char>& output)
+{
+    output.push_back((adler >> 24) & 0xFF);
+    output.push_back((adler >> 16) & 0xFF);
+    output.push_back((adler >> 8) & 0xFF);
+    output.push_back(adler & 0xFF);
+}
+
+bool zlib_decompress(const unsigned char* data, size_t length, std::vector<unsigned char>& output, size_t size_hint)
+{
+    output.clear();
+    if (length < 6)
+        return false;
+
+    // Deflate with at most a 32K window, valid check bits and no preset dictionary
+    unsigned char cmf = data[0];
+    unsigned char flg = data[1];
+    if ((cmf & 0x0F) != 8 || (cmf >> 4) > 7 || (cmf * 256 + flg) % 31 != 0 || (flg & 0x20))
+        return false;
+
+    output.resize(size_hint + 8);
+    Inflater inflater(data + 2, length - 2, output);
+    if (!inflater.inflate())
+    {
+        output.clear();
+        return false;
+    }
+
+    const unsigned char* trailer = inflater.position();
+    if (data + length - trailer < 4)
+        return false;
+    uint32_t expected = static_cast<uint32_t>(trailer[0]) << 24 | trailer[1] << 16 | trailer[2] << 8 | trailer[3];
+    return adler32(output.data(), output.size()) == expected;
+}
+
+void deflate_segment(const unsigned char* data, size_t start, size_t end, int level, bool last, std::vector<unsigned char>& output)
+{
+    Deflater deflater(data, start, end, std::clamp(level, 0, 9), output);
+    deflater.compress(last);
+}
+
+}
\ No newline at end of file
@@ -9,73 +9,140 @@
 
 namespace rcl
 {
-Picture::Picture() : data(nullptr), width(0), height(0) {}
+PictureView::PictureView(rcl::vec3* data, int width, int height, int stride)
+    : data(data), width(width), height(height), stride(stride) {}
 
-Picture::Picture(rcl::Camera cam) : data(nullptr), width(cam.GetImageWidth()), height(cam.GetImageHeight())
+PictureView PictureView::View(int x, int y, int w, int h) const
 {
-    data = new rcl::vec3[width * height];
+    int left = std::max(0, std::min(x, width));
+    int top = std::max(0, std::min(y, height));
+    int right = std::max(left, std::min(x + w, width));
+    int bottom = std::max(top, std::min(y + h, height));
+    if (right == left || bottom == top)
+        return PictureView();
+
+    return PictureView(data + static_cast<size_t>(top) * stride + left, right - left, bottom - top, stride);
+}
+
+rcl::vec3* PictureView::Row(int h) const
+{
+    return data + static_cast<size_t>(h) * stride;
+}
+
+rcl::vec3 PictureView::GetPixel(int h, int w) const
+{
+    if (h < 0 || h >= height || w < 0 || w >= width) return rcl::vec3(0.0f);
+    return Row(h)[w];
+}
+
+void PictureView::WritePixel(int h, int w, const rcl::vec3& d) const
+{
+    if (h < 0 || h >= height || w < 0 || w >= width) return;
+    Row(h)[w] = d;
 }
 
-Picture::Picture(int width, int height) : data(nullptr), width(width), height(height)
+int PictureView::GetWidth() const
+{
+    return width;
+}
+int PictureView::GetHeight() const
+{
+    return height;
+}
+int PictureView::GetStride() const
+{
+    return stride;
+}
+
+Picture::Picture() : data(nullptr), width(0), height(0), owner(true) {}
+
+Picture::Picture(const rcl::Camera& cam) : Picture(cam.GetImageWidth(), cam.GetImageHeight()) {}
+
+Picture::Picture(int width, int height) : data(nullptr), width(width), height(height), owner(true)
 {
     if(width < 0 || height < 0)
     {
         std::cout << "Wrong sizes height:" << height << " width:" << width << " shoud be more that 0" << std::endl;
         return;
     }
-    data = new rcl::vec3[width * height];
+    data = AllocatePixels(static_cast<size_t>(width) * height);
 }
 
-Picture::Picture(const char* path) : data(nullptr), width(0), height(0)
+Picture::Picture(const char* path) : data(nullptr), width(0), height(0), owner(true)
 {
     Import(path);
 }
 
-Picture::Picture(const Picture& other) : data(nullptr), width(other.width), height(other.height) 
+Picture::Picture(rcl::vec3* pixels, int width, int height) : data(pixels), width(width), height(height), owner(false) {}
+
+Picture::Picture(const PictureView& view) : Picture(view.GetWidth(), view.GetHeight())
+{
+    for (int h = 0; h < height; h++)
+    {
+        std::memcpy(data + static_cast<size_t>(h) * width, view.Row(h), width * sizeof(rcl::vec3));
+    }
+}
+
+Picture::Picture(const Picture& other) : data(nullptr), width(other.width), height(other.height), owner(true)
 {
     if (other.data) 
     {
-        data = new rcl::vec3[width * height];
-        std::memcpy(data, other.data, width * height * sizeof(rcl::vec3));
+        size_t count = static_cast<size_t>(width) * height;
+        data = AllocatePixels(count);
+        std::memcpy(data, other.data, count * sizeof(rcl::vec3));
     }
 }
 
+Picture::Picture(Picture&& other) noexcept : data(other.data), width(other.width), height(other.height), owner(other.owner)
+{
+    other.data = nullptr;
+    other.width = other.height = 0;
+    other.owner = true;
+}
+
 Picture& Picture::operator=(const Picture& other) 
 {
     if (this != &other) 
     {
-        delete[] data;
+        *this = Picture(other);
+    }
+    return *this;
+}
+
+Picture& Picture::operator=(Picture&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        data = other.data;
         width = other.width;
         height = other.height;
-        if (other.data) 
-        {
-            data = new rcl::vec3[width * height];
-            std::memcpy(data, other.data, width * height * sizeof(rcl::vec3));
-        } 
-        else 
-        {
-            data = nullptr;
-        }
+        owner = other.owner;
+
+        other.data = nullptr;
+        other.width = other.height = 0;
+        other.owner = true;
     }
     return *this;
 }
 
 Picture::~Picture()
 {
-    if (data)
-    {
-        delete[] data;
-        data = nullptr;
-    }
+    Release();
+}
+
+void Picture::Release()
+{
+    if (data && owner)
+        FreePixels(data, static_cast<size_t>(width) * height);
+    data = nullptr;
+    owner = true;
 }
 
 void Picture::Import(const char* path)
 {
-    if (data)
-    {
-        delete[] data;
-        data = nullptr;
-    }
+    Release();
+    width = height = 0;
     
     std::string ext = strrchr(path, '.');
     if (!ext.size())
@@ -93,13 +160,21 @@ void Picture::Import(const char* path)
     {
         ImportPPM(path, width, height, data);
     }
+    else if (strcmp(ext.c_str(), ".pfm") == 0)
+    {
+        ImportPFM(path, width, height, data);
+    }
+    else if (strcmp(ext.c_str(), ".hdr") == 0)
+    {
+        ImportHDR(path, width, height, data);
+    }
     else
     {
         std::cerr << "Error: Unsupported file format " << ext << std::endl;
     }
 }
 
-void Picture::Export(const char* path) const
+void Picture::Export(const char* path, int compressionLevel) const
 {
     if (!data)
     {
@@ -117,18 +192,55 @@ void Picture::Export(const char* path) const
     std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
     if (strcmp(ext.c_str(), ".png") == 0)
     {
-        ExportPNG(path, width, height, data);
+        ExportPNG(path, width, height, data, compressionLevel);
     }
     else if (strcmp(ext.c_str(), ".ppm") == 0)
     {
         ExportPPM(path, width, height, data);
     }
+    else if (strcmp(ext.c_str(), ".pfm") == 0)
+    {
+        ExportPFM(path, width, height, data);
+    }
+    else if (strcmp(ext.c_str(), ".hdr") == 0)
+    {
+        ExportHDR(path, width, height, data);
+    }
     else
     {
         std::cerr << "Error: Unsupported file format " << ext << std::endl;
     }
 }
 
+void Picture::Export(const char* path, const rcl::ResolveSettings& settings, int compressionLevel) const
+{
+    if (!data)
+    {
+        std::cerr << "Error: No image data to export" << std::endl;
+        return;
+    }
+
+    const char* dot = strrchr(path, '.');
+    std::string ext = dot ? dot : "";
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".png" || ext == ".ppm")
+    {
+        ImageStreamWriter writer;
+        if (!writer.Open(path, width, height, compressionLevel))
+            return;
+        writer.SetResolve(settings);
+        writer.WriteRows(data, height);
+        writer.Close();
+    }
+    else
+    {
+        // The float formats keep what the curves give
+        Picture resolved(*this);
+        resolved.Resolve(settings);
+        resolved.Export(path, compressionLevel);
+    }
+}
+
 rcl::vec3 Picture::GetPixel(const rcl::vec2& uv) const
 {
     if (!data || width == 0 || height == 0)
@@ -162,12 +274,40 @@ void Picture::WritePixel(const int h, const int w, const rcl::vec3& d)
 
 void Picture::GammaCorection()
 {
-    for(int i = 0; i < height * width; i++)
-    {
-        data[i].r = rcl::LinearToGamma(data[i].r);
-        data[i].g = rcl::LinearToGamma(data[i].g);
-        data[i].b = rcl::LinearToGamma(data[i].b);
-    }
+    rcl::ResolveSettings settings;
+    settings.transfer = rcl::TransferCurve::Gamma2;
+    Resolve(settings);
+}
+
+void Picture::Resolve(const rcl::ResolveSettings& settings)
+{
+    if (data)
+        rcl::Resolve(data, data, width, height, settings);
+}
+
+PictureView Picture::View()
+{
+    return PictureView(data, width, height, width);
+}
+
+PictureView Picture::View(int x, int y, int w, int h)
+{
+    return View().View(x, y, w, h);
+}
+
+rcl::vec3* Picture::GetData()
+{
+    return data;
+}
+
+const rcl::vec3* Picture::GetData() const
+{
+    return data;
+}
+
+bool Picture::OwnsData() const
+{
+    return owner;
 }
 
 int Picture::GetWidth() const
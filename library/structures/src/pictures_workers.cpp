@@ -4,15 +4,103 @@
 #include <fstream>
 #include <vector>
 #include <memory>
+#include <new>
 #include <cstring>
+#include <thread>
+#include <future>
+#include <algorithm>
+#include <string>
+#include <iterator>
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#define RCL_HAS_MMAP
+#endif
 
 #include "interval.hpp"
 #include "ppm_workers.hpp"
 #include "png_workers.hpp"
+#include "hdr_workers.hpp"
 
 namespace rcl
 {
 
+namespace
+{
+    // Uncompressed bytes per independently compressed band of a PNG
+    const size_t PNG_SEGMENT_BYTES = 256 * 1024;
+    // DEFLATE window, how much of the data already written the next rows can refer to
+    const size_t PNG_WINDOW_BYTES = 32 * 1024;
+
+    // Runs work(begin, end) on contiguous parts of [0, count), one per hardware thread
+    template<typename Work>
+    void ParallelRanges(size_t count, Work work)
+    {
+        unsigned int numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1; // fallback if detection fails
+        numThreads = static_cast<unsigned int>(std::min<size_t>(numThreads, std::max<size_t>(count, 1)));
+
+        size_t perThread = count / numThreads;
+        size_t remainder = count % numThreads;
+
+        std::vector<std::future<void>> futures;
+        size_t begin = 0;
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            size_t end = begin + perThread + (t < remainder ? 1 : 0);
+            futures.push_back(std::async(std::launch::async, work, begin, end));
+            begin = end;
+        }
+
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+    }
+}
+
+rcl::vec3* AllocatePixels(size_t count)
+{
+    size_t bytes = count * sizeof(rcl::vec3);
+    if (bytes == 0)
+        return nullptr;
+
+#ifdef RCL_HAS_MMAP
+    if (bytes >= PIXEL_MAP_BYTES)
+    {
+        void* address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED)
+            throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+        // Whole frames are swept row by row, large pages save most of the TLB misses
+        madvise(address, bytes, MADV_HUGEPAGE);
+#endif
+        return static_cast<rcl::vec3*>(address);
+    }
+#endif
+
+    void* address = ::operator new(bytes, std::align_val_t(PIXEL_ALIGNMENT));
+    std::memset(address, 0, bytes);
+    return static_cast<rcl::vec3*>(address);
+}
+
+void FreePixels(rcl::vec3* data, size_t count)
+{
+    if (!data)
+        return;
+
+    size_t bytes = count * sizeof(rcl::vec3);
+#ifdef RCL_HAS_MMAP
+    if (bytes >= PIXEL_MAP_BYTES)
+    {
+        munmap(data, bytes);
+        return;
+    }
+#endif
+    ::operator delete(data, std::align_val_t(PIXEL_ALIGNMENT));
+}
+
 void ImportPPM(const char* path, int& width, int& height, rcl::vec3*& data)
 {
     std::ifstream file(path, std::ios::binary);
@@ -28,9 +116,9 @@ void ImportPPM(const char* path, int& width, int& height, rcl::vec3*& data)
         std::string magicNumber;
          file >> magicNumber;
             
-        if (magicNumber != "P3") 
+        if (magicNumber != "P3" && magicNumber != "P6") 
         {
-            std::cerr << "Error: Unsupported PPM format. Only P3 are supported." << std::endl;
+            std::cerr << "Error: Unsupported PPM format. Only P3 and P6 are supported." << std::endl;
             return;
         }
             
@@ -58,36 +146,24 @@ void ImportPPM(const char* path, int& width, int& height, rcl::vec3*& data)
         }
 
         // Resize pixel array
-        data = new vec3[width * height];
+        data = AllocatePixels(static_cast<size_t>(width) * height);
             
-        // Read pixel data based on format
-        readP3Format(file, data, width * height, maxVal);
+        // Read pixel data based on format, a single whitespace separates binary data from the header
+        if (magicNumber == "P6")
+        {
+            file.get();
+            readP6Format(file, data, width * height, maxVal);
+        }
+        else
+        {
+            readP3Format(file, data, width * height, maxVal);
+        }
     } 
     catch (const std::exception& e) 
     {
         std::cerr << "Error reading PPM file: " << e.what() << std::endl;
     }
 }
-void ExportPPM(const char* path, int width, int height, const rcl::vec3* const & data)
-{
-    std::fstream stream(path, std::fstream::out);
-    stream << "P3\n" << width << ' ' << height << "\n255\n";
-    
-    int imageSize = width * height;
-
-    for (int i = 0; i < imageSize; i++) 
-    {
-        static const rcl::Interval<double> intensity(0.000, 0.999);
-        rcl::ivec3 finalColor;
-        finalColor.r = int(256 * intensity.Clamp(data[i].r));
-        finalColor.g = int(256 * intensity.Clamp(data[i].g));
-        finalColor.b = int(256 * intensity.Clamp(data[i].b));
-        stream << finalColor << '\n';
-    }
-            
-    stream.close();
-}
-
 void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
 {
     std::ifstream file(path, std::ios::binary);
@@ -181,9 +257,9 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
         }
         else if (strcmp(chunk_type, "IDAT") == 0)
         {
-            std::vector<unsigned char> chunk_data(chunk_length);
-            file.read(reinterpret_cast<char*>(chunk_data.data()), chunk_length);
-            compressed_data.insert(compressed_data.end(), chunk_data.begin(), chunk_data.end());
+            size_t offset = compressed_data.size();
+            compressed_data.resize(offset + chunk_length);
+            file.read(reinterpret_cast<char*>(compressed_data.data() + offset), chunk_length);
         }
         else if (strcmp(chunk_type, "IEND") == 0)
         {
@@ -206,9 +282,12 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
         return;
     }
 
-    // Decompress image data
+    // Decompress image data. The slower decoder still reads streams with a bad checksum,
+    // as older versions of ExportPNG wrote them.
+    size_t expected_size = height * (width * bytes_per_pixel + 1);
     std::vector<unsigned char> uncompressed_data;
-    if (!full_inflate(compressed_data, uncompressed_data))
+    if (!zlib_decompress(compressed_data.data(), compressed_data.size(), uncompressed_data, expected_size) &&
+        !full_inflate(compressed_data, uncompressed_data))
     {
         // Fallback to simple inflate for uncompressed blocks
         if (!simple_inflate(compressed_data, uncompressed_data))
@@ -219,7 +298,6 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
     }
 
     // Verify we have enough data
-    size_t expected_size = height * (width * bytes_per_pixel + 1);
     if (uncompressed_data.size() < expected_size)
     {
         std::cerr << "Error: Insufficient PNG data after decompression. Expected: " 
@@ -228,7 +306,7 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
     }
 
     // Allocate output data
-    data = new rcl::vec3[width * height];
+    data = AllocatePixels(static_cast<size_t>(width) * height);
 
     // Unfilter and convert to vec3
     std::vector<unsigned char> current_row(width * bytes_per_pixel);
@@ -239,7 +317,7 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
         int row_start = y * (width * bytes_per_pixel + 1);
         if (row_start >= static_cast<int>(uncompressed_data.size())) {
             std::cerr << "Error: Row start beyond data bounds" << std::endl;
-            delete[] data;
+            FreePixels(data, static_cast<size_t>(width) * height);
             data = nullptr;
             return;
         }
@@ -249,7 +327,7 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
         // Copy current row data
         if (row_start + 1 + width * bytes_per_pixel > static_cast<int>(uncompressed_data.size())) {
             std::cerr << "Error: Row data beyond bounds" << std::endl;
-            delete[] data;
+            FreePixels(data, static_cast<size_t>(width) * height);
             data = nullptr;
             return;
         }
@@ -283,15 +361,276 @@ void ImportPNG(const char* path, int& width, int& height, rcl::vec3*& data)
     }
 }
 
-void ExportPNG(const char* path, int width, int height, const rcl::vec3* const & data)
+void ExportPNG(const char* path, int width, int height, const rcl::vec3* const & data, int compressionLevel)
+{
+    ImageStreamWriter writer;
+    if (writer.Open(path, width, height, ImageStreamWriter::Format::PNG, compressionLevel))
+    {
+        writer.WriteRows(data, height);
+        writer.Close();
+    }
+}
+
+void ExportPPM(const char* path, int width, int height, const rcl::vec3* const & data, int bitDepth)
+{
+    ImageStreamWriter writer;
+    ImageStreamWriter::Format format = bitDepth > 8 ? ImageStreamWriter::Format::PPM16 : ImageStreamWriter::Format::PPM;
+    if (writer.Open(path, width, height, format))
+    {
+        writer.WriteRows(data, height);
+        writer.Close();
+    }
+}
+
+void ImportPFM(const char* path, int& width, int& height, rcl::vec3*& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Cannot open file " << path << std::endl;
+        return;
+    }
+
+    // "PF" for RGB, "Pf" for one channel, then the size and a scale whose sign gives the byte order
+    std::string magicNumber;
+    double scale = 0;
+    file >> magicNumber >> width >> height >> scale;
+    file.get();
+    if (!file || (magicNumber != "PF" && magicNumber != "Pf") || scale == 0)
+    {
+        std::cerr << "Error: Not a valid PFM file " << path << std::endl;
+        return;
+    }
+    if (width <= 0 || height <= 0)
+    {
+        std::cerr << "Error: Invalid image dimensions" << std::endl;
+        return;
+    }
+
+    int channels = magicNumber == "PF" ? 3 : 1;
+    size_t count = static_cast<size_t>(width) * height;
+    data = AllocatePixels(count);
+
+    // The body in one read, straight into the pixels for RGB
+    std::vector<float> gray(channels == 1 ? count : 0);
+    unsigned char* body = channels == 3 ? reinterpret_cast<unsigned char*>(data) : reinterpret_cast<unsigned char*>(gray.data());
+    file.read(reinterpret_cast<char*>(body), count * channels * sizeof(float));
+    if (file.gcount() != static_cast<std::streamsize>(count * channels * sizeof(float)))
+    {
+        std::cerr << "Error: Failed to read pixel data" << std::endl;
+        FreePixels(data, count);
+        data = nullptr;
+        return;
+    }
+    if ((scale < 0) != isLittleEndian())
+        swapFloatBytes(body, count * channels);
+
+    if (channels == 1)
+        for (size_t i = 0; i < count; i++)
+            data[i] = vec3(gray[i]);
+
+    // Rows are stored bottom to top
+    for (int y = 0; y < height / 2; y++)
+        std::swap_ranges(data + static_cast<size_t>(y) * width, data + static_cast<size_t>(y + 1) * width,
+                         data + static_cast<size_t>(height - 1 - y) * width);
+}
+
+void ExportPFM(const char* path, int width, int height, const rcl::vec3* const & data)
+{
+    static_assert(sizeof(rcl::vec3) == 3 * sizeof(float), "PFM rows are written straight from the pixels");
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Cannot create file " << path << std::endl;
+        return;
+    }
+
+    // Native byte order, rows bottom to top
+    file << "PF\n" << width << ' ' << height << '\n' << (isLittleEndian() ? "-1.0" : "1.0") << '\n';
+    for (int y = height - 1; y >= 0; y--)
+        file.write(reinterpret_cast<const char*>(data + static_cast<size_t>(y) * width), static_cast<std::streamsize>(width) * sizeof(rcl::vec3));
+
+    if (!file.good())
+        std::cerr << "Error: Writing PFM file " << path << " failed" << std::endl;
+}
+
+void ImportHDR(const char* path, int& width, int& height, rcl::vec3*& data)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Cannot open file " << path << std::endl;
+        return;
+    }
+
+    std::string line;
+    std::getline(file, line);
+    if (line.compare(0, 2, "#?") != 0)
+    {
+        std::cerr << "Error: Not a valid Radiance HDR file " << path << std::endl;
+        return;
+    }
+
+    // Header variables up to an empty line, then the resolution
+    while (std::getline(file, line) && !line.empty())
+    {
+        if (line.compare(0, 7, "FORMAT=") == 0 && line != "FORMAT=32-bit_rle_rgbe")
+        {
+            std::cerr << "Error: Unsupported HDR format " << line.substr(7) << std::endl;
+            return;
+        }
+    }
+
+    char yAxis[3] = {0}, xAxis[3] = {0};
+    std::getline(file, line);
+    if (std::sscanf(line.c_str(), "%2s %d %2s %d", yAxis, &height, xAxis, &width) != 4 ||
+        std::strcmp(yAxis, "-Y") != 0 || std::strcmp(xAxis, "+X") != 0)
+    {
+        std::cerr << "Error: Unsupported HDR orientation " << line << std::endl;
+        return;
+    }
+    if (width <= 0 || height <= 0)
+    {
+        std::cerr << "Error: Invalid image dimensions" << std::endl;
+        return;
+    }
+
+    // The scanlines in one read
+    std::vector<unsigned char> body((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const unsigned char* in = body.data();
+    const unsigned char* end = in + body.size();
+
+    data = AllocatePixels(static_cast<size_t>(width) * height);
+    std::vector<unsigned char> rgbe(static_cast<size_t>(width) * 4);
+    for (int y = 0; y < height; y++)
+    {
+        if (!decodeRGBEScanline(in, end, width, rgbe.data()))
+        {
+            std::cerr << "Error: Failed to read HDR scanline " << y << std::endl;
+            FreePixels(data, static_cast<size_t>(width) * height);
+            data = nullptr;
+            return;
+        }
+
+        rcl::vec3* row = data + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; x++)
+            rgbeToFloat(&rgbe[4 * x], &row[x].r);
+    }
+}
+
+void ExportHDR(const char* path, int width, int height, const rcl::vec3* const & data)
 {
     std::ofstream file(path, std::ios::binary);
     if (!file.is_open())
     {
-        std::cerr << "Error: Cannot create PNG file " << path << std::endl;
+        std::cerr << "Error: Cannot create file " << path << std::endl;
         return;
     }
 
+    file << "#?RADIANCE\nFORMAT=32-bit_rle_rgbe\n\n-Y " << height << " +X " << width << '\n';
+
+    // Scanlines are converted and encoded in parallel, then written in order. Widths the run
+    // length encoding cannot describe are written flat.
+    bool encode = width >= 8 && width <= 0x7FFF;
+    std::vector<std::vector<unsigned char>> scanlines(height);
+    ParallelRanges(height, [&](size_t begin, size_t end)
+    {
+        std::vector<unsigned char> rgbe(static_cast<size_t>(width) * 4);
+        for (size_t y = begin; y < end; y++)
+        {
+            const rcl::vec3* row = data + y * width;
+            for (int x = 0; x < width; x++)
+                floatToRGBE(&row[x].r, &rgbe[4 * x]);
+
+            std::vector<unsigned char>& out = scanlines[y];
+            if (!encode)
+            {
+                out = rgbe;
+                continue;
+            }
+
+            out.reserve(rgbe.size() + 4);
+            out.push_back(2);
+            out.push_back(2);
+            out.push_back(static_cast<unsigned char>(width >> 8));
+            out.push_back(static_cast<unsigned char>(width & 0xFF));
+            for (int channel = 0; channel < 4; channel++)
+                encodeRGBERuns(rgbe.data() + channel, width, 4, out);
+        }
+    });
+
+    for (const std::vector<unsigned char>& scanline : scanlines)
+        file.write(reinterpret_cast<const char*>(scanline.data()), scanline.size());
+
+    if (!file.good())
+        std::cerr << "Error: Writing HDR file " << path << " failed" << std::endl;
+}
+
+ImageStreamWriter::ImageStreamWriter(const char* path, int width, int height, int compressionLevel)
+{
+    Open(path, width, height, compressionLevel);
+}
+
+ImageStreamWriter::~ImageStreamWriter()
+{
+    if (IsOpen())
+        Close();
+}
+
+bool ImageStreamWriter::Open(const char* path, int width, int height, int compressionLevel)
+{
+    const char* dot = strrchr(path, '.');
+    if (!dot)
+    {
+        std::cerr << "Error: No file extension found in " << path << std::endl;
+        return false;
+    }
+
+    std::string ext = dot;
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    if (ext == ".png")
+        return Open(path, width, height, Format::PNG, compressionLevel);
+    if (ext == ".ppm")
+        return Open(path, width, height, Format::PPM, compressionLevel);
+
+    std::cerr << "Error: Unsupported file format " << ext << std::endl;
+    return false;
+}
+
+bool ImageStreamWriter::Open(const char* path, int width, int height, Format format, int compressionLevel)
+{
+    if (IsOpen())
+        Close();
+
+    if (width <= 0 || height <= 0)
+    {
+        std::cerr << "Error: Wrong image size " << width << " x " << height << " for " << path << std::endl;
+        return false;
+    }
+
+    file.open(path, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Cannot create file " << path << std::endl;
+        return false;
+    }
+
+    this->width = width;
+    this->height = height;
+    this->format = format;
+    this->compressionLevel = std::clamp(compressionLevel, 0, 9);
+    rowsWritten = 0;
+    adler = 1;
+    previousRow.clear();
+    window.clear();
+
+    if (format != Format::PNG)
+    {
+        file << "P6\n" << width << ' ' << height << '\n' << (format == Format::PPM16 ? 65535 : 255) << '\n';
+        return file.good();
+    }
+
     // Write PNG signature
     unsigned char signature[8] = {137, 80, 78, 71, 13, 10, 26, 10};
     file.write(reinterpret_cast<char*>(signature), 8);
@@ -317,46 +656,181 @@ void ExportPNG(const char* path, int width, int height, const rcl::vec3* const &
     ihdr_data[12] = 0;  // interlace
 
     write_chunk(file, "IHDR", ihdr_data, 13);
+    return file.good();
+}
+
+bool ImageStreamWriter::WriteRows(const rcl::vec3* rows, int count)
+{
+    if (!IsOpen())
+    {
+        std::cerr << "Error: Image stream is not open" << std::endl;
+        return false;
+    }
+    if (count < 0 || count > height - rowsWritten)
+    {
+        std::cerr << "Error: " << count << " rows do not fit, " << rowsWritten << " of " << height << " written" << std::endl;
+        return false;
+    }
+    if (count == 0)
+        return true;
+
+    if (format == Format::PNG)
+        WritePNGRows(rows, count);
+    else
+        WritePPMRows(rows, count);
+    rowsWritten += count;
+
+    if (!file.good())
+    {
+        std::cerr << "Error: Writing image rows failed" << std::endl;
+        return false;
+    }
+    return true;
+}
 
-    // Prepare image data
-    static const rcl::Interval<double> intensity(0.000, 0.999);
-    std::vector<unsigned char> image_data;
+bool ImageStreamWriter::Close()
+{
+    if (!IsOpen())
+        return false;
+
+    bool complete = rowsWritten == height;
+    if (!complete)
+        std::cerr << "Error: Image closed with " << rowsWritten << " of " << height << " rows written" << std::endl;
+    else if (format == Format::PNG)
+        write_chunk(file, "IEND", nullptr, 0);
+
+    bool written = file.good();
+    file.close();
+    previousRow.clear();
+    window.clear();
+    return complete && written;
+}
+
+void ImageStreamWriter::SetResolve(const rcl::ResolveSettings& settings)
+{
+    resolve = settings;
+}
+
+bool ImageStreamWriter::IsOpen() const
+{
+    return file.is_open();
+}
+
+int ImageStreamWriter::GetWidth() const
+{
+    return width;
+}
+
+int ImageStreamWriter::GetHeight() const
+{
+    return height;
+}
+
+int ImageStreamWriter::GetRowsWritten() const
+{
+    return rowsWritten;
+}
+
+void ImageStreamWriter::WritePNGRows(const rcl::vec3* rows, int count)
+{
+    // Resolve to 8-bit RGB rows
+    size_t row_bytes = static_cast<size_t>(width) * 3;
+    std::vector<unsigned char> pixels(row_bytes * count);
     
-    for (int y = 0; y < height; y++)
+    Resolve(rows, pixels.data(), width, count, resolve, rowsWritten);
+
+    // Each row is preceded by its filter type, stored files keep the rows unfiltered. The filtered
+    // rows follow the window kept from the previous call, their dictionary.
+    size_t filtered_row_bytes = row_bytes + 1;
+    size_t start = window.size();
+    std::vector<unsigned char> image_data(std::move(window));
+    image_data.resize(start + filtered_row_bytes * count);
+    ParallelRanges(count, [&](size_t begin, size_t end)
     {
-        // Add filter type byte (0 = None filter)
-        image_data.push_back(0);
-        
-        for (int x = 0; x < width; x++)
+        for (size_t y = begin; y < end; y++)
         {
-            int index = y * width + x;
-            
-            // Clamp values to [0, 255] range
-            int r = static_cast<int>(256 * intensity.Clamp(data[index].r));
-            int g = static_cast<int>(256 * intensity.Clamp(data[index].g));
-            int b = static_cast<int>(256 * intensity.Clamp(data[index].b));
-            
-            // Ensure values don't exceed 255
-            r = std::min(r, 255);
-            g = std::min(g, 255);
-            b = std::min(b, 255);
+            const unsigned char* current = &pixels[y * row_bytes];
+            const unsigned char* previous = y > 0 ? current - row_bytes : previousRow.empty() ? nullptr : previousRow.data();
+            unsigned char* filtered = &image_data[start + y * filtered_row_bytes];
             
-            image_data.push_back(static_cast<unsigned char>(r));
-            image_data.push_back(static_cast<unsigned char>(g));
-            image_data.push_back(static_cast<unsigned char>(b));
+            if (compressionLevel > 0)
+            {
+                filtered[0] = filter_scanline_adaptive(filtered + 1, current, previous, 3, row_bytes);
+            }
+            else
+            {
+                filtered[0] = 0;
+                std::memcpy(filtered + 1, current, row_bytes);
+            }
         }
-    }
+    });
+
+    // Bands of whole rows are compressed separately, pigz style, and written as IDAT chunks of
+    // their own. The bands do not depend on the thread count, so neither does the file.
+    struct Segment
+    {
+        std::vector<unsigned char> compressed;
+        size_t length;
+        uint32_t adler;
+    };
+
+    bool first = rowsWritten == 0;
+    bool last = rowsWritten + count == height;
+    size_t rows_per_segment = std::max<size_t>(1, PNG_SEGMENT_BYTES / filtered_row_bytes);
+    size_t segment_count = (count + rows_per_segment - 1) / rows_per_segment;
+    std::vector<Segment> segments(segment_count);
+
+    ParallelRanges(segment_count, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+        {
+            size_t segment_start = start + i * rows_per_segment * filtered_row_bytes;
+            size_t segment_stop = std::min(segment_start + rows_per_segment * filtered_row_bytes, image_data.size());
+            Segment& segment = segments[i];
+
+            if (first && i == 0)
+                zlib_header(compressionLevel, segment.compressed);
+            deflate_segment(image_data.data(), segment_start, segment_stop, compressionLevel,
+                            last && i + 1 == segment_count, segment.compressed);
+            segment.length = segment_stop - segment_start;
+            segment.adler = adler32(image_data.data() + segment_start, segment.length);
+        }
+    });
 
-    // Compress image data using simple deflate (uncompressed blocks)
-    std::vector<unsigned char> compressed_data = simple_deflate(image_data);
+    for (Segment& segment : segments)
+    {
+        adler = adler32_combine(adler, segment.adler, segment.length);
+        if (last && &segment == &segments.back())
+            zlib_trailer(adler, segment.compressed);
+        write_chunk(file, "IDAT", segment.compressed.data(), static_cast<uint32_t>(segment.compressed.size()));
+    }
 
-    // Write IDAT chunk
-    write_chunk(file, "IDAT", compressed_data.data(), compressed_data.size());
+    // Keep what the next rows need: the last row to filter against, the last 32K to match against
+    previousRow.assign(pixels.end() - row_bytes, pixels.end());
+    size_t keep = std::min<size_t>(image_data.size(), PNG_WINDOW_BYTES);
+    window.assign(image_data.end() - keep, image_data.end());
+}
 
-    // Write IEND chunk
-    write_chunk(file, "IEND", nullptr, 0);
+void ImageStreamWriter::WritePPMRows(const rcl::vec3* rows, int count)
+{
+    // The rows in one block: bytes, or 16-bit big endian samples
+    size_t samples = static_cast<size_t>(width) * count * 3;
+    if (format == Format::PPM)
+    {
+        std::vector<unsigned char> body(samples);
+        Resolve(rows, body.data(), width, count, resolve, rowsWritten);
+        file.write(reinterpret_cast<const char*>(body.data()), body.size());
+        return;
+    }
 
-    file.close();
+    std::vector<uint16_t> body(samples);
+    Resolve(rows, body.data(), width, count, resolve, rowsWritten);
+    for (uint16_t& sample : body)
+    {
+        unsigned char bytes[2] = {static_cast<unsigned char>(sample >> 8), static_cast<unsigned char>(sample & 0xFF)};
+        std::memcpy(&sample, bytes, 2);
+    }
+    file.write(reinterpret_cast<const char*>(body.data()), body.size() * 2);
 }
 
 }
\ No newline at end of file
@@ -7,7 +7,6 @@ namespace rcl
 {
 
 Ray::Ray(rcl::vec3 origin, rcl::vec3 direction) : origin(origin), direction(direction.Unit()){};
-Ray::Ray(const rcl::Ray& original) : origin(original.origin), direction(original.direction){};
 
 rcl::vec3 Ray::RandomOnHemisphere(const rcl::vec3& normal)
 {
@@ -24,6 +23,17 @@ rcl::vec3 Ray::RandomOnHemisphere(const rcl::vec3& normal)
     return dir.x * u + dir.y * v + dir.z * w;
 }
 
+rcl::vec3 Ray::RandomCosineOnHemisphere(const rcl::vec3& normal)
+{
+    rcl::vec3 w = normal.Unit();
+    rcl::vec3 a = (fabs(w.x) > 0.9f ? rcl::vec3(0, 1, 0) : rcl::vec3(1, 0, 0));
+    rcl::vec3 u = Cross(w, a).Unit();
+    rcl::vec3 v = Cross(w, u);
+
+    rcl::vec3 dir = RandomCosineDirection();
+    return dir.x * u + dir.y * v + dir.z * w;
+}
+
 rcl::vec3 Ray::GetRandomDiskRay()
 {
     while(true)
@@ -39,6 +49,11 @@ rcl::vec3 Ray::At(float t) const
     return origin + t * direction;
 }
 
+float Ray::ConeWidth(float t) const
+{
+    return coneWidth + coneSpread * t;
+}
+
 rcl::vec3 Ray::RandomCosineDirection() 
 {
     double r1 = rcl::RandomDouble01();
@@ -0,0 +1,332 @@
+#include "resolve.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <future>
+#include <vector>
+
+// The AVX2 path is compiled for it function by function and only taken after checking the
+// processor, as in checksum.cpp
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define RCL_RESOLVE_X86
+#include <immintrin.h>
+#endif
+
+namespace rcl
+{
+
+namespace
+{
+    // The power segment of the sRGB curve sampled over t = sqrt(x), where it is smooth enough for
+    // linear interpolation to stay within 1e-6. The linear toe is computed directly, interpolating
+    // across the kink would be 10 times less accurate.
+    const int SRGB_STEPS = 1024;
+    const float SRGB_TOE = 0.0031308f;
+    const float SRGB_TOE_SLOPE = 12.92f;
+
+    struct SRGBTable
+    {
+        float values[SRGB_STEPS + 2];
+
+        SRGBTable()
+        {
+            for (int i = 0; i <= SRGB_STEPS + 1; i++)
+            {
+                double t = std::min(1.0, double(i) / SRGB_STEPS);
+                values[i] = static_cast<float>(1.055 * std::pow(t * t, 1 / 2.4) - 0.055);
+            }
+        }
+    };
+
+    const SRGBTable& srgb_table()
+    {
+        static const SRGBTable table;
+        return table;
+    }
+
+    // Everything a span of samples needs, worked out once per call
+    struct Kernel
+    {
+        float scale;
+        ToneCurve toneCurve;
+        TransferCurve transfer;
+        const float* srgb;
+
+        // Quantization: trunc(min(max(v, 0), top) * steps + offset + dither), clamped to [0, maxValue]
+        bool dither;
+        float top;
+        float steps;
+        float offset;
+        int maxValue;
+
+        Kernel(const ResolveSettings& settings, int maxValue)
+        : scale(std::exp2(settings.exposure)), toneCurve(settings.toneCurve), transfer(settings.transfer),
+          srgb(srgb_table().values), dither(settings.dither && maxValue > 0), maxValue(maxValue)
+        {
+            if (maxValue == 255)
+            {
+                top = 0.999f;
+                steps = 256.0f;
+                offset = 0.0f;
+            }
+            else
+            {
+                top = 1.0f;
+                steps = static_cast<float>(maxValue);
+                offset = 0.5f;
+            }
+        }
+    };
+
+    // Triangular noise in (-1, 1) from two 16-bit halves of a hash of the sample's position
+    uint32_t hash(uint32_t x)
+    {
+        x *= 0x9E3779B1u;
+        x ^= x >> 16;
+        x *= 0x85EBCA6Bu;
+        x ^= x >> 13;
+        x *= 0xC2B2AE35u;
+        x ^= x >> 16;
+        return x;
+    }
+
+    float dither_noise(uint32_t index)
+    {
+        uint32_t h = hash(index);
+        return static_cast<float>(static_cast<int>(h & 0xFFFF) - static_cast<int>(h >> 16)) * (1.0f / 65536.0f);
+    }
+
+    // What _mm256_max_ps(v, low) and _mm256_min_ps(v, high) give: the bound for a NaN v, where
+    // std::max and std::min would pass the NaN on
+    float max_of(float v, float low) { return v > low ? v : low; }
+    float min_of(float v, float high) { return v < high ? v : high; }
+
+    float curves(float v, const Kernel& k)
+    {
+        v *= k.scale;
+
+        if (k.toneCurve == ToneCurve::Reinhard)
+        {
+            v = v / (v + 1.0f);
+        }
+        else if (k.toneCurve == ToneCurve::ACES)
+        {
+            v = max_of(v, 0.0f);
+            v = min_of((v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f), 1.0f);
+        }
+
+        if (k.transfer == TransferCurve::Gamma2)
+        {
+            v = std::sqrt(max_of(v, 0.0f));
+        }
+        else if (k.transfer == TransferCurve::SRGB)
+        {
+            v = min_of(max_of(v, 0.0f), 1.0f);
+            float t = std::sqrt(v) * SRGB_STEPS;
+            int i = std::min(static_cast<int>(t), SRGB_STEPS - 1);
+            float f = t - static_cast<float>(i);
+            v = v <= SRGB_TOE ? v * SRGB_TOE_SLOPE : k.srgb[i] + (k.srgb[i + 1] - k.srgb[i]) * f;
+        }
+        return v;
+    }
+
+    int quantize(float v, uint32_t index, const Kernel& k)
+    {
+        // NaN becomes 0 before the cast, which is only defined for values an int holds
+        float q = min_of(max_of(v, 0.0f), k.top) * k.steps + k.offset;
+        if (k.dither)
+            q += dither_noise(index);
+        return std::min(std::max(static_cast<int>(q), 0), k.maxValue);
+    }
+
+    void store(float* out, size_t i, float v, uint32_t, const Kernel&) { out[i] = v; }
+    void store(uint8_t* out, size_t i, float v, uint32_t index, const Kernel& k) { out[i] = static_cast<uint8_t>(quantize(v, index, k)); }
+    void store(uint16_t* out, size_t i, float v, uint32_t index, const Kernel& k) { out[i] = static_cast<uint16_t>(quantize(v, index, k)); }
+
+    // Samples [begin, end) of in, index is the position in the image of sample begin
+    template<typename Sample>
+    void resolve_scalar(const float* in, Sample* out, size_t begin, size_t end, uint32_t index, const Kernel& k)
+    {
+        for (size_t i = begin; i < end; i++, index++)
+            store(out, i, curves(in[i], k), index, k);
+    }
+
+#ifdef RCL_RESOLVE_X86
+    bool has_avx2()
+    {
+        static const bool supported = __builtin_cpu_supports("avx2");
+        return supported;
+    }
+
+    // The scalar operations in the same order, so both paths give the same bits
+    __attribute__((target("avx2")))
+    __m256 curves_avx2(__m256 v, const Kernel& k)
+    {
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        v = _mm256_mul_ps(v, _mm256_set1_ps(k.scale));
+
+        if (k.toneCurve == ToneCurve::Reinhard)
+        {
+            v = _mm256_div_ps(v, _mm256_add_ps(v, one));
+        }
+        else if (k.toneCurve == ToneCurve::ACES)
+        {
+            v = _mm256_max_ps(v, zero);
+            __m256 numerator = _mm256_mul_ps(v, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(2.51f), v), _mm256_set1_ps(0.03f)));
+            __m256 denominator = _mm256_add_ps(_mm256_mul_ps(v, _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(2.43f), v), _mm256_set1_ps(0.59f))), _mm256_set1_ps(0.14f));
+            v = _mm256_min_ps(_mm256_div_ps(numerator, denominator), one);
+        }
+
+        if (k.transfer == TransferCurve::Gamma2)
+        {
+            v = _mm256_sqrt_ps(_mm256_max_ps(v, zero));
+        }
+        else if (k.transfer == TransferCurve::SRGB)
+        {
+            v = _mm256_min_ps(_mm256_max_ps(v, zero), one);
+            __m256 t = _mm256_mul_ps(_mm256_sqrt_ps(v), _mm256_set1_ps(static_cast<float>(SRGB_STEPS)));
+            __m256i i = _mm256_min_epi32(_mm256_cvttps_epi32(t), _mm256_set1_epi32(SRGB_STEPS - 1));
+            __m256 f = _mm256_sub_ps(t, _mm256_cvtepi32_ps(i));
+            __m256 a = _mm256_i32gather_ps(k.srgb, i, 4);
+            __m256 b = _mm256_i32gather_ps(k.srgb + 1, i, 4);
+            __m256 curve = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), f));
+            __m256 toe = _mm256_mul_ps(v, _mm256_set1_ps(SRGB_TOE_SLOPE));
+            v = _mm256_blendv_ps(curve, toe, _mm256_cmp_ps(v, _mm256_set1_ps(SRGB_TOE), _CMP_LE_OQ));
+        }
+        return v;
+    }
+
+    __attribute__((target("avx2")))
+    __m256i quantize_avx2(__m256 v, uint32_t index, const Kernel& k)
+    {
+        __m256 q = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(k.top));
+        q = _mm256_add_ps(_mm256_mul_ps(q, _mm256_set1_ps(k.steps)), _mm256_set1_ps(k.offset));
+
+        if (k.dither)
+        {
+            __m256i x = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(index)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+            x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x9E3779B1u)));
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+            x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0x85EBCA6Bu)));
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 13));
+            x = _mm256_mullo_epi32(x, _mm256_set1_epi32(static_cast<int>(0xC2B2AE35u)));
+            x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+            __m256i low = _mm256_and_si256(x, _mm256_set1_epi32(0xFFFF));
+            __m256i high = _mm256_srli_epi32(x, 16);
+            __m256 noise = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(low, high)), _mm256_set1_ps(1.0f / 65536.0f));
+            q = _mm256_add_ps(q, noise);
+        }
+
+        __m256i result = _mm256_cvttps_epi32(q);
+        return _mm256_min_epi32(_mm256_max_epi32(result, _mm256_setzero_si256()), _mm256_set1_epi32(k.maxValue));
+    }
+
+    __attribute__((target("avx2")))
+    void store_avx2(float* out, __m256 v, uint32_t, const Kernel&)
+    {
+        _mm256_storeu_ps(out, v);
+    }
+
+    __attribute__((target("avx2")))
+    void store_avx2(uint8_t* out, __m256 v, uint32_t index, const Kernel& k)
+    {
+        __m256i q = quantize_avx2(v, index, k);
+        __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(words, words));
+    }
+
+    __attribute__((target("avx2")))
+    void store_avx2(uint16_t* out, __m256 v, uint32_t index, const Kernel& k)
+    {
+        __m256i q = quantize_avx2(v, index, k);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi32(_mm256_castsi256_si128(q), _mm256_extracti128_si256(q, 1)));
+    }
+
+    template<typename Sample>
+    __attribute__((target("avx2")))
+    void resolve_avx2(const float* in, Sample* out, size_t begin, size_t end, uint32_t index, const Kernel& k)
+    {
+        size_t i = begin;
+        for (; i + 8 <= end; i += 8, index += 8)
+            store_avx2(out + i, curves_avx2(_mm256_loadu_ps(in + i), k), index, k);
+        resolve_scalar(in, out, i, end, index, k);
+    }
+#endif
+
+    template<typename Sample>
+    void resolve_rows(const vec3* in, Sample* out, int width, int rows, int firstRow, const Kernel& k)
+    {
+        static_assert(sizeof(vec3) == 3 * sizeof(float), "pixels are read as packed floats");
+        const float* samples = &in[0].r;
+        size_t rowSamples = static_cast<size_t>(width) * 3;
+        uint32_t first = static_cast<uint32_t>(static_cast<size_t>(firstRow) * rowSamples);
+
+        auto work = [=, &k](size_t begin, size_t end)
+        {
+#ifdef RCL_RESOLVE_X86
+            if (has_avx2())
+            {
+                resolve_avx2(samples, out, begin * rowSamples, end * rowSamples, first + static_cast<uint32_t>(begin * rowSamples), k);
+                return;
+            }
+#endif
+            resolve_scalar(samples, out, begin * rowSamples, end * rowSamples, first + static_cast<uint32_t>(begin * rowSamples), k);
+        };
+
+        // Threads only pay off for a good number of samples each
+        const size_t MIN_SAMPLES_PER_THREAD = 1 << 16;
+        unsigned int numThreads = std::thread::hardware_concurrency();
+        if (numThreads == 0) numThreads = 1; // fallback if detection fails
+        size_t useful = std::max<size_t>(1, rows * rowSamples / MIN_SAMPLES_PER_THREAD);
+        numThreads = static_cast<unsigned int>(std::min<size_t>({numThreads, useful, static_cast<size_t>(std::max(rows, 1))}));
+
+        if (numThreads <= 1)
+        {
+            work(0, rows);
+            return;
+        }
+
+        size_t perThread = rows / numThreads;
+        size_t remainder = rows % numThreads;
+        std::vector<std::future<void>> futures;
+        size_t begin = 0;
+        for (unsigned int t = 0; t < numThreads; t++)
+        {
+            size_t end = begin + perThread + (t < remainder ? 1 : 0);
+            futures.push_back(std::async(std::launch::async, work, begin, end));
+            begin = end;
+        }
+
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+    }
+}
+
+void Resolve(const vec3* in, vec3* out, int width, int rows, const ResolveSettings& settings)
+{
+    // Nothing to do to floats, a linear render resolved in place costs no pass
+    if (settings.exposure == 0 && settings.toneCurve == ToneCurve::None && settings.transfer == TransferCurve::Linear)
+    {
+        if (in != out)
+            std::memcpy(out, in, static_cast<size_t>(width) * rows * sizeof(vec3));
+        return;
+    }
+    resolve_rows(in, &out[0].r, width, rows, 0, Kernel(settings, 0));
+}
+
+void Resolve(const vec3* in, uint8_t* out, int width, int rows, const ResolveSettings& settings, int firstRow)
+{
+    resolve_rows(in, out, width, rows, firstRow, Kernel(settings, 255));
+}
+
+void Resolve(const vec3* in, uint16_t* out, int width, int rows, const ResolveSettings& settings, int firstRow)
+{
+    resolve_rows(in, out, width, rows, firstRow, Kernel(settings, 65535));
+}
+
+}
\ No newline at end of file
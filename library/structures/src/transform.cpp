@@ -0,0 +1,163 @@
+#include "transform.hpp"
+
+#include <cmath>
+
+#include "constants.hpp"
+
+namespace rcl
+{
+
+Transform::Transform()
+{
+    for (int row = 0; row < 3; row++)
+        for (int col = 0; col < 4; col++)
+            m[row][col] = (row == col) ? 1.0 : 0.0;
+}
+
+Transform Transform::Translate(const rcl::vec3& offset)
+{
+    Transform result;
+    result.m[0][3] = offset.x;
+    result.m[1][3] = offset.y;
+    result.m[2][3] = offset.z;
+    return result;
+}
+
+Transform Transform::Scale(const rcl::vec3& factor)
+{
+    Transform result;
+    result.m[0][0] = factor.x;
+    result.m[1][1] = factor.y;
+    result.m[2][2] = factor.z;
+    return result;
+}
+
+Transform Transform::Rotate(const rcl::vec3& axis, double degrees)
+{
+    rcl::vec3 a = axis.Unit();
+    double theta = degrees * deegreesToRadians;
+    double c = std::cos(theta);
+    double s = std::sin(theta);
+    double t = 1 - c;
+
+    Transform result;
+    result.m[0][0] = t * a.x * a.x + c;
+    result.m[0][1] = t * a.x * a.y - s * a.z;
+    result.m[0][2] = t * a.x * a.z + s * a.y;
+    result.m[1][0] = t * a.x * a.y + s * a.z;
+    result.m[1][1] = t * a.y * a.y + c;
+    result.m[1][2] = t * a.y * a.z - s * a.x;
+    result.m[2][0] = t * a.x * a.z - s * a.y;
+    result.m[2][1] = t * a.y * a.z + s * a.x;
+    result.m[2][2] = t * a.z * a.z + c;
+    return result;
+}
+
+Transform Transform::operator*(const Transform& other) const
+{
+    Transform result;
+    for (int row = 0; row < 3; row++)
+    {
+        for (int col = 0; col < 4; col++)
+        {
+            double value = (col == 3) ? m[row][3] : 0.0;
+            for (int k = 0; k < 3; k++)
+                value += m[row][k] * other.m[k][col];
+            result.m[row][col] = value;
+        }
+    }
+    return result;
+}
+
+double Transform::Determinant() const
+{
+    return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+         - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+         + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+}
+
+Transform Transform::Inverse() const
+{
+    Transform result;
+
+    double det = Determinant();
+    if (std::fabs(det) < 1e-12)
+        return result;
+
+    double invDet = 1.0 / det;
+
+    result.m[0][0] =  (m[1][1] * m[2][2] - m[1][2] * m[2][1]) * invDet;
+    result.m[0][1] = -(m[0][1] * m[2][2] - m[0][2] * m[2][1]) * invDet;
+    result.m[0][2] =  (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * invDet;
+    result.m[1][0] = -(m[1][0] * m[2][2] - m[1][2] * m[2][0]) * invDet;
+    result.m[1][1] =  (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * invDet;
+    result.m[1][2] = -(m[0][0] * m[1][2] - m[0][2] * m[1][0]) * invDet;
+    result.m[2][0] =  (m[1][0] * m[2][1] - m[1][1] * m[2][0]) * invDet;
+    result.m[2][1] = -(m[0][0] * m[2][1] - m[0][1] * m[2][0]) * invDet;
+    result.m[2][2] =  (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * invDet;
+
+    // Inverse translation is -R^-1 * t
+    for (int row = 0; row < 3; row++)
+        result.m[row][3] = -(result.m[row][0] * m[0][3] + result.m[row][1] * m[1][3] + result.m[row][2] * m[2][3]);
+
+    return result;
+}
+
+rcl::vec3 Transform::ApplyPoint(const rcl::vec3& p) const
+{
+    return rcl::vec3
+    (
+        m[0][0] * p.x + m[0][1] * p.y + m[0][2] * p.z + m[0][3],
+        m[1][0] * p.x + m[1][1] * p.y + m[1][2] * p.z + m[1][3],
+        m[2][0] * p.x + m[2][1] * p.y + m[2][2] * p.z + m[2][3]
+    );
+}
+
+rcl::vec3 Transform::ApplyVector(const rcl::vec3& v) const
+{
+    return rcl::vec3
+    (
+        m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+        m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+        m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z
+    );
+}
+
+rcl::vec3 Transform::ApplyTransposed(const rcl::vec3& v) const
+{
+    return rcl::vec3
+    (
+        m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z,
+        m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z,
+        m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z
+    );
+}
+
+rcl::AABB Transform::ApplyBox(const rcl::AABB& box) const
+{
+    // Transformed box is centre +- |R| * half extent
+    double center[3] = {(box.x.min + box.x.max) / 2, (box.y.min + box.y.max) / 2, (box.z.min + box.z.max) / 2};
+    double extent[3] = {box.x.Size() / 2, box.y.Size() / 2, box.z.Size() / 2};
+
+    double newCenter[3];
+    double newExtent[3];
+    for (int row = 0; row < 3; row++)
+    {
+        newCenter[row] = m[row][3];
+        newExtent[row] = 0;
+        for (int k = 0; k < 3; k++)
+        {
+            newCenter[row] += m[row][k] * center[k];
+            newExtent[row] += std::fabs(m[row][k]) * extent[k];
+        }
+    }
+
+    return rcl::AABB
+    (
+        rcl::Interval<double>(newCenter[0] - newExtent[0], newCenter[0] + newExtent[0]),
+        rcl::Interval<double>(newCenter[1] - newExtent[1], newCenter[1] + newExtent[1]),
+        rcl::Interval<double>(newCenter[2] - newExtent[2], newCenter[2] + newExtent[2])
+    );
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "constants.hpp"
+#include "sphere.hpp"
+#include "instance.hpp"
+#include "hittable_list.hpp"
+#include "bvh.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Instances orbit the origin with a speed depending on their radius, so the
+// scene slowly shuffles and the refitted tree loses quality frame after frame
+rcl::Transform Placement(const rcl::vec3& rest, double frame)
+{
+    double radius = std::sqrt(rest.x * rest.x + rest.z * rest.z);
+    double angle = frame * (4.0 + 40.0 / (1.0 + radius));
+    return rcl::Transform::Rotate(rcl::vec3(0, 1, 0), angle) * rcl::Transform::Translate(rest);
+}
+
+size_t CastRays(const rcl::Hittable& scene, const std::vector<rcl::Ray>& rays)
+{
+    size_t hits = 0;
+    rcl::HitRecord record;
+    for (const rcl::Ray& ray : rays)
+        if (scene.hit(ray, rcl::Interval<double>(0.001, rcl::infinity), record))
+            hits++;
+    return hits;
+}
+
+}
+
+int main()
+{
+    const int instanceCount = 20000;
+    const int frameCount = 24;
+    const int rayCount = 20000;
+
+    auto sphere = std::make_shared<rcl::Sphere>(rcl::vec3(0), 0.2, nullptr);
+
+    std::vector<rcl::vec3> restPositions;
+    std::vector<std::shared_ptr<rcl::Instance>> instances;
+    rcl::HittableList list;
+
+    for (int i = 0; i < instanceCount; i++)
+    {
+        rcl::vec3 rest(rcl::RandomDoubleMinMax(-50, 50), rcl::RandomDoubleMinMax(-2, 2), rcl::RandomDoubleMinMax(-50, 50));
+        restPositions.push_back(rest);
+        instances.push_back(std::make_shared<rcl::Instance>(sphere, Placement(rest, 0)));
+        list.Add(instances.back());
+    }
+
+    std::vector<rcl::Ray> rays;
+    for (int i = 0; i < rayCount; i++)
+    {
+        rcl::vec3 origin(rcl::RandomDoubleMinMax(-50, 50), 20, rcl::RandomDoubleMinMax(-50, 50));
+        rays.push_back(rcl::Ray(origin, rcl::vec3(rcl::RandomDoubleMinMax(-0.2, 0.2), -1, rcl::RandomDoubleMinMax(-0.2, 0.2))));
+    }
+
+    auto refitted = std::make_shared<rcl::BVHNode>(list);
+
+    double totalRebuildMs = 0, totalRebuildRaysMs = 0;
+    double totalUpdateMs = 0, totalUpdateRaysMs = 0;
+    int rebuildsTriggered = 0;
+
+    for (int frame = 1; frame <= frameCount; frame++)
+    {
+        for (int i = 0; i < instanceCount; i++)
+            instances[i]->SetTransform(Placement(restPositions[i], frame));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        auto rebuilt = std::make_shared<rcl::BVHNode>(list);
+        double rebuildMs = Milliseconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        size_t rebuiltHits = CastRays(*rebuilt, rays);
+        double rebuildRaysMs = Milliseconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        bool partial = refitted->Update();
+        double updateMs = Milliseconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        size_t refittedHits = CastRays(*refitted, rays);
+        double updateRaysMs = Milliseconds(start);
+
+        rebuildsTriggered += partial ? 1 : 0;
+        totalRebuildMs += rebuildMs;
+        totalRebuildRaysMs += rebuildRaysMs;
+        totalUpdateMs += updateMs;
+        totalUpdateRaysMs += updateRaysMs;
+
+        std::cout << "frame:" << frame
+                  << " | rebuild:" << rebuildMs << "ms rays:" << rebuildRaysMs << "ms sah:" << rebuilt->Cost()
+                  << " | update:" << updateMs << "ms rays:" << updateRaysMs << "ms sah:" << refitted->Cost()
+                  << (partial ? " (rebuilt subtrees)" : "")
+                  << (rebuiltHits == refittedHits ? "" : " HITS DIFFER")
+                  << std::endl;
+    }
+
+    std::cout << "total | rebuild:" << totalRebuildMs << "ms rays:" << totalRebuildRaysMs << "ms"
+              << " | update:" << totalUpdateMs << "ms rays:" << totalUpdateRaysMs << "ms"
+              << " frames with rebuilds:" << rebuildsTriggered << std::endl;
+
+    return 0;
+}
\ No newline at end of file
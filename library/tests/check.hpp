@@ -0,0 +1,15 @@
+#ifndef RCL_TESTS_CHECK
+#define RCL_TESTS_CHECK
+
+#include <iostream>
+#include <string>
+
+// Prints what failed and hands the condition back, for passed &= Check(...)
+inline bool Check(bool condition, const std::string& what)
+{
+    if (!condition)
+        std::cout << "FAILED: " << what << std::endl;
+    return condition;
+}
+
+#endif
\ No newline at end of file
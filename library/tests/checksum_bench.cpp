@@ -0,0 +1,104 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+#include "functions.hpp"
+#include "checksum.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Straight from the definitions, one bit and one byte at a time
+uint32_t ReferenceCrc32(const unsigned char* data, size_t length)
+{
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++)
+    {
+        c ^= data[i];
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+    }
+    return ~c;
+}
+
+uint32_t ReferenceAdler32(const unsigned char* data, size_t length)
+{
+    uint32_t a = 1, b = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    return (b << 16) | a;
+}
+
+}
+
+// Usage: checksum_bench [megabytes], checks both checksums against the definitions and times them
+int main(int argc, char** argv)
+{
+    size_t megabytes = argc > 1 ? std::stoul(argv[1]) : 64;
+    std::vector<unsigned char> data(megabytes << 20);
+    for (unsigned char& byte : data)
+        byte = static_cast<unsigned char>(rcl::RandomIntMinMax(0, 255));
+    // Worst case for the Adler sums
+    std::vector<unsigned char> full(100000, 0xFF);
+
+    size_t failures = 0;
+    // Every short length and alignment, where the vector paths hand over to the scalar ones
+    for (size_t offset = 0; offset < 16; offset++)
+    {
+        for (size_t length = 0; length < 600; length++)
+        {
+            const unsigned char* p = data.data() + offset;
+            if (rcl::crc32(p, length) != ReferenceCrc32(p, length) ||
+                rcl::adler32(p, length) != ReferenceAdler32(p, length))
+                failures++;
+        }
+    }
+
+    // Long buffers, split ones and their combinations
+    size_t lengths[] = {5552, 5553, 65536, 1000003};
+    for (size_t length : lengths)
+    {
+        const unsigned char* p = data.data() + 3;
+        uint32_t crc = ReferenceCrc32(p, length);
+        uint32_t adler = ReferenceAdler32(p, length);
+        size_t split = length / 3;
+        if (rcl::crc32(p, length) != crc || rcl::adler32(p, length) != adler ||
+            rcl::crc32(p + split, length - split, rcl::crc32(p, split)) != crc ||
+            rcl::adler32(p + split, length - split, rcl::adler32(p, split)) != adler ||
+            rcl::crc32_combine(rcl::crc32(p, split), rcl::crc32(p + split, length - split), length - split) != crc ||
+            rcl::adler32_combine(rcl::adler32(p, split), rcl::adler32(p + split, length - split), length - split) != adler)
+            failures++;
+    }
+    if (rcl::adler32(full.data(), full.size()) != ReferenceAdler32(full.data(), full.size()))
+        failures++;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    uint32_t reference = ReferenceCrc32(data.data(), data.size() / 8);
+    double referenceMs = Milliseconds(start) * 8;
+
+    start = std::chrono::high_resolution_clock::now();
+    uint32_t crc = rcl::crc32(data.data(), data.size());
+    double crcMs = Milliseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    uint32_t adler = rcl::adler32(data.data(), data.size());
+    double adlerMs = Milliseconds(start);
+
+    double mb = static_cast<double>(megabytes);
+    std::cout << megabytes << " MB: bitwise CRC-32 " << mb / (referenceMs / 1000) << " MB/s, crc32 "
+              << mb / (crcMs / 1000) << " MB/s, adler32 " << mb / (adlerMs / 1000) << " MB/s"
+              << " (" << std::hex << (reference ^ crc ^ adler) << std::dec << ")" << std::endl;
+
+    std::cout << (failures == 0 ? "all passed" : "SOME FAILED: " + std::to_string(failures)) << std::endl;
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "picture.hpp"
+#include "pictures_workers.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+long FileSize(const char* path)
+{
+    std::ifstream written(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(written.tellg());
+}
+
+// Linear radiance as a renderer leaves it: a sky gradient, a sun far above 1,
+// flat black and flat colored areas for the run length encoding, and noise
+std::vector<rcl::vec3> MakeImage(int width, int height)
+{
+    std::vector<rcl::vec3> pixels(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            double u = double(x) / width;
+            double v = double(y) / height;
+            rcl::vec3 color(0.3 + 0.5 * v, 0.5 + 0.3 * v, 1.0 + 0.2 * u);
+            if ((u - 0.7) * (u - 0.7) + (v - 0.2) * (v - 0.2) < 0.002)
+                color = rcl::vec3(5000.0, 4000.0, 3000.0);
+            else if (v > 0.8)
+                color = rcl::vec3(0);
+            else if (v > 0.6)
+                color = rcl::vec3(0.25, 0.5, 0.125);
+            else
+                color *= 1.0 + 0.1 * rcl::RandomDouble01();
+            pixels[static_cast<size_t>(y) * width + x] = color;
+        }
+    }
+    return pixels;
+}
+
+// Largest error relative to the brightest component of its pixel, what RGBE promises to bound
+double MaxError(const std::vector<rcl::vec3>& pixels, const rcl::vec3* read)
+{
+    double error = 0;
+    for (size_t i = 0; i < pixels.size(); i++)
+    {
+        double scale = std::max(pixels[i].MaxComponent(), 1e-30f);
+        error = std::max(error, std::abs(read[i].r - pixels[i].r) / scale);
+        error = std::max(error, std::abs(read[i].g - pixels[i].g) / scale);
+        error = std::max(error, std::abs(read[i].b - pixels[i].b) / scale);
+    }
+    return error;
+}
+
+}
+
+// Usage: hdr_export_test [width] [height], writes linear images as PFM and HDR and reads them back
+int main(int argc, char** argv)
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 640;
+    int height = argc > 2 ? std::atoi(argv[2]) : 480;
+
+    bool passed = true;
+    // The flat scanlines of images too narrow for run length encoding too
+    int widths[] = {width, 5};
+    const char* paths[] = {"hdr_export_test.pfm", "hdr_export_test.hdr"};
+    for (int w : widths)
+    {
+        std::vector<rcl::vec3> pixels = MakeImage(w, height);
+        rcl::Picture picture(w, height);
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < w; x++)
+                picture.WritePixel(y, x, pixels[static_cast<size_t>(y) * w + x]);
+
+        for (const char* path : paths)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            picture.Export(path);
+            double exportMs = Milliseconds(start);
+
+            bool exact = std::string(path).find(".pfm") != std::string::npos;
+            int readWidth = 0, readHeight = 0;
+            rcl::vec3* read = nullptr;
+            start = std::chrono::high_resolution_clock::now();
+            if (exact)
+                rcl::ImportPFM(path, readWidth, readHeight, read);
+            else
+                rcl::ImportHDR(path, readWidth, readHeight, read);
+            double importMs = Milliseconds(start);
+
+            double error = read && readWidth == w && readHeight == height ? MaxError(pixels, read) : 1;
+            rcl::FreePixels(read, static_cast<size_t>(readWidth) * readHeight);
+            // RGBE keeps 8 bits of the largest component
+            bool ok = exact ? error == 0 : error <= 1.0 / 128;
+            passed = passed && ok;
+
+            std::cout << w << " x " << height << " " << path << ": " << FileSize(path) / 1024 << " KB, export "
+                      << exportMs << " ms, import " << importMs << " ms, max relative error " << error
+                      << (ok ? "" : " TOO LARGE") << std::endl;
+            std::remove(path);
+        }
+    }
+
+    std::cout << (passed ? "all passed" : "SOME FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#include "functions.hpp"
+#include "png_workers.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct Stream
+{
+    std::string name;
+    std::vector<unsigned char> compressed;
+};
+
+// The concatenated IDAT payloads of a PNG file, empty when it cannot be read
+std::vector<unsigned char> ReadIDAT(const char* path)
+{
+    std::vector<unsigned char> data;
+    std::ifstream file(path, std::ios::binary);
+    char signature[8];
+    if (!file.read(signature, 8))
+        return data;
+
+    while (file.good())
+    {
+        uint32_t length = rcl::read_uint32_be(file);
+        char type[5] = {0};
+        if (!file.read(type, 4))
+            break;
+        if (std::strcmp(type, "IDAT") == 0)
+        {
+            size_t offset = data.size();
+            data.resize(offset + length);
+            file.read(reinterpret_cast<char*>(data.data() + offset), length);
+        }
+        else if (std::strcmp(type, "IEND") == 0)
+        {
+            break;
+        }
+        else
+        {
+            file.seekg(length, std::ios::cur);
+        }
+        file.seekg(4, std::ios::cur);
+    }
+    return data;
+}
+
+// Filtered RGB scanlines of a texture like the ones scenes load, compressed as ExportPNG would
+Stream MakeTexture(const std::string& name, int size, int level, double noise, double frequency)
+{
+    int rowBytes = size * 3;
+    std::vector<unsigned char> pixels(static_cast<size_t>(rowBytes) * size);
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            double u = double(x) / size;
+            double v = double(y) / size;
+            double tile = (int(u * frequency) + int(v * frequency)) % 2 ? 0.7 : 0.4;
+            for (int c = 0; c < 3; c++)
+            {
+                double value = tile * (0.6 + 0.4 * std::sin(5 * u + 3 * v + c)) + noise * (rcl::RandomDouble01() - 0.5);
+                pixels[static_cast<size_t>(y) * rowBytes + x * 3 + c] = static_cast<unsigned char>(255 * std::clamp(value, 0.0, 1.0));
+            }
+        }
+    }
+
+    std::vector<unsigned char> filtered(static_cast<size_t>(rowBytes + 1) * size);
+    for (int y = 0; y < size; y++)
+    {
+        const unsigned char* row = pixels.data() + static_cast<size_t>(y) * rowBytes;
+        const unsigned char* previous = y > 0 ? row - rowBytes : nullptr;
+        unsigned char* out = filtered.data() + static_cast<size_t>(y) * (rowBytes + 1);
+        out[0] = rcl::filter_scanline_adaptive(out + 1, row, previous, 3, rowBytes);
+    }
+
+    return {name, rcl::zlib_compress(filtered.data(), filtered.size(), level)};
+}
+
+}
+
+// Usage: inflate_bench [file.png ...], without files it decodes a set of generated textures
+int main(int argc, char** argv)
+{
+    std::vector<Stream> streams;
+    for (int i = 1; i < argc; i++)
+    {
+        std::vector<unsigned char> data = ReadIDAT(argv[i]);
+        if (data.empty())
+            std::cerr << "Error: No image data in " << argv[i] << std::endl;
+        else
+            streams.push_back({argv[i], std::move(data)});
+    }
+    if (argc == 1)
+    {
+        streams.push_back(MakeTexture("albedo 2048 level 6", 2048, 6, 0.05, 16));
+        streams.push_back(MakeTexture("roughness 2048 level 9", 2048, 9, 0.0, 64));
+        streams.push_back(MakeTexture("noisy 2048 level 1", 2048, 1, 0.3, 4));
+        streams.push_back(MakeTexture("stored 1024 level 0", 1024, 0, 0.1, 8));
+    }
+
+    bool passed = true;
+    double totalBytes = 0, totalReference = 0, totalTable = 0;
+    for (const Stream& stream : streams)
+    {
+        std::vector<unsigned char> reference, decoded;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        bool referenceOk = rcl::full_inflate(stream.compressed, reference);
+        double referenceMs = Milliseconds(start);
+
+        start = std::chrono::high_resolution_clock::now();
+        bool tableOk = rcl::zlib_decompress(stream.compressed.data(), stream.compressed.size(), decoded, reference.size());
+        double tableMs = Milliseconds(start);
+
+        bool same = referenceOk && tableOk && reference == decoded;
+        passed = passed && same;
+        totalBytes += decoded.size();
+        totalReference += referenceMs;
+        totalTable += tableMs;
+
+        std::cout << stream.name << ": " << stream.compressed.size() / 1024 << " KB -> " << decoded.size() / 1024 << " KB, "
+                  << "tree " << referenceMs << " ms, tables " << tableMs << " ms ("
+                  << referenceMs / tableMs << "x)" << (same ? "" : ", OUTPUTS DIFFER") << std::endl;
+    }
+
+    if (totalTable > 0)
+        std::cout << "total: tree " << totalBytes / 1048576 / (totalReference / 1000) << " MB/s, tables "
+                  << totalBytes / 1048576 / (totalTable / 1000) << " MB/s" << std::endl;
+    std::cout << (passed ? "all passed" : "SOME FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
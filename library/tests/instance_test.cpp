@@ -0,0 +1,115 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "transform.hpp"
+#include "hittable_list.hpp"
+#include "quad.hpp"
+#include "sphere.hpp"
+#include "instance.hpp"
+#include "bvh.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+rcl::vec3 RandomPoint(const rcl::vec3& center, double extent)
+{
+    return center + rcl::vec3(rcl::RandomDoubleMinMax(-extent, extent), rcl::RandomDoubleMinMax(-extent, extent),
+                              rcl::RandomDoubleMinMax(-extent, extent));
+}
+
+// Rays from around the object towards points close to its surface, many of them hit, some graze it
+// or pass by. Both must agree on every ray, and on the distance, point and normal of every hit.
+bool SameHits(const rcl::Hittable& instance, const rcl::Hittable& world, double extent)
+{
+    int hits = 0;
+    bool same = true;
+    for (int i = 0; i < 20000; i++)
+    {
+        rcl::vec3 target = RandomPoint(world.RandomPointOnSurface(), 0.2 * extent);
+        rcl::vec3 origin = RandomPoint(target, 4 * extent);
+        rcl::Ray ray(origin, (target - origin).Unit());
+
+        rcl::HitRecord a, b;
+        bool hitInstance = instance.hit(ray, rcl::Interval<double>(0.001, rcl::infinity), a);
+        bool hitWorld = world.hit(ray, rcl::Interval<double>(0.001, rcl::infinity), b);
+        same &= hitInstance == hitWorld;
+        if (!hitInstance || !hitWorld)
+            continue;
+
+        hits++;
+        same &= std::fabs(a.distance - b.distance) < 1e-4 * std::max(1.0, b.distance);
+        same &= (a.point - b.point).Length() < 1e-4 * std::max(1.0, b.distance);
+        same &= rcl::Dot(a.normal, b.normal) > 1 - 1e-5 && std::fabs(a.normal.Length() - 1) < 1e-5;
+        same &= a.frontFace == b.frontFace;
+    }
+    return same && hits > 5000 && hits < 19000;
+}
+
+}
+
+// Usage: instance_test, checks hits through instances against the same primitives built in world space
+int main()
+{
+    bool passed = true;
+    rcl::SeedRandom(3);
+
+    rcl::vec3 offset(3, -1, 2);
+    rcl::Transform translate = rcl::Transform::Translate(offset);
+    rcl::Transform rotate = rcl::Transform::Rotate(rcl::vec3(1, 2, 0.5).Unit(), 37);
+    rcl::Transform stretch = rcl::Transform::Scale(rcl::vec3(2, 0.5, 3));
+    rcl::Transform uniform = rcl::Transform::Scale(rcl::vec3(1.5));
+
+    // A quad and a small BVH of quads, any affine transform maps them to quads
+    std::vector<rcl::vec3> corners = {rcl::vec3(-1, 0, -1), rcl::vec3(0.5, 0.2, -0.3), rcl::vec3(-0.2, -0.7, 0.4)};
+    rcl::vec3 edgeU(1.2, 0.1, 0), edgeV(0, 0.3, 0.9);
+
+    struct Case
+    {
+        const char* name;
+        rcl::Transform transform;
+    };
+    Case cases[] = {
+        {"translate", translate},
+        {"rotate", rotate},
+        {"non-uniform scale", stretch},
+        {"translate, rotate and non-uniform scale", translate * rotate * stretch}
+    };
+
+    for (const Case& test : cases)
+    {
+        const rcl::Transform& t = test.transform;
+
+        auto quad = std::make_shared<rcl::Quad>(corners[0], edgeU, edgeV, nullptr);
+        rcl::Instance quadInstance(quad, t);
+        rcl::Quad quadWorld(t.ApplyPoint(corners[0]), t.ApplyVector(edgeU), t.ApplyVector(edgeV), nullptr);
+        passed &= Check(SameHits(quadInstance, quadWorld, 1), std::string("quad, ") + test.name);
+
+        rcl::HittableList local, world;
+        for (const rcl::vec3& corner : corners)
+        {
+            local.Add(std::make_shared<rcl::Quad>(corner, edgeU, edgeV, nullptr));
+            world.Add(std::make_shared<rcl::Quad>(t.ApplyPoint(corner), t.ApplyVector(edgeU), t.ApplyVector(edgeV), nullptr));
+        }
+        rcl::Instance bvhInstance(std::make_shared<rcl::BVHNode>(local), t);
+        rcl::BVHNode bvhWorld(world);
+        passed &= Check(SameHits(bvhInstance, bvhWorld, 1), std::string("bvh, ") + test.name);
+    }
+
+    // Spheres stay spheres under rotation and uniform scale
+    {
+        rcl::Transform t = translate * rotate * uniform;
+        auto sphere = std::make_shared<rcl::Sphere>(rcl::vec3(0.5, 0, -0.5), 1.0, nullptr);
+        rcl::Instance sphereInstance(sphere, t);
+        rcl::Sphere sphereWorld(t.ApplyPoint(rcl::vec3(0.5, 0, -0.5)), 1.5, nullptr);
+        passed &= Check(SameHits(sphereInstance, sphereWorld, 1.5), "sphere, translate, rotate and uniform scale");
+    }
+
+    std::cout << (passed ? "All instance checks passed" : "Instance checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
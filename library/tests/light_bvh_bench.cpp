@@ -0,0 +1,179 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "constants.hpp"
+#include "hittable_list.hpp"
+#include "quad.hpp"
+#include "sphere.hpp"
+#include "materials.hpp"
+#include "light_bvh.hpp"
+
+namespace
+{
+
+struct Emitter
+{
+    std::shared_ptr<rcl::Hittable> object;
+    double radiance;
+};
+
+struct ShadingPoint
+{
+    rcl::vec3 point;
+    rcl::vec3 normal;
+};
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Small tilted quads and spheres scattered over a 40 x 40 room, brightness spread over two decades
+std::vector<Emitter> MakeLights(int count, rcl::HittableList& lights)
+{
+    std::vector<Emitter> emitters;
+    for (int i = 0; i < count; i++)
+    {
+        rcl::vec3 position(rcl::RandomDoubleMinMax(-20, 20), rcl::RandomDoubleMinMax(0.5, 6), rcl::RandomDoubleMinMax(-20, 20));
+        double radiance = std::pow(10.0, rcl::RandomDoubleMinMax(0, 2));
+        auto mat = std::make_shared<rcl::Light>(rcl::vec3(1), radiance);
+
+        std::shared_ptr<rcl::Hittable> object;
+        if (i % 4 == 3)
+        {
+            object = std::make_shared<rcl::Sphere>(position, 0.05, mat);
+        }
+        else
+        {
+            rcl::vec3 normal = rcl::Ray::RandomOnHemisphere(rcl::vec3(0, -1, 0));
+            rcl::vec3 helper = std::fabs(normal.x) > 0.9 ? rcl::vec3(0, 1, 0) : rcl::vec3(1, 0, 0);
+            rcl::vec3 u = rcl::Cross(normal, helper).Unit() * 0.1;
+            rcl::vec3 v = rcl::Cross(normal, u).Unit() * 0.1;
+            object = std::make_shared<rcl::Quad>(position, u, v, mat);
+        }
+
+        lights.Add(object);
+        emitters.push_back(Emitter{object, radiance});
+    }
+    return emitters;
+}
+
+// Unoccluded irradiance at the point from one uniform point on the light, divided by its density
+double Contribution(const Emitter& emitter, const ShadingPoint& shading)
+{
+    const rcl::Hittable& light = *emitter.object;
+    rcl::vec3 sample = light.RandomPointOnSurface();
+    rcl::vec3 toLight = sample - shading.point;
+    double distanceSquared = toLight.LengthSquared();
+    rcl::vec3 direction = toLight / std::sqrt(distanceSquared);
+
+    double cosSurface = rcl::Dot(shading.normal, direction);
+    if (cosSurface <= 0)
+        return 0;
+
+    double cosLight;
+    rcl::vec3 normal;
+    if (light.FaceNormal(normal))
+    {
+        cosLight = std::fabs(rcl::Dot(normal, direction));
+    }
+    else
+    {
+        // The far side of a sphere is hidden by the sphere itself
+        const rcl::AABB& box = light.BoundingBox();
+        rcl::vec3 center(0.5 * (box.x.min + box.x.max), 0.5 * (box.y.min + box.y.max), 0.5 * (box.z.min + box.z.max));
+        cosLight = -rcl::Dot((sample - center).Unit(), direction);
+        if (cosLight <= 0)
+            return 0;
+    }
+
+    return emitter.radiance * cosSurface * cosLight / distanceSquared * light.Area();
+}
+
+}
+
+// Usage: light_bvh_bench [light count], compares picking lights uniformly with the light hierarchy.
+// light_bvh_test checks its probabilities.
+int main(int argc, char** argv)
+{
+    int lightCount = argc > 1 ? std::atoi(argv[1]) : 4096;
+    const int pointCount = 200;
+    const int samplesPerPoint = 64;
+    const int referenceSamples = 16;
+
+    rcl::HittableList lights;
+    std::vector<Emitter> emitters = MakeLights(lightCount, lights);
+
+    std::vector<ShadingPoint> points;
+    for (int i = 0; i < pointCount; i++)
+    {
+        rcl::vec3 point(rcl::RandomDoubleMinMax(-20, 20), 0, rcl::RandomDoubleMinMax(-20, 20));
+        points.push_back(ShadingPoint{point, rcl::vec3(0, 1, 0)});
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    rcl::LightBVH hierarchy(lights);
+    double buildMs = Milliseconds(start);
+
+    bool passed = true;
+
+    // Reference from every light, then the squared error of one light sample per estimate
+    double uniformError = 0;
+    double hierarchyError = 0;
+    double uniformMean = 0;
+    double hierarchyMean = 0;
+    double referenceMean = 0;
+    for (const ShadingPoint& shading : points)
+    {
+        double reference = 0;
+        for (const Emitter& emitter : emitters)
+            for (int s = 0; s < referenceSamples; s++)
+                reference += Contribution(emitter, shading) / referenceSamples;
+        referenceMean += reference / pointCount;
+
+        for (int s = 0; s < samplesPerPoint; s++)
+        {
+            double uniform = Contribution(emitters[rcl::RandomIntMinMax(0, lightCount - 1)], shading) * lightCount;
+            uniformError += (uniform - reference) * (uniform - reference) / (reference * reference);
+            uniformMean += uniform / (pointCount * samplesPerPoint);
+
+            double picked = 0;
+            rcl::LightBVH::LightSample sample;
+            if (hierarchy.Pick(shading.point, shading.normal, sample))
+                picked = Contribution(emitters[sample.index], shading) / sample.probability;
+            hierarchyError += (picked - reference) * (picked - reference) / (reference * reference);
+            hierarchyMean += picked / (pointCount * samplesPerPoint);
+        }
+    }
+    uniformError = std::sqrt(uniformError / (pointCount * samplesPerPoint));
+    hierarchyError = std::sqrt(hierarchyError / (pointCount * samplesPerPoint));
+
+    // Both are unbiased, the hierarchy with far less noise
+    passed &= std::fabs(hierarchyMean - referenceMean) < 0.1 * referenceMean;
+    passed &= hierarchyError < uniformError;
+
+    const int pickCount = 1000000;
+    start = std::chrono::high_resolution_clock::now();
+    size_t checksum = 0;
+    for (int i = 0; i < pickCount; i++)
+    {
+        rcl::LightBVH::LightSample sample;
+        if (hierarchy.Pick(points[i % pointCount].point, points[i % pointCount].normal, sample))
+            checksum += sample.index;
+    }
+    double pickMs = Milliseconds(start);
+
+    std::cout << lightCount << " lights, " << hierarchy.NodeCount() << " nodes, built in " << buildMs << " ms" << std::endl;
+    std::cout << "mean irradiance: reference " << referenceMean << ", uniform " << uniformMean << ", hierarchy " << hierarchyMean << std::endl;
+    std::cout << "relative rms error of one sample: uniform " << uniformError << ", hierarchy " << hierarchyError << std::endl;
+    std::cout << "pick: " << pickMs * 1e6 / pickCount << " ns (checksum " << checksum % 1000 << ")" << std::endl;
+    std::cout << (passed ? "all passed" : "SOME FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "hittable_list.hpp"
+#include "quad.hpp"
+#include "sphere.hpp"
+#include "materials.hpp"
+#include "light_bvh.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+std::shared_ptr<rcl::Hittable> MakeQuad(const rcl::vec3& position, double intensity)
+{
+    auto mat = std::make_shared<rcl::Light>(rcl::vec3(1), intensity);
+    return std::make_shared<rcl::Quad>(position, rcl::vec3(0.2, 0, 0), rcl::vec3(0, 0, 0.2), mat);
+}
+
+// At every point the probabilities of all lights sum to one, and every pick reports the probability
+// Probability gives its light, by index and by pointer
+bool Consistent(const rcl::LightBVH& hierarchy, const rcl::HittableList& lights, const std::vector<rcl::vec3>& points)
+{
+    bool consistent = true;
+    for (const rcl::vec3& point : points)
+    {
+        rcl::vec3 normal(0, 1, 0);
+        double sum = 0;
+        for (size_t light = 0; light < lights.objects.size(); light++)
+            sum += hierarchy.Probability(point, normal, light);
+        consistent &= std::fabs(sum - 1) < 1e-9;
+
+        for (int s = 0; s < 64; s++)
+        {
+            rcl::LightBVH::LightSample sample;
+            if (!hierarchy.Pick(point, normal, (s + 0.5) / 64, sample))
+            {
+                consistent = false;
+                continue;
+            }
+            consistent &= sample.light == lights.objects[sample.index].get() && sample.probability > 0;
+            consistent &= std::fabs(hierarchy.Probability(point, normal, sample.index) - sample.probability) < 1e-12 * sample.probability + 1e-15;
+            consistent &= std::fabs(hierarchy.Probability(point, normal, sample.light) - sample.probability) < 1e-12 * sample.probability + 1e-15;
+        }
+    }
+    return consistent;
+}
+
+}
+
+// Usage: light_bvh_test, checks the light hierarchy's probabilities on regular and degenerate light lists
+int main()
+{
+    bool passed = true;
+    rcl::SeedRandom(5);
+
+    std::vector<rcl::vec3> points;
+    for (int i = 0; i < 16; i++)
+        points.push_back(rcl::vec3(rcl::RandomDoubleMinMax(-10, 10), 0, rcl::RandomDoubleMinMax(-10, 10)));
+
+    // Quads and spheres spread over a room
+    {
+        rcl::HittableList lights;
+        for (int i = 0; i < 200; i++)
+        {
+            rcl::vec3 position(rcl::RandomDoubleMinMax(-10, 10), rcl::RandomDoubleMinMax(1, 5), rcl::RandomDoubleMinMax(-10, 10));
+            double intensity = std::pow(10.0, rcl::RandomDoubleMinMax(0, 2));
+            if (i % 4 == 3)
+                lights.Add(std::make_shared<rcl::Sphere>(position, 0.1, std::make_shared<rcl::Light>(rcl::vec3(1), intensity)));
+            else
+                lights.Add(MakeQuad(position, intensity));
+        }
+        rcl::LightBVH hierarchy(lights);
+        passed &= Check(hierarchy.Size() == 200, "every light in the hierarchy");
+        passed &= Check(Consistent(hierarchy, lights, points), "scattered lights");
+
+        // Picks land as often as their probability says
+        std::vector<int> counts(lights.objects.size(), 0);
+        const int pickCount = 200000;
+        for (int i = 0; i < pickCount; i++)
+        {
+            rcl::LightBVH::LightSample sample;
+            if (hierarchy.Pick(points[0], rcl::vec3(0, 1, 0), sample))
+                counts[sample.index]++;
+        }
+        double worst = 0;
+        for (size_t light = 0; light < counts.size(); light++)
+        {
+            double probability = hierarchy.Probability(points[0], rcl::vec3(0, 1, 0), light);
+            double deviation = std::sqrt(probability * (1 - probability) / pickCount);
+            worst = std::max(worst, std::fabs(double(counts[light]) / pickCount - probability) / std::max(deviation, 1e-12));
+        }
+        passed &= Check(worst < 5, "pick frequencies");
+    }
+
+    // A single light is always the one
+    {
+        rcl::HittableList lights;
+        lights.Add(MakeQuad(rcl::vec3(0, 3, 0), 5));
+        rcl::LightBVH hierarchy(lights);
+        passed &= Check(hierarchy.Size() == 1, "one light");
+        passed &= Check(Consistent(hierarchy, lights, points), "one light, consistent");
+        passed &= Check(hierarchy.Probability(points[3], rcl::vec3(0, 1, 0), size_t(0)) == 1, "one light, certain");
+    }
+
+    // Lights on top of one another, no split separates them and each goes by its power
+    {
+        rcl::HittableList lights;
+        for (int i = 0; i < 9; i++)
+            lights.Add(MakeQuad(rcl::vec3(1, 4, -2), 1 + i % 3));
+        rcl::LightBVH hierarchy(lights);
+        passed &= Check(hierarchy.Size() == 9, "coincident lights");
+        passed &= Check(Consistent(hierarchy, lights, points), "coincident lights, consistent");
+        double ratio = hierarchy.Probability(points[0], rcl::vec3(0, 1, 0), size_t(2)) / hierarchy.Probability(points[0], rcl::vec3(0, 1, 0), size_t(0));
+        passed &= Check(std::fabs(ratio - 3) < 1e-9, "coincident lights, by power");
+    }
+
+    // Lights without power or material are never picked, and without any there is nothing to pick
+    {
+        rcl::HittableList lights;
+        lights.Add(MakeQuad(rcl::vec3(0, 3, 0), 0));
+        lights.Add(MakeQuad(rcl::vec3(2, 3, 0), 4));
+        lights.Add(std::make_shared<rcl::Quad>(rcl::vec3(-2, 3, 0), rcl::vec3(0.2, 0, 0), rcl::vec3(0, 0, 0.2), nullptr));
+        lights.Add(MakeQuad(rcl::vec3(4, 3, 0), 0));
+        rcl::LightBVH hierarchy(lights);
+        passed &= Check(hierarchy.Size() == 1, "powerless lights left out");
+        passed &= Check(Consistent(hierarchy, lights, points), "powerless lights, consistent");
+        bool never = true;
+        for (const rcl::vec3& point : points)
+            for (size_t light : {size_t(0), size_t(2), size_t(3)})
+                never &= hierarchy.Probability(point, rcl::vec3(0, 1, 0), light) == 0;
+        passed &= Check(never, "powerless lights never picked");
+
+        rcl::HittableList dark;
+        dark.Add(MakeQuad(rcl::vec3(0, 3, 0), 0));
+        dark.Add(MakeQuad(rcl::vec3(1, 3, 0), 0));
+        rcl::LightBVH none(dark);
+        rcl::LightBVH::LightSample sample;
+        passed &= Check(none.Empty() && !none.Pick(points[0], rcl::vec3(0, 1, 0), 0.5, sample), "only powerless lights");
+        passed &= Check(none.Probability(points[0], rcl::vec3(0, 1, 0), size_t(0)) == 0, "only powerless lights, probability");
+    }
+
+    std::cout << (passed ? "All light hierarchy checks passed" : "Light hierarchy checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
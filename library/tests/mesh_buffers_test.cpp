@@ -0,0 +1,224 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <cstdio>
+#include <cmath>
+
+#include "vector.hpp"
+#include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
+#include "model_workers.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+// A grid of SIZE by SIZE quads over (SIZE + 1)^2 shared corners, every attribute exactly representable
+const int SIZE = 8;
+const int CORNERS = (SIZE + 1) * (SIZE + 1);
+
+rcl::vec3 Position(int corner)
+{
+    int i = corner % (SIZE + 1), j = corner / (SIZE + 1);
+    return rcl::vec3(i * 0.25f, (i * j % 3) * 0.125f, j * 0.25f);
+}
+
+rcl::vec3 Normal(int corner)
+{
+    const rcl::vec3 normals[4] = {rcl::vec3(0, 1, 0), rcl::vec3(1, 0, 0), rcl::vec3(0, 0, 1), rcl::vec3(0, -1, 0)};
+    return normals[corner % 4];
+}
+
+rcl::vec2 UV(int corner, bool flipped)
+{
+    float u = float(corner % (SIZE + 1)) / SIZE, v = float(corner / (SIZE + 1)) / SIZE;
+    return flipped ? rcl::vec2(1 - u, v) : rcl::vec2(u, v);
+}
+
+// The grid twice over the same positions and normals, the second time with mirrored texture
+// coordinates, as along a seam. Each corner is a vertex once per copy.
+std::string MakeObj(std::vector<int>& expectedCorners)
+{
+    std::ostringstream obj;
+    for (int corner = 0; corner < CORNERS; corner++)
+    {
+        rcl::vec3 p = Position(corner), n = Normal(corner);
+        rcl::vec2 a = UV(corner, false), b = UV(corner, true);
+        obj << "v " << p.x << " " << p.y << " " << p.z << "\n";
+        obj << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+        obj << "vt " << a.x << " " << a.y << "\n";
+        obj << "vt " << b.x << " " << b.y << "\n";
+    }
+    for (int copy = 0; copy < 2; copy++)
+        for (int j = 0; j < SIZE; j++)
+            for (int i = 0; i < SIZE; i++)
+            {
+                int quad[4] = {j * (SIZE + 1) + i, j * (SIZE + 1) + i + 1, (j + 1) * (SIZE + 1) + i + 1, (j + 1) * (SIZE + 1) + i};
+                obj << "f";
+                for (int corner : quad)
+                    obj << " " << corner + 1 << "/" << 2 * corner + 1 + copy << "/" << corner + 1;
+                obj << "\n";
+
+                // Fanned from the first corner, the copy is recorded in the sign
+                for (int k : {0, 1, 2, 0, 2, 3})
+                    expectedCorners.push_back(copy == 0 ? quad[k] : -1 - quad[k]);
+            }
+    return obj.str();
+}
+
+bool Same(const rcl::vec3& a, const rcl::vec3& b)
+{
+    return a.x == b.x && a.y == b.y && a.z == b.z;
+}
+
+bool SameBuffers(const rcl::MeshBuffers& a, const rcl::MeshBuffers& b)
+{
+    if (a.positions.size() != b.positions.size() || a.normals.size() != b.normals.size() ||
+        a.uvs.size() != b.uvs.size() || a.indices != b.indices)
+        return false;
+    for (size_t i = 0; i < a.positions.size(); i++)
+        if (!Same(a.positions[i], b.positions[i]))
+            return false;
+    for (size_t i = 0; i < a.normals.size(); i++)
+        if (!Same(a.normals[i], b.normals[i]))
+            return false;
+    for (size_t i = 0; i < a.uvs.size(); i++)
+        if (a.uvs[i].x != b.uvs[i].x || a.uvs[i].y != b.uvs[i].y)
+            return false;
+    return true;
+}
+
+// Every triangle as the attributes of its corners in order, sorted, so meshes compare whatever
+// order their triangles and vertices are in
+std::vector<std::vector<float>> Triangles(const rcl::MeshBuffers& buffers)
+{
+    std::vector<std::vector<float>> triangles;
+    for (size_t triangle = 0; triangle < buffers.TriangleCount(); triangle++)
+    {
+        std::vector<float> corners;
+        for (int i = 0; i < 3; i++)
+        {
+            uint32_t index = buffers.indices[triangle * 3 + i];
+            const rcl::vec3& p = buffers.positions[index];
+            corners.insert(corners.end(), {p.x, p.y, p.z});
+            if (!buffers.normals.empty())
+                corners.insert(corners.end(), {buffers.normals[index].x, buffers.normals[index].y, buffers.normals[index].z});
+            if (!buffers.uvs.empty())
+                corners.insert(corners.end(), {buffers.uvs[index].x, buffers.uvs[index].y});
+        }
+        triangles.push_back(corners);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+}
+
+// Usage: mesh_buffers_test, checks OBJ vertex deduplication, .rclmesh round trips and reordering
+int main()
+{
+    const char* objPath = "mesh_buffers_test.obj";
+    const char* meshPath = "mesh_buffers_test.rclmesh";
+    bool passed = true;
+
+    std::vector<int> expectedCorners;
+    {
+        std::ofstream file(objPath, std::ios::binary);
+        file << MakeObj(expectedCorners);
+    }
+
+    // Shared corners become one vertex per distinct v/vt/vn triple, and every triangle reads the
+    // attributes its face named
+    rcl::MeshBuffers buffers;
+    rcl::ImportOBJ(objPath, buffers);
+    size_t triangleCount = 2 * 2 * SIZE * SIZE;
+    passed &= Check(buffers.TriangleCount() == triangleCount, "every face triangulated");
+    passed &= Check(buffers.positions.size() == 2 * CORNERS && buffers.normals.size() == 2 * CORNERS &&
+                    buffers.uvs.size() == 2 * CORNERS, "one vertex per distinct corner");
+    passed &= Check(buffers.positions.size() < buffers.indices.size() / 2, "fewer vertices than corners");
+
+    bool corners = buffers.indices.size() == expectedCorners.size();
+    for (size_t i = 0; corners && i < buffers.indices.size(); i++)
+    {
+        uint32_t index = buffers.indices[i];
+        int corner = expectedCorners[i] < 0 ? -1 - expectedCorners[i] : expectedCorners[i];
+        rcl::vec2 uv = UV(corner, expectedCorners[i] < 0);
+        corners &= index < buffers.positions.size() && Same(buffers.positions[index], Position(corner)) &&
+                   Same(buffers.normals[index], Normal(corner)) && buffers.uvs[index].x == uv.x && buffers.uvs[index].y == uv.y;
+    }
+    passed &= Check(corners, "indexed corners match the faces");
+
+    // The same triangles the non-indexed import builds
+    {
+        rcl::HittableList direct, rebuilt;
+        rcl::ImportOBJ(objPath, direct);
+        rcl::BuildTriangles(buffers, rebuilt);
+        rcl::AABB a = direct.BoundingBox(), b = rebuilt.BoundingBox();
+        passed &= Check(direct.objects.size() == triangleCount && rebuilt.objects.size() == triangleCount &&
+                        a.x.min == b.x.min && a.x.max == b.x.max && a.y.min == b.y.min && a.y.max == b.y.max &&
+                        a.z.min == b.z.min && a.z.max == b.z.max &&
+                        std::fabs(direct.Area() - rebuilt.Area()) < 1e-9 * direct.Area(), "same triangles as without indices");
+    }
+
+    // Reordering moves triangles and vertices but keeps every triangle and its winding
+    {
+        rcl::MeshBuffers reordered = buffers;
+        rcl::ReorderForLocality(reordered);
+        passed &= Check(reordered.positions.size() == buffers.positions.size() && Triangles(reordered) == Triangles(buffers),
+                        "reordering keeps the triangles");
+    }
+
+    // Written and read back bit for bit, with and without the optional attributes
+    {
+        rcl::MeshBuffers positionsOnly = buffers;
+        positionsOnly.normals.clear();
+        positionsOnly.uvs.clear();
+        rcl::MeshBuffers withNormals = buffers;
+        withNormals.uvs.clear();
+
+        bool roundTrips = true;
+        for (const rcl::MeshBuffers* mesh : {&buffers, &positionsOnly, &withNormals})
+        {
+            rcl::MeshBuffers read;
+            roundTrips &= rcl::ExportRCLMesh(meshPath, *mesh);
+            rcl::ImportRCLMesh(meshPath, read);
+            roundTrips &= SameBuffers(*mesh, read);
+        }
+        passed &= Check(roundTrips, ".rclmesh round trip");
+
+        rcl::MeshBuffers mismatched = buffers;
+        mismatched.uvs.pop_back();
+        passed &= Check(!rcl::ExportRCLMesh(meshPath, mismatched), "attribute arrays of different lengths not written");
+    }
+
+    // A file cut short reads as nothing
+    {
+        rcl::ExportRCLMesh(meshPath, buffers);
+        std::string whole;
+        {
+            std::ifstream file(meshPath, std::ios::binary);
+            whole.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        }
+        bool rejected = true;
+        for (size_t length : {size_t(0), size_t(7), whole.size() / 2, whole.size() - 1})
+        {
+            {
+                std::ofstream file(meshPath, std::ios::binary);
+                file << whole.substr(0, length);
+            }
+            rcl::MeshBuffers read = buffers;
+            rcl::ImportRCLMesh(meshPath, read);
+            rejected &= read.positions.empty() && read.indices.empty();
+        }
+        passed &= Check(rejected, "truncated .rclmesh");
+    }
+
+    std::remove(objPath);
+    std::remove(meshPath);
+    std::cout << (passed ? "All mesh buffer checks passed" : "Mesh buffer checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
+#include "model_workers.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+// Strips of quads and triangles with every face form: v, v/vt, v//vn and v/vt/vn, positive and
+// negative indices, and attributes declared between the faces that use them. Comments, groups and
+// blank lines in between, lines end in newline, or carriage return and newline when crlf is set.
+std::string MakeObj(int strips, bool crlf)
+{
+    const char* end = crlf ? "\r\n" : "\n";
+    std::ostringstream obj;
+    obj.precision(9);
+    int positions = 0;
+    for (int strip = 0; strip < strips; strip++)
+    {
+        obj << "# strip " << strip << end << "g strip" << strip << end;
+        for (int i = 0; i < 8; i++)
+        {
+            obj << "v " << i * 0.125 << " " << 0.01 * rcl::RandomDouble01() << " " << strip * 0.5 << end;
+            obj << "v " << i * 0.125 << " " << 0.01 * rcl::RandomDouble01() << " " << strip * 0.5 + 0.5 << end;
+            obj << "vt " << i / 7.0 << " " << strip % 2 << end << "vt " << i / 7.0 << " " << 1 - strip % 2 << end;
+            obj << "vn 0 1 " << 0.01 * i << end << "vn 0 1 " << -0.01 * i << end;
+        }
+        if (strip % 5 == 0)
+            obj << end;
+
+        for (int i = 0; i < 7; i++)
+        {
+            int a = positions + 2 * i + 1, b = a + 1, c = a + 2, d = a + 3;
+            switch ((strip + i) % 4)
+            {
+                case 0: obj << "f " << a << " " << c << " " << d << " " << b << end; break;
+                case 1: obj << "f " << a << "/" << a << " " << c << "/" << c << " " << d << "/" << d << end
+                            << "f " << a << "/" << a << " " << d << "/" << d << " " << b << "/" << b << end; break;
+                case 2: obj << "f " << a << "//" << a << " " << c << "//" << c << " " << d << "//" << d << " " << b << "//" << b << end; break;
+                default:
+                    // Negative indices count back from the last vertex declared so far
+                    int last = positions + 16;
+                    obj << "f " << a - last - 1 << "/" << a - last - 1 << "/" << a - last - 1 << " "
+                        << c - last - 1 << "/" << c - last - 1 << "/" << c - last - 1 << " "
+                        << d - last - 1 << "/" << d - last - 1 << "/" << d - last - 1 << " "
+                        << b - last - 1 << "/" << b - last - 1 << "/" << b - last - 1 << end;
+            }
+        }
+        positions += 16;
+    }
+    return obj.str();
+}
+
+bool SameBuffers(const rcl::MeshBuffers& a, const rcl::MeshBuffers& b)
+{
+    if (a.positions.size() != b.positions.size() || a.normals.size() != b.normals.size() ||
+        a.uvs.size() != b.uvs.size() || a.indices != b.indices)
+        return false;
+    for (size_t i = 0; i < a.positions.size(); i++)
+        if (a.positions[i].x != b.positions[i].x || a.positions[i].y != b.positions[i].y || a.positions[i].z != b.positions[i].z)
+            return false;
+    for (size_t i = 0; i < a.normals.size(); i++)
+        if (a.normals[i].x != b.normals[i].x || a.normals[i].y != b.normals[i].y || a.normals[i].z != b.normals[i].z)
+            return false;
+    for (size_t i = 0; i < a.uvs.size(); i++)
+        if (a.uvs[i].x != b.uvs[i].x || a.uvs[i].y != b.uvs[i].y)
+            return false;
+    return true;
+}
+
+bool SameBox(const rcl::AABB& a, const rcl::AABB& b)
+{
+    return a.x.min == b.x.min && a.x.max == b.x.max && a.y.min == b.y.min &&
+           a.y.max == b.y.max && a.z.min == b.z.min && a.z.max == b.z.max;
+}
+
+}
+
+// Usage: obj_import_test, parses the same OBJ files in one chunk and in many and compares the results
+int main()
+{
+    const char* path = "obj_import_test.obj";
+    bool passed = true;
+    rcl::SeedRandom(17);
+
+    for (bool crlf : {false, true})
+    {
+        std::string text = MakeObj(40, crlf);
+        {
+            std::ofstream file(path, std::ios::binary);
+            file << text;
+        }
+
+        rcl::MeshBuffers serial;
+        rcl::ImportOBJ(path, serial, 1);
+        rcl::HittableList serialTriangles;
+        rcl::ImportOBJ(path, serialTriangles, 1);
+        std::string ending = crlf ? ", crlf" : ", lf";
+        // 40 strips of 7 quads, two triangles each
+        passed &= Check(serial.TriangleCount() == 40 * 7 * 2 && serialTriangles.objects.size() == 40 * 7 * 2, "serial parse" + ending);
+        passed &= Check(serial.normals.size() == serial.positions.size() && serial.uvs.size() == serial.positions.size(), "attributes" + ending);
+
+        // Chunk counts that put the nominal splits inside lines, between \r and \n, and more chunks than lines
+        bool same = true;
+        for (size_t chunks : {size_t(2), size_t(3), size_t(7), size_t(16), size_t(61), size_t(500), size_t(5000)})
+        {
+            rcl::MeshBuffers parallel;
+            rcl::ImportOBJ(path, parallel, chunks);
+            rcl::HittableList parallelTriangles;
+            rcl::ImportOBJ(path, parallelTriangles, chunks);
+            bool match = SameBuffers(serial, parallel) && parallelTriangles.objects.size() == serialTriangles.objects.size() &&
+                         SameBox(parallelTriangles.BoundingBox(), serialTriangles.BoundingBox()) &&
+                         std::fabs(parallelTriangles.Area() - serialTriangles.Area()) < 1e-9 * serialTriangles.Area();
+            if (!match)
+                std::cout << chunks << " chunks differ from one" << std::endl;
+            same &= match;
+        }
+        passed &= Check(same, "parallel parse matches serial" + ending);
+    }
+
+    // Line endings do not change what is read
+    {
+        rcl::SeedRandom(23);
+        std::string lf = MakeObj(10, false);
+        rcl::SeedRandom(23);
+        std::string crlf = MakeObj(10, true);
+        rcl::MeshBuffers a, b;
+        { std::ofstream file(path, std::ios::binary); file << lf; }
+        rcl::ImportOBJ(path, a, 3);
+        { std::ofstream file(path, std::ios::binary); file << crlf; }
+        rcl::ImportOBJ(path, b, 4);
+        passed &= Check(SameBuffers(a, b) && a.TriangleCount() == 10 * 7 * 2, "crlf and lf alike");
+    }
+
+    std::remove(path);
+    std::cout << (passed ? "All OBJ import checks passed" : "OBJ import checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
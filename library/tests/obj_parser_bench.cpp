@@ -0,0 +1,143 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+#include "vector.hpp"
+#include "hittable_list.hpp"
+#include "vertex_triangle.hpp"
+#include "model_workers.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Wavy grid with positions, uvs and normals, faces use the v/vt/vn form
+void WriteGrid(const char* path, int size)
+{
+    std::ofstream file(path);
+    file.precision(7);
+
+    for (int row = 0; row <= size; row++)
+        for (int col = 0; col <= size; col++)
+            file << "v " << col * 0.01 << " " << 0.1 * std::sin(row * 0.05) * std::cos(col * 0.05) << " " << row * 0.01 << "\n";
+
+    for (int row = 0; row <= size; row++)
+        for (int col = 0; col <= size; col++)
+            file << "vt " << double(col) / size << " " << double(row) / size << "\n";
+
+    for (int row = 0; row <= size; row++)
+        for (int col = 0; col <= size; col++)
+            file << "vn 0 1 0\n";
+
+    for (int row = 0; row < size; row++)
+    {
+        for (int col = 0; col < size; col++)
+        {
+            int a = row * (size + 1) + col + 1;
+            int b = a + 1;
+            int c = a + size + 1;
+            int d = c + 1;
+            file << "f " << a << "/" << a << "/" << a << " " << b << "/" << b << "/" << b << " " << d << "/" << d << "/" << d << "\n";
+            file << "f " << a << "/" << a << "/" << a << " " << d << "/" << d << "/" << d << " " << c << "/" << c << "/" << c << "\n";
+        }
+    }
+}
+
+// The previous loader's approach: getline, then substr and stod/stoi for every token
+void ImportOBJReference(const char* path, rcl::HittableList& triangles)
+{
+    std::ifstream file(path);
+    std::string line;
+
+    std::vector<rcl::vec3> positions;
+    std::vector<rcl::vec2> uvs;
+    std::vector<rcl::vec3> normals;
+
+    while (std::getline(file, line))
+    {
+        if (line.find("v ") == 0 || line.find("vn ") == 0)
+        {
+            std::string str = line.substr(line.find(" ") + 1);
+            size_t space = str.find(" ");
+            float x = std::stod(str.substr(0, space));
+            str = str.substr(space + 1);
+            space = str.find(" ");
+            float y = std::stod(str.substr(0, space));
+            float z = std::stod(str.substr(space + 1));
+            (line[1] == 'n' ? normals : positions).push_back(rcl::vec3(x, y, z));
+        }
+        else if (line.find("vt ") == 0)
+        {
+            std::string str = line.substr(3);
+            size_t space = str.find(" ");
+            uvs.push_back(rcl::vec2(std::stod(str.substr(0, space)), std::stod(str.substr(space + 1))));
+        }
+        else if (line.find("f ") == 0)
+        {
+            std::string str = line.substr(2);
+            rcl::Vertex corners[3];
+            for (int i = 0; i < 3; i++)
+            {
+                size_t slash = str.find("/");
+                corners[i].coord = positions[std::stoi(str.substr(0, slash)) - 1];
+                str = str.substr(slash + 1);
+                slash = str.find("/");
+                corners[i].uv = uvs[std::stoi(str.substr(0, slash)) - 1];
+                str = str.substr(slash + 1);
+                size_t space = str.find(" ");
+                corners[i].normal = normals[std::stoi(str.substr(0, space)) - 1];
+                if (space != std::string::npos)
+                    str = str.substr(space + 1);
+            }
+            triangles.Add(std::make_shared<rcl::VertexTriangle>(corners[0], corners[1], corners[2]));
+        }
+    }
+}
+
+}
+
+// Usage: obj_parser_bench [grid size], a size of 2000 writes a file of roughly 500 MB
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 400;
+    const char* path = "obj_parser_bench.obj";
+
+    WriteGrid(path, size);
+
+    std::ifstream written(path, std::ios::binary | std::ios::ate);
+    std::cout << "file: " << path << " " << written.tellg() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    rcl::HittableList reference;
+    auto start = std::chrono::high_resolution_clock::now();
+    ImportOBJReference(path, reference);
+    double referenceMs = Milliseconds(start);
+
+    rcl::HittableList parsed;
+    start = std::chrono::high_resolution_clock::now();
+    rcl::ImportOBJ(path, parsed);
+    double parsedMs = Milliseconds(start);
+
+    std::cout << "reference: " << referenceMs << " ms, " << reference.objects.size() << " triangles" << std::endl;
+    std::cout << "mapped:    " << parsedMs << " ms, " << parsed.objects.size() << " triangles" << std::endl;
+    std::cout << "speed-up:  " << referenceMs / parsedMs << "x" << std::endl;
+
+    const rcl::AABB& a = reference.BoundingBox();
+    const rcl::AABB& b = parsed.BoundingBox();
+    bool same = reference.objects.size() == parsed.objects.size() &&
+                a.x.min == b.x.min && a.x.max == b.x.max && a.y.min == b.y.min &&
+                a.y.max == b.y.max && a.z.min == b.z.min && a.z.max == b.z.max;
+    std::cout << (same ? "results match" : "RESULTS DIFFER") << std::endl;
+
+    std::remove(path);
+    return same ? 0 : 1;
+}
\ No newline at end of file
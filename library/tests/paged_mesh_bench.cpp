@@ -0,0 +1,147 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "constants.hpp"
+#include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
+#include "paged_mesh.hpp"
+#include "bvh.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Wavy grid with normals and uvs, size x size quads
+void MakeGrid(rcl::MeshBuffers& buffers, int size)
+{
+    for (int row = 0; row <= size; row++)
+    {
+        for (int col = 0; col <= size; col++)
+        {
+            buffers.positions.push_back(rcl::vec3(col * 0.01, 0.1 * std::sin(row * 0.05) * std::cos(col * 0.05), row * 0.01));
+            buffers.normals.push_back(rcl::vec3(0, 1, 0));
+            buffers.uvs.push_back(rcl::vec2(double(col) / size, double(row) / size));
+        }
+    }
+
+    for (int row = 0; row < size; row++)
+    {
+        for (int col = 0; col < size; col++)
+        {
+            uint32_t a = row * (size + 1) + col;
+            uint32_t b = a + 1;
+            uint32_t c = a + size + 1;
+            uint32_t d = c + 1;
+            buffers.indices.insert(buffers.indices.end(), {a, b, d, a, d, c});
+        }
+    }
+}
+
+}
+
+// Usage: paged_mesh_bench [grid size] [triangles per cluster], renders the grid from a paged file with shrinking cache budgets
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 500;
+    uint32_t trianglesPerCluster = argc > 2 ? std::atoi(argv[2]) : 64;
+    const int rayCount = 200000;
+    const char* path = "paged_mesh_bench.rclpage";
+
+    auto buffers = std::make_shared<rcl::MeshBuffers>();
+    MakeGrid(*buffers, size);
+    rcl::ReorderForLocality(*buffers);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    rcl::WritePagedMesh(path, *buffers, trianglesPerCluster);
+    double writeMs = Milliseconds(start);
+
+    std::ifstream written(path, std::ios::binary | std::ios::ate);
+    std::cout << "written in " << writeMs << " ms, " << buffers->TriangleCount() << " triangles, "
+              << written.tellg() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+    rcl::HittableList triangles;
+    rcl::BuildIndexedTriangles(buffers, triangles);
+    rcl::BVHNode inCore(triangles);
+
+    double extent = size * 0.01;
+    std::vector<rcl::Ray> rays;
+    for (int i = 0; i < rayCount; i++)
+    {
+        rcl::vec3 origin(rcl::RandomDoubleMinMax(0, extent), 1, rcl::RandomDoubleMinMax(0, extent));
+        rays.push_back(rcl::Ray(origin, rcl::vec3(rcl::RandomDoubleMinMax(-0.3, 0.3), -1, rcl::RandomDoubleMinMax(-0.3, 0.3))));
+    }
+
+    std::vector<double> reference(rays.size(), -1);
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        rcl::HitRecord record;
+        if (inCore.hit(rays[i], rcl::Interval<double>(0.001, rcl::infinity), record))
+            reference[i] = record.distance;
+    }
+    std::cout << "in core: " << Milliseconds(start) << " ms" << std::endl;
+
+    bool same = true;
+    size_t budgets[] = {size_t(256) << 20, size_t(16) << 20, size_t(1) << 20, size_t(64) << 10};
+    for (size_t budget : budgets)
+    {
+        rcl::PagedMesh paged(path, nullptr, budget);
+
+        size_t mismatches = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            rcl::HitRecord record;
+            double distance = paged.hit(rays[i], rcl::Interval<double>(0.001, rcl::infinity), record) ? record.distance : -1;
+            // Positions are snapped to a grid, allow for that
+            if ((distance < 0) != (reference[i] < 0) || std::fabs(distance - reference[i]) > 1e-4)
+                mismatches++;
+        }
+        double pagedMs = Milliseconds(start);
+
+        rcl::PagedMesh::CacheStats stats = paged.GetCacheStats();
+        std::cout << "paged, budget " << budget / 1024 << " KB: " << pagedMs << " ms"
+                  << " | clusters:" << paged.ClusterCount() << " hits:" << stats.hits << " misses:" << stats.misses
+                  << " evictions:" << stats.evictions << " resident:" << stats.residentBytes / 1024 << " KB"
+                  << (mismatches ? " HITS DIFFER: " + std::to_string(mismatches) : "") << std::endl;
+        same = same && mismatches == 0;
+    }
+
+    // Two meshes every ray tests in turn, as rays crossing a scene of many meshes do. The threads'
+    // front caches keep both meshes' clusters, the shared caches are only asked on front misses.
+    {
+        rcl::PagedMesh first(path, nullptr), second(path, nullptr);
+        size_t mismatches = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < rays.size(); i++)
+        {
+            for (const rcl::PagedMesh* paged : {&first, &second})
+            {
+                rcl::HitRecord record;
+                double distance = paged->hit(rays[i], rcl::Interval<double>(0.001, rcl::infinity), record) ? record.distance : -1;
+                if ((distance < 0) != (reference[i] < 0) || std::fabs(distance - reference[i]) > 1e-4)
+                    mismatches++;
+            }
+        }
+        std::cout << "two meshes in turn: " << Milliseconds(start) << " ms"
+                  << (mismatches ? " HITS DIFFER: " + std::to_string(mismatches) : "") << std::endl;
+        same = same && mismatches == 0;
+    }
+
+    std::remove(path);
+    return same ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "photon_map.hpp"
+
+namespace
+{
+
+std::vector<rcl::Photon> RandomPhotons(size_t count)
+{
+    std::vector<rcl::Photon> photons;
+    photons.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        rcl::vec3 position(rcl::RandomDouble01(), rcl::RandomDouble01(), rcl::RandomDouble01());
+        photons.push_back(rcl::Photon(position, rcl::vec3(1), rcl::vec3(0, -1, 0), i % 4 == 0, 1));
+    }
+    return photons;
+}
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+struct BenchResult
+{
+    double buildMs;
+    double queryMs;
+    size_t found;
+};
+
+BenchResult Run(rcl::PhotonMapBackend backend, const std::vector<rcl::Photon>& source,
+                const std::vector<rcl::vec3>& queries, double radius)
+{
+    rcl::PhotonMap map;
+    map.SetBackend(backend, radius);
+
+    std::vector<rcl::Photon> photons = source;
+
+    BenchResult bench;
+    auto start = std::chrono::high_resolution_clock::now();
+    map.Build(photons);
+    bench.buildMs = Milliseconds(start);
+
+    std::vector<const rcl::Photon*> result;
+    bench.found = 0;
+    start = std::chrono::high_resolution_clock::now();
+    for (const rcl::vec3& query : queries)
+    {
+        map.FindNearestPhotons(query, radius, result);
+        bench.found += result.size();
+    }
+    bench.queryMs = Milliseconds(start);
+
+    return bench;
+}
+
+}
+
+int main()
+{
+    const size_t photonCounts[] = {10000, 100000, 1000000};
+    const double radii[] = {0.01, 0.025, 0.05};
+    const size_t queryCount = 20000;
+
+    std::vector<rcl::vec3> queries;
+    for (size_t i = 0; i < queryCount; i++)
+        queries.push_back(rcl::vec3(rcl::RandomDouble01(), rcl::RandomDouble01(), rcl::RandomDouble01()));
+
+    for (size_t count : photonCounts)
+    {
+        std::vector<rcl::Photon> photons = RandomPhotons(count);
+
+        for (double radius : radii)
+        {
+            BenchResult tree = Run(rcl::PhotonMapBackend::KDTree, photons, queries, radius);
+            BenchResult grid = Run(rcl::PhotonMapBackend::HashGrid, photons, queries, radius);
+
+            std::cout << "photons:" << count << " radius:" << radius
+                      << " | kd-tree build:" << tree.buildMs << "ms query:" << tree.queryMs << "ms"
+                      << " | hash grid build:" << grid.buildMs << "ms query:" << grid.queryMs << "ms"
+                      << (tree.found == grid.found ? " | results match" : " | RESULTS DIFFER")
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <set>
+#include <string>
+#include <algorithm>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "photon_map.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// A thin slab over the unit square: count photons on its top, lit to an irradiance of 2, and as many
+// on its underside a millimetre below, lit to 6
+std::vector<rcl::Photon> Slab(int count)
+{
+    std::vector<rcl::Photon> photons;
+    photons.reserve(2 * count);
+    for (int i = 0; i < count; i++)
+    {
+        rcl::vec3 top(rcl::RandomDouble01(), 0, rcl::RandomDouble01());
+        photons.push_back(rcl::Photon(top, rcl::vec3(2.0 / count), rcl::vec3(0, -1, 0), false, 1, rcl::vec3(0, 1, 0)));
+        rcl::vec3 bottom(rcl::RandomDouble01(), -0.001, rcl::RandomDouble01());
+        photons.push_back(rcl::Photon(bottom, rcl::vec3(6.0 / count), rcl::vec3(0, 1, 0), false, 1, rcl::vec3(0, -1, 0)));
+    }
+    return photons;
+}
+
+// The search against sorting every squared distance: as many photons as expected, each at the
+// squared distance reported, and those distances the smallest ones. Ties may be broken either way.
+// The hash grid only answers within its gather radius, limit.
+bool MatchesBruteForce(const rcl::PhotonMap& map, const std::vector<rcl::Photon>& photons, const rcl::vec3& query,
+                       int k, bool causticsOnly, double limit)
+{
+    std::vector<double> all;
+    for (const rcl::Photon& photon : photons)
+    {
+        double squaredDistance = (query - photon.position).LengthSquared();
+        if ((!causticsOnly || photon.isCaustic) && squaredDistance <= limit * limit)
+            all.push_back(squaredDistance);
+    }
+    std::sort(all.begin(), all.end());
+    size_t expected = std::min({all.size(), static_cast<size_t>(k), static_cast<size_t>(rcl::PhotonMap::MAX_K_NEAREST)});
+
+    std::vector<const rcl::Photon*> result;
+    std::vector<double> squaredDistances;
+    map.FindKNearestPhotons(query, k, result, squaredDistances, causticsOnly);
+    if (result.size() != expected || squaredDistances.size() != expected)
+        return false;
+    if (std::set<const rcl::Photon*>(result.begin(), result.end()).size() != expected)
+        return false;
+
+    for (size_t i = 0; i < expected; i++)
+    {
+        double tolerance = 1e-6 * std::max(1.0, all[i]);
+        if (std::fabs(squaredDistances[i] - all[i]) > tolerance ||
+            std::fabs((query - result[i]->position).LengthSquared() - squaredDistances[i]) > tolerance ||
+            (causticsOnly && !result[i]->isCaustic))
+            return false;
+    }
+    return true;
+}
+
+}
+
+// Usage: photon_map_test, checks k nearest searches against brute force and the irradiance cache
+// against direct estimates, on both backends
+int main()
+{
+    const int photonCount = 20000;
+    const int k = 64;
+    bool passed = true;
+
+    rcl::SeedRandom(11);
+
+    // Random photons, every fourth a caustic one; a lattice with integer coordinates, where many
+    // photons lie at exactly the same distance; and fewer photons than asked for
+    std::vector<rcl::Photon> random;
+    for (int i = 0; i < 5000; i++)
+    {
+        rcl::vec3 position(rcl::RandomDouble01(), rcl::RandomDouble01(), rcl::RandomDouble01());
+        random.push_back(rcl::Photon(position, rcl::vec3(1), rcl::vec3(0, -1, 0), i % 4 == 0, 1));
+    }
+    std::vector<rcl::Photon> lattice;
+    for (int x = 0; x < 10; x++)
+        for (int y = 0; y < 10; y++)
+            for (int z = 0; z < 10; z++)
+                lattice.push_back(rcl::Photon(rcl::vec3(x, y, z), rcl::vec3(1), rcl::vec3(0, -1, 0), (x + y + z) % 2 == 0, 1));
+    std::vector<rcl::Photon> few(random.begin(), random.begin() + 20);
+
+    for (rcl::PhotonMapBackend backend : {rcl::PhotonMapBackend::KDTree, rcl::PhotonMapBackend::HashGrid})
+    {
+        bool grid = backend == rcl::PhotonMapBackend::HashGrid;
+        struct Case
+        {
+            const char* name;
+            const std::vector<rcl::Photon>* photons;
+            double radius;
+            std::vector<int> ks;
+        };
+        Case cases[] = {
+            {"random photons", &random, 0.3, {1, 10, 100, 255, 256, 257, 1000}},
+            {"lattice ties", &lattice, 3.0, {1, 6, 7, 19, 27, 33, 256, 5000}},
+            {"fewer photons than k", &few, 2.0, {19, 20, 21, 50, 300}}
+        };
+
+        for (const Case& test : cases)
+        {
+            rcl::PhotonMap map;
+            map.SetBackend(backend, test.radius);
+            std::vector<rcl::Photon> photons = *test.photons;
+            map.Build(photons);
+
+            bool matches = true;
+            for (int q = 0; q < 40; q++)
+            {
+                // Lattice queries sit on photons and halfway between them, where ties are most common
+                rcl::vec3 query = test.photons == &lattice
+                    ? rcl::vec3(q % 10, (q / 2) % 10, 4.5 + (q % 3 == 0 ? 0.5 : 0))
+                    : rcl::vec3(rcl::RandomDouble01(), rcl::RandomDouble01(), rcl::RandomDouble01());
+                for (int count : test.ks)
+                    for (bool causticsOnly : {false, true})
+                        matches &= MatchesBruteForce(map, *test.photons, query, count, causticsOnly, grid ? test.radius : rcl::infinity);
+            }
+            std::string what = std::string(grid ? "hash grid" : "kd-tree") + " k nearest, " + test.name;
+            passed &= Check(matches, what);
+        }
+    }
+    std::vector<rcl::Photon> source = Slab(photonCount);
+    std::vector<rcl::vec3> queries;
+    for (int i = 0; i < 2000; i++)
+        queries.push_back(rcl::vec3(rcl::RandomDoubleMinMax(0.2, 0.8), 0, rcl::RandomDoubleMinMax(0.2, 0.8)));
+
+    // Cached estimates are direct ones taken at a nearby photon, they agree on average and each
+    // stays within the noise of a k photon estimate. Both sides of the slab keep their own light.
+    for (rcl::PhotonMapBackend backend : {rcl::PhotonMapBackend::KDTree, rcl::PhotonMapBackend::HashGrid})
+    {
+        const char* name = backend == rcl::PhotonMapBackend::KDTree ? "kd-tree" : "hash grid";
+        rcl::PhotonMap map;
+        map.SetBackend(backend, 0.1);
+        std::vector<rcl::Photon> photons = source;
+        map.Build(photons);
+        map.BuildIrradianceCache(k);
+
+        for (double side : {1.0, -1.0})
+        {
+            rcl::vec3 normal(0, side, 0);
+            double expected = side > 0 ? 2.0 : 6.0;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<double> direct;
+            for (const rcl::vec3& query : queries)
+                direct.push_back(map.EstimateIrradiance(query, normal, k).g);
+            double directMs = Milliseconds(start);
+
+            start = std::chrono::high_resolution_clock::now();
+            std::vector<double> cached;
+            for (const rcl::vec3& query : queries)
+                cached.push_back(map.LookupIrradiance(query, normal).g);
+            double cachedMs = Milliseconds(start);
+
+            double directMean = 0, cachedMean = 0, difference = 0;
+            for (size_t i = 0; i < queries.size(); i++)
+            {
+                directMean += direct[i] / queries.size();
+                cachedMean += cached[i] / queries.size();
+                difference += std::fabs(cached[i] - direct[i]) / direct[i] / queries.size();
+            }
+
+            std::cout << name << (side > 0 ? ", top: " : ", underside: ") << "direct " << directMean << " in " << directMs
+                      << " ms, cached " << cachedMean << " in " << cachedMs << " ms, mean difference " << difference * 100 << "%" << std::endl;
+            passed &= Check(std::fabs(directMean - expected) < 0.05 * expected, "direct estimate of the side's irradiance");
+            passed &= Check(std::fabs(cachedMean - directMean) < 0.03 * expected, "cached and direct means agree");
+            passed &= Check(difference < 0.25, "cached estimates close to direct ones");
+        }
+    }
+
+    std::cout << (passed ? "All photon map checks passed" : "Photon map checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cmath>
+
+#include "vector.hpp"
+#include "constants.hpp"
+#include "hittable_list.hpp"
+#include "quad.hpp"
+#include "materials.hpp"
+#include "solid_color.hpp"
+#include "photon_tracer.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+// The six walls of the box from -1 to 1, nothing escapes it
+rcl::HittableList Box(double albedo)
+{
+    auto mat = std::make_shared<rcl::Lambertian>(std::make_shared<rcl::SolidColor>(rcl::vec3(albedo)));
+    rcl::HittableList walls;
+    for (double side : {-1.0, 1.0})
+    {
+        walls.Add(std::make_shared<rcl::Quad>(rcl::vec3(side, -1, -1), rcl::vec3(0, 2, 0), rcl::vec3(0, 0, 2), mat));
+        walls.Add(std::make_shared<rcl::Quad>(rcl::vec3(-1, side, -1), rcl::vec3(0, 0, 2), rcl::vec3(2, 0, 0), mat));
+        walls.Add(std::make_shared<rcl::Quad>(rcl::vec3(-1, -1, side), rcl::vec3(2, 0, 0), rcl::vec3(0, 2, 0), mat));
+    }
+    return walls;
+}
+
+// A grey square light under the ceiling, shining down
+std::shared_ptr<rcl::Quad> CeilingLight(double x, double size, double intensity)
+{
+    return std::make_shared<rcl::Quad>(rcl::vec3(x, 0.9, -0.5), rcl::vec3(size, 0, 0), rcl::vec3(0, 0, size),
+                                       std::make_shared<rcl::Light>(rcl::vec3(1), intensity));
+}
+
+rcl::vec3 StoredFlux(const std::vector<rcl::Photon>& photons)
+{
+    rcl::vec3 flux(0);
+    for (const rcl::Photon& photon : photons)
+        flux += photon.power;
+    return flux;
+}
+
+}
+
+// Usage: photon_tracer_test, traces photons in a closed box and checks the flux they store against
+// the lights' power, their emission directions, and that a seed always gives the same photons
+int main()
+{
+    const int photonCount = 20000;
+    bool passed = true;
+
+    rcl::HittableList lights;
+    lights.Add(CeilingLight(-0.6, 0.5, 4));
+    lights.Add(CeilingLight(0.2, 0.25, 10));
+    // Lambertian flux, radiance * area * PI
+    double power = (4 * 0.25 + 10 * 0.0625) * rcl::PI;
+
+    // Black walls keep the first hit of every photon and nothing after it, all the emitted flux
+    {
+        rcl::PhotonTracer tracer(photonCount, 10, 7);
+        std::vector<rcl::Photon> photons;
+        tracer.Trace(Box(0), lights, photons);
+        rcl::vec3 flux = StoredFlux(photons);
+        passed &= Check(photons.size() == static_cast<size_t>(photonCount), "one photon stored per emitted photon");
+        passed &= Check(std::fabs(flux.r - power) < 1e-3 * power && flux.r == flux.g && flux.g == flux.b, "stored flux is the lights' power");
+
+        // Emission follows the cosine law, the mean cosine to the light's normal is 2/3, 1/2 if uniform
+        double cosine = 0;
+        for (const rcl::Photon& photon : photons)
+            cosine += -photon.direction.y / photons.size();
+        passed &= Check(std::fabs(cosine - 2.0 / 3.0) < 0.01, "cosine weighted emission");
+    }
+
+    // Walls reflecting half of what arrives store the flux again on every bounce, 1 / (1 - 0.5) times in all
+    {
+        rcl::PhotonTracer tracer(photonCount, 100, 7);
+        std::vector<rcl::Photon> photons;
+        tracer.Trace(Box(0.5), lights, photons);
+        passed &= Check(std::fabs(StoredFlux(photons).g - 2 * power) < 0.03 * 2 * power, "stored flux over bounces");
+    }
+
+    // The same seed gives the same photons, another seed other ones
+    {
+        rcl::HittableList box = Box(0.5);
+        std::vector<rcl::Photon> first, second, other;
+        rcl::PhotonTracer(photonCount, 10, 3).Trace(box, lights, first);
+        rcl::PhotonTracer(photonCount, 10, 3).Trace(box, lights, second);
+        rcl::PhotonTracer(photonCount, 10, 4).Trace(box, lights, other);
+
+        bool same = first.size() == second.size();
+        for (size_t i = 0; same && i < first.size(); i++)
+        {
+            const rcl::Photon& a = first[i];
+            const rcl::Photon& b = second[i];
+            same &= a.position.x == b.position.x && a.position.y == b.position.y && a.position.z == b.position.z &&
+                    a.power.r == b.power.r && a.direction.x == b.direction.x && a.direction.z == b.direction.z;
+        }
+        passed &= Check(same, "same seed, same photons");
+        passed &= Check(other.size() != first.size() || other[0].position.x != first[0].position.x, "another seed, other photons");
+    }
+
+    std::cout << (passed ? "All photon tracer checks passed" : "Photon tracer checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "vector.hpp"
+#include "picture.hpp"
+#include "pictures_workers.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool Aligned(const rcl::vec3* data)
+{
+    return reinterpret_cast<uintptr_t>(data) % rcl::PIXEL_ALIGNMENT == 0;
+}
+
+}
+
+// Usage: picture_test [width] [height], checks Picture ownership and views and times what
+// allocating, copying and moving a frame of that size costs
+int main(int argc, char** argv)
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 3840;
+    int height = argc > 2 ? std::atoi(argv[2]) : 2160;
+    size_t count = static_cast<size_t>(width) * height;
+
+    bool passed = true;
+
+    // Storage is zeroed and aligned, small and mapped alike
+    for (int side : {4, width})
+    {
+        rcl::Picture picture(side, side == width ? height : side);
+        passed &= Check(picture.GetData() && Aligned(picture.GetData()), "aligned storage");
+        passed &= Check(picture.OwnsData(), "owned storage");
+        bool zero = true;
+        for (int i = 0; i < picture.GetSize(); i += 97)
+            zero &= picture.GetData()[i].r == 0 && picture.GetData()[i].g == 0 && picture.GetData()[i].b == 0;
+        passed &= Check(zero, "zeroed storage");
+    }
+
+    // Moving hands the pixels over, copying does not share them
+    rcl::Picture frame(width, height);
+    frame.WritePixel(height - 1, width - 1, rcl::vec3(1, 2, 3));
+    rcl::vec3* pixels = frame.GetData();
+    rcl::Picture moved(std::move(frame));
+    passed &= Check(moved.GetData() == pixels && !frame.GetData() && frame.GetSize() == 0, "move constructor");
+    rcl::Picture assigned;
+    assigned = std::move(moved);
+    passed &= Check(assigned.GetData() == pixels && !moved.GetData(), "move assignment");
+    rcl::Picture copy(assigned);
+    passed &= Check(copy.GetData() != pixels && copy.OwnsData() &&
+                    std::memcmp(copy.GetData(), pixels, count * sizeof(rcl::vec3)) == 0, "copy");
+
+    // Over the caller's pixels: written through, left alone when the picture goes
+    std::vector<rcl::vec3> external(16 * 8);
+    {
+        rcl::Picture wrapped(external.data(), 16, 8);
+        passed &= Check(wrapped.GetData() == external.data() && !wrapped.OwnsData(), "external storage");
+        wrapped.WritePixel(2, 3, rcl::vec3(7));
+        rcl::Picture owned(wrapped);
+        passed &= Check(owned.OwnsData() && owned.GetData() != external.data(), "copy of external storage");
+        rcl::Picture taken(std::move(wrapped));
+        passed &= Check(!taken.OwnsData() && taken.GetData() == external.data(), "move of external storage");
+    }
+    passed &= Check(external[2 * 16 + 3].r == 7, "write to external storage");
+
+    // Views: clipped, written through, copied out row by row
+    rcl::PictureView view = copy.View(width - 8, height - 4, 16, 16);
+    passed &= Check(view.GetWidth() == 8 && view.GetHeight() == 4 && view.GetStride() == width, "clipped view");
+    passed &= Check(view.GetPixel(3, 7).b == 3, "view reads");
+    view.View(1, 1, 2, 2).WritePixel(0, 0, rcl::vec3(5));
+    passed &= Check(copy.GetData()[static_cast<size_t>(height - 3) * width + width - 7].r == 5, "view writes");
+    rcl::Picture part(view);
+    passed &= Check(part.GetWidth() == 8 && part.GetHeight() == 4 && part.GetData()[3 * 8 + 7].g == 2, "copy of a view");
+    passed &= Check(copy.View(width, 0, 4, 4).GetWidth() == 0, "empty view");
+
+    // What the render path paid for and pays now
+    auto start = std::chrono::high_resolution_clock::now();
+    rcl::vec3* legacy = new rcl::vec3[count];
+    double legacyAllocate = Milliseconds(start);
+    start = std::chrono::high_resolution_clock::now();
+    rcl::Picture fresh(width, height);
+    double allocate = Milliseconds(start);
+    start = std::chrono::high_resolution_clock::now();
+    std::memcpy(legacy, copy.GetData(), count * sizeof(rcl::vec3));
+    double legacyCopy = Milliseconds(start);
+    start = std::chrono::high_resolution_clock::now();
+    fresh = std::move(copy);
+    double move = Milliseconds(start);
+    delete[] legacy;
+
+    std::cout << width << "x" << height << ": new[] " << legacyAllocate << " ms, AllocatePixels " << allocate
+              << " ms, frame copy " << legacyCopy << " ms, move " << move << " ms" << std::endl;
+
+    std::cout << (passed ? "All picture checks passed" : "Picture checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
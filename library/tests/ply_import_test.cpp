@@ -0,0 +1,197 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "vector.hpp"
+#include "mesh_buffers.hpp"
+#include "model_workers.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+// Binary PLY body in either byte order
+class Body
+{
+public:
+    explicit Body(bool bigEndian) : bigEndian(bigEndian) {}
+
+    template<typename T>
+    void Put(T value)
+    {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        uint16_t probe = 1;
+        bool hostLittle = *reinterpret_cast<unsigned char*>(&probe) == 1;
+        if (hostLittle == bigEndian)
+            for (size_t i = 0; i < sizeof(T) / 2; i++)
+                std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+        data.append(reinterpret_cast<const char*>(bytes), sizeof(T));
+    }
+
+    std::string data;
+private:
+    bool bigEndian;
+};
+
+void WriteFile(const char* path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << contents;
+}
+
+std::string Header(const char* format, int vertices, int faces, const char* countType = "uchar")
+{
+    return std::string("ply\nformat ") + format + " 1.0\ncomment test\n"
+           "element vertex " + std::to_string(vertices) + "\n"
+           "property float x\nproperty float y\nproperty float z\n"
+           "property float nx\nproperty float ny\nproperty float nz\n"
+           "property uchar flags\n"
+           "element face " + std::to_string(faces) + "\n"
+           "property list " + countType + " int vertex_indices\n"
+           "end_header\n";
+}
+
+// A unit square with an upward normal, one quad face and one triangle face on its corners
+const float CORNERS[4][3] = {{0, 0, 0}, {1, 0, 0}, {1, 0, 1}, {0, 0, 1}};
+const uint32_t EXPECTED[9] = {0, 1, 2, 0, 2, 3, 0, 1, 3};
+
+std::string Binary(bool bigEndian)
+{
+    Body body(bigEndian);
+    for (const float* corner : CORNERS)
+    {
+        body.Put(corner[0]); body.Put(corner[1]); body.Put(corner[2]);
+        body.Put(0.0f); body.Put(1.0f); body.Put(0.0f);
+        body.Put<uint8_t>(7);
+    }
+    body.Put<uint8_t>(4);
+    for (int32_t i : {0, 1, 2, 3})
+        body.Put(i);
+    body.Put<uint8_t>(3);
+    for (int32_t i : {0, 1, 3})
+        body.Put(i);
+    return Header(bigEndian ? "binary_big_endian" : "binary_little_endian", 4, 2) + body.data;
+}
+
+std::string Ascii()
+{
+    std::string text = Header("ascii", 4, 2);
+    for (const float* corner : CORNERS)
+        text += std::to_string(corner[0]) + " " + std::to_string(corner[1]) + " " + std::to_string(corner[2]) + " 0 1 0 7\n";
+    return text + "4 0 1 2 3\n3 0 1 3\n";
+}
+
+bool Matches(const rcl::MeshBuffers& buffers)
+{
+    if (buffers.positions.size() != 4 || buffers.normals.size() != 4 || !buffers.uvs.empty() || buffers.indices.size() != 9)
+        return false;
+    for (int i = 0; i < 4; i++)
+    {
+        const rcl::vec3& p = buffers.positions[i];
+        if (p.x != CORNERS[i][0] || p.y != CORNERS[i][1] || p.z != CORNERS[i][2] || buffers.normals[i].y != 1)
+            return false;
+    }
+    for (int i = 0; i < 9; i++)
+        if (buffers.indices[i] != EXPECTED[i])
+            return false;
+    return true;
+}
+
+// Imports contents and expects nothing back, and no crash on the way
+bool Rejected(const char* path, const std::string& contents)
+{
+    WriteFile(path, contents);
+    rcl::MeshBuffers buffers;
+    buffers.positions.push_back(rcl::vec3(1.0f));
+    rcl::ImportPLY(path, buffers);
+    return buffers.positions.empty() && buffers.indices.empty();
+}
+
+}
+
+// Usage: ply_import_test, reads the same mesh as ASCII and binary PLY in both byte orders, then
+// feeds ImportPLY truncated and corrupt files
+int main()
+{
+    const char* path = "ply_import_test.ply";
+    bool passed = true;
+
+    // Every encoding gives the same buffers
+    {
+        rcl::MeshBuffers buffers;
+        WriteFile(path, Ascii());
+        rcl::ImportPLY(path, buffers);
+        passed &= Check(Matches(buffers), "ascii");
+        WriteFile(path, Binary(false));
+        rcl::ImportPLY(path, buffers);
+        passed &= Check(Matches(buffers), "binary little endian");
+        WriteFile(path, Binary(true));
+        rcl::ImportPLY(path, buffers);
+        passed &= Check(Matches(buffers), "binary big endian");
+    }
+
+    // Cut anywhere in the body, never a partial mesh
+    for (bool bigEndian : {false, true})
+    {
+        std::string whole = Binary(bigEndian);
+        size_t body = Header(bigEndian ? "binary_big_endian" : "binary_little_endian", 4, 2).size();
+        bool allRejected = true;
+        for (size_t length = body; length < whole.size(); length++)
+            allRejected &= Rejected(path, whole.substr(0, length));
+        passed &= Check(allRejected, "truncated binary body");
+    }
+    {
+        std::string whole = Ascii();
+        passed &= Check(Rejected(path, whole.substr(0, whole.size() - 4)), "truncated ascii body");
+        passed &= Check(Rejected(path, whole.substr(0, 40)), "truncated header");
+    }
+
+    // List lengths no body could hold, whatever their type
+    {
+        std::string header = Header("binary_little_endian", 0, 1, "uint");
+        Body huge(false);
+        huge.Put<uint32_t>(0xFFFFFFFFu);
+        huge.Put<int32_t>(0);
+        passed &= Check(Rejected(path, header + huge.data), "huge list length");
+
+        Body negative(false);
+        negative.Put<int32_t>(-3);
+        passed &= Check(Rejected(path, Header("binary_little_endian", 0, 1, "int") + negative.data), "negative list length");
+
+        std::string floatHeader = Header("binary_little_endian", 0, 1, "float");
+        for (float count : {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), 1e30f})
+        {
+            Body corrupt(false);
+            corrupt.Put(count);
+            corrupt.Put<int32_t>(0);
+            passed &= Check(Rejected(path, floatHeader + corrupt.data), "non-finite or huge float list length");
+        }
+
+        passed &= Check(Rejected(path, Header("ascii", 0, 1) + "1e300 0 1 2\n"), "huge ascii list length");
+        passed &= Check(Rejected(path, Header("ascii", 0, 1) + "nan 0 1 2\n"), "nan ascii list length");
+    }
+
+    // Element counts beyond the body
+    passed &= Check(Rejected(path, Header("binary_big_endian", 1000000000, 0)), "huge element count");
+    passed &= Check(Rejected(path, Header("ascii", 2000000000, 0) + "0 0 0 0 1 0 7\n"), "huge ascii element count");
+    {
+        // Every value one digit and one separator, the least an ASCII element can take
+        std::string text = Header("ascii", 4, 0);
+        for (int i = 0; i < 4; i++)
+            text += "0 0 0 0 1 0 7\n";
+        rcl::MeshBuffers buffers;
+        WriteFile(path, text);
+        rcl::ImportPLY(path, buffers);
+        passed &= Check(buffers.positions.size() == 4, "shortest ascii elements");
+    }
+
+    std::remove(path);
+    std::cout << (passed ? "All PLY import checks passed" : "PLY import checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <string>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "pictures_workers.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int Quantize(float value)
+{
+    return std::min(static_cast<int>(256 * std::clamp(static_cast<double>(value), 0.0, 0.999)), 255);
+}
+
+// Something like a render: smooth shading, a hard edged disc and a little sampling noise
+std::vector<rcl::vec3> MakeImage(int width, int height)
+{
+    std::vector<rcl::vec3> pixels(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            double u = double(x) / width;
+            double v = double(y) / height;
+            double noise = 0.02 * (rcl::RandomDouble01() - 0.5);
+            rcl::vec3 color(0.2 + 0.6 * u + noise, 0.3 + 0.4 * v + noise, 0.5 + 0.3 * std::sin(6 * u) * v + noise);
+            if ((u - 0.5) * (u - 0.5) + (v - 0.5) * (v - 0.5) < 0.05)
+                color = rcl::vec3(0.9, 0.1 + noise, 0.1);
+            pixels[static_cast<size_t>(y) * width + x] = color;
+        }
+    }
+    return pixels;
+}
+
+long FileSize(const char* path)
+{
+    std::ifstream written(path, std::ios::binary | std::ios::ate);
+    return static_cast<long>(written.tellg());
+}
+
+// Pixels of the file at path that differ from the 8-bit values of pixels
+size_t Mismatches(const char* path, const std::vector<rcl::vec3>& pixels, int width, int height)
+{
+    int readWidth = 0, readHeight = 0;
+    rcl::vec3* read = nullptr;
+    std::string name = path;
+    if (name.substr(name.size() - 4) == ".ppm")
+        rcl::ImportPPM(path, readWidth, readHeight, read);
+    else
+        rcl::ImportPNG(path, readWidth, readHeight, read);
+
+    size_t mismatches = 0;
+    if (!read || readWidth != width || readHeight != height)
+    {
+        mismatches = pixels.size();
+    }
+    else
+    {
+        for (size_t i = 0; i < pixels.size(); i++)
+        {
+            if (Quantize(pixels[i].r) != std::lround(read[i].r * 255) ||
+                Quantize(pixels[i].g) != std::lround(read[i].g * 255) ||
+                Quantize(pixels[i].b) != std::lround(read[i].b * 255))
+                mismatches++;
+        }
+    }
+    rcl::FreePixels(read, static_cast<size_t>(readWidth) * readHeight);
+    return mismatches;
+}
+
+}
+
+// Usage: png_export_test [width] [height], writes the image at several levels and streamed, and reads it back
+int main(int argc, char** argv)
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 640;
+    int height = argc > 2 ? std::atoi(argv[2]) : 480;
+    const char* path = "png_export_test.png";
+
+    std::vector<rcl::vec3> pixels = MakeImage(width, height);
+    const rcl::vec3* data = pixels.data();
+    std::cout << width << " x " << height << ", raw RGB " << width * height * 3 / 1024 << " KB" << std::endl;
+
+    bool passed = true;
+    int levels[] = {0, 1, 6, 9};
+    for (int level : levels)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        rcl::ExportPNG(path, width, height, data, level);
+        double exportMs = Milliseconds(start);
+
+        long size = FileSize(path);
+        size_t mismatches = Mismatches(path, pixels, width, height);
+
+        std::cout << "level " << level << ": " << size / 1024 << " KB in " << exportMs << " ms"
+                  << (mismatches ? ", PIXELS DIFFER: " + std::to_string(mismatches) : "") << std::endl;
+        passed = passed && mismatches == 0;
+    }
+
+    // Streamed in uneven bands, the rows of each call compressed against the previous ones
+    const char* streamedPaths[] = {"png_export_test_streamed.png", "png_export_test_streamed.ppm"};
+    for (const char* streamedPath : streamedPaths)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        rcl::ImageStreamWriter writer(streamedPath, width, height);
+        int bands[] = {1, 7, 100, 3};
+        int row = 0;
+        for (int i = 0; row < height; i++)
+        {
+            int rows = std::min(bands[i % 4], height - row);
+            writer.WriteRows(data + static_cast<size_t>(row) * width, rows);
+            row += rows;
+        }
+        bool closed = writer.Close();
+        double exportMs = Milliseconds(start);
+
+        size_t mismatches = closed ? Mismatches(streamedPath, pixels, width, height) : pixels.size();
+        std::cout << "streamed " << streamedPath << ": " << FileSize(streamedPath) / 1024 << " KB in " << exportMs << " ms"
+                  << (mismatches ? ", PIXELS DIFFER: " + std::to_string(mismatches) : "") << std::endl;
+        passed = passed && mismatches == 0;
+        std::remove(streamedPath);
+    }
+
+    std::remove(path);
+    std::cout << (passed ? "all passed" : "SOME FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "pictures_workers.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+int Quantize(float value)
+{
+    return std::min(static_cast<int>(256 * std::clamp(static_cast<double>(value), 0.0, 0.999)), 255);
+}
+
+// Values in and around [0, 1], the ends exactly
+std::vector<rcl::vec3> MakeImage(int width, int height)
+{
+    std::vector<rcl::vec3> pixels(static_cast<size_t>(width) * height);
+    for (rcl::vec3& pixel : pixels)
+        pixel = rcl::vec3(rcl::RandomDoubleMinMax(-0.1, 1.1), rcl::RandomDouble01(), rcl::RandomDouble01() < 0.5 ? 0.0 : 1.0);
+    return pixels;
+}
+
+// Largest difference between what was written and read, in units of the file's sample step
+double MaxError(const std::vector<rcl::vec3>& pixels, const rcl::vec3* read, int maxValue)
+{
+    double error = 0;
+    const float* written = &pixels[0].r;
+    const float* got = &read[0].r;
+    for (size_t i = 0; i < pixels.size() * 3; i++)
+    {
+        double expected = maxValue == 255 ? Quantize(written[i]) : std::clamp(written[i], 0.0f, 1.0f) * 65535.0;
+        error = std::max(error, std::abs(got[i] * maxValue - expected));
+    }
+    return error;
+}
+
+}
+
+// Usage: ppm_export_test [width] [height], writes binary PPM files at 8 and 16 bits and a text
+// one and reads them back
+int main(int argc, char** argv)
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 640;
+    int height = argc > 2 ? std::atoi(argv[2]) : 480;
+    const char* path = "ppm_export_test.ppm";
+
+    std::vector<rcl::vec3> pixels = MakeImage(width, height);
+    bool passed = true;
+
+    int depths[] = {8, 16};
+    for (int depth : depths)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        rcl::ExportPPM(path, width, height, pixels.data(), depth);
+        double exportMs = Milliseconds(start);
+
+        int readWidth = 0, readHeight = 0;
+        rcl::vec3* read = nullptr;
+        start = std::chrono::high_resolution_clock::now();
+        rcl::ImportPPM(path, readWidth, readHeight, read);
+        double importMs = Milliseconds(start);
+
+        int maxValue = depth == 8 ? 255 : 65535;
+        double error = read && readWidth == width && readHeight == height ? MaxError(pixels, read, maxValue) : 1e9;
+        rcl::FreePixels(read, static_cast<size_t>(readWidth) * readHeight);
+        // Exact bytes at 8 bits, 16-bit samples rounded to the nearest step up to float precision
+        bool ok = depth == 8 ? error < 1e-3 : error <= 0.51;
+        passed = passed && ok;
+
+        std::cout << "P6 " << depth << "-bit: export " << exportMs << " ms, import " << importMs << " ms, max error "
+                  << error << " steps" << (ok ? "" : " TOO LARGE") << std::endl;
+    }
+
+    // Text files are still read
+    {
+        std::ofstream text(path);
+        text << "P3\n# comment\n2 1\n255\n0 128 255\n255 0 64\n";
+    }
+    int readWidth = 0, readHeight = 0;
+    rcl::vec3* read = nullptr;
+    rcl::ImportPPM(path, readWidth, readHeight, read);
+    bool textOk = read && readWidth == 2 && readHeight == 1 && read[0].g == 128 / 255.0f && read[1].b == 64 / 255.0f;
+    rcl::FreePixels(read, static_cast<size_t>(readWidth) * readHeight);
+    passed = passed && textOk;
+    std::cout << "P3 import " << (textOk ? "ok" : "FAILED") << std::endl;
+
+    std::remove(path);
+    std::cout << (passed ? "all passed" : "SOME FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
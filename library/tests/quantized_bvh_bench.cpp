@@ -0,0 +1,117 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "constants.hpp"
+#include "hittable_list.hpp"
+#include "mesh_buffers.hpp"
+#include "bvh.hpp"
+#include "quantized_bvh.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Bumpy sphere, so rays from all around hit it at varied depths
+void MakeSphere(rcl::MeshBuffers& buffers, int rings)
+{
+    int segments = 2 * rings;
+    for (int ring = 0; ring <= rings; ring++)
+    {
+        double theta = rcl::PI * ring / rings;
+        for (int segment = 0; segment <= segments; segment++)
+        {
+            double phi = 2 * rcl::PI * segment / segments;
+            double radius = 1 + 0.05 * std::sin(7 * theta) * std::cos(9 * phi);
+            buffers.positions.push_back(rcl::vec3(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta), radius * std::sin(theta) * std::sin(phi)));
+        }
+    }
+
+    for (int ring = 0; ring < rings; ring++)
+    {
+        for (int segment = 0; segment < segments; segment++)
+        {
+            uint32_t a = ring * (segments + 1) + segment;
+            uint32_t b = a + 1;
+            uint32_t c = a + segments + 1;
+            uint32_t d = c + 1;
+            buffers.indices.insert(buffers.indices.end(), {a, b, d, a, d, c});
+        }
+    }
+}
+
+std::vector<double> CastRays(const rcl::Hittable& scene, const std::vector<rcl::Ray>& rays, double& milliseconds)
+{
+    std::vector<double> distances(rays.size(), -1);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < rays.size(); i++)
+    {
+        rcl::HitRecord record;
+        if (scene.hit(rays[i], rcl::Interval<double>(0.001, rcl::infinity), record))
+            distances[i] = record.distance;
+    }
+    milliseconds = Milliseconds(start);
+    return distances;
+}
+
+}
+
+// Usage: quantized_bvh_bench [rings], the sphere has 4 * rings^2 triangles
+int main(int argc, char** argv)
+{
+    int rings = argc > 1 ? std::atoi(argv[1]) : 300;
+    const int rayCount = 200000;
+
+    auto buffers = std::make_shared<rcl::MeshBuffers>();
+    MakeSphere(*buffers, rings);
+    rcl::HittableList triangles;
+    rcl::BuildIndexedTriangles(buffers, triangles);
+
+    std::vector<rcl::Ray> rays;
+    for (int i = 0; i < rayCount; i++)
+    {
+        rcl::vec3 origin = rcl::Ray::RandomOnHemisphere(rcl::vec3(0, 1, 0)) * 3.0;
+        if (i % 2) origin = -origin;
+        rcl::vec3 target(rcl::RandomDoubleMinMax(-0.7, 0.7), rcl::RandomDoubleMinMax(-0.7, 0.7), rcl::RandomDoubleMinMax(-0.7, 0.7));
+        rays.push_back(rcl::Ray(origin, target - origin));
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    rcl::BVHNode binary(triangles);
+    double buildMs = Milliseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    rcl::QuantizedBVH<uint16_t> wide16(binary);
+    double build16Ms = Milliseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    rcl::QuantizedBVH<uint8_t> wide8(binary);
+    double build8Ms = Milliseconds(start);
+
+    double binaryMs, wide16Ms, wide8Ms;
+    std::vector<double> reference = CastRays(binary, rays, binaryMs);
+    std::vector<double> hits16 = CastRays(wide16, rays, wide16Ms);
+    std::vector<double> hits8 = CastRays(wide8, rays, wide8Ms);
+
+    std::cout << triangles.objects.size() << " triangles, " << rayCount << " rays" << std::endl;
+    std::cout << "binary:       build " << buildMs << " ms, " << binary.NodeCount() << " nodes, "
+              << binary.BytesPerPrimitive() << " bytes/primitive, rays " << binaryMs << " ms" << std::endl;
+    std::cout << "quantized 16: collapse " << build16Ms << " ms, " << wide16.NodeCount() << " nodes, "
+              << wide16.BytesPerPrimitive() << " bytes/primitive, rays " << wide16Ms << " ms" << std::endl;
+    std::cout << "quantized 8:  collapse " << build8Ms << " ms, " << wide8.NodeCount() << " nodes, "
+              << wide8.BytesPerPrimitive() << " bytes/primitive, rays " << wide8Ms << " ms" << std::endl;
+
+    bool same = reference == hits16 && reference == hits8;
+    std::cout << (same ? "results match" : "RESULTS DIFFER") << std::endl;
+    return same ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "resolve.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// What ExportPNG has always written
+int Quantize(float value)
+{
+    return std::min(static_cast<int>(256 * std::clamp(static_cast<double>(value), 0.0, 0.999)), 255);
+}
+
+double SRGB(double x)
+{
+    x = std::clamp(x, 0.0, 1.0);
+    return x <= 0.0031308 ? 12.92 * x : 1.055 * std::pow(x, 1 / 2.4) - 0.055;
+}
+
+double ACES(double x)
+{
+    x = std::max(x, 0.0);
+    return std::min((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 1.0);
+}
+
+rcl::ResolveSettings Settings(rcl::ToneCurve curve, rcl::TransferCurve transfer, bool dither = false)
+{
+    rcl::ResolveSettings settings;
+    settings.toneCurve = curve;
+    settings.transfer = transfer;
+    settings.dither = dither;
+    return settings;
+}
+
+}
+
+// Usage: resolve_bench [width] [height], checks every curve against its definition and times the
+// fused pass against doing each step per pixel
+int main(int argc, char** argv)
+{
+    int width = argc > 1 ? std::atoi(argv[1]) : 3840;
+    int height = argc > 2 ? std::atoi(argv[2]) : 2160;
+    size_t count = static_cast<size_t>(width) * height;
+
+    // Radiance with plenty of values past 1 and a few negative ones, widths not a multiple of 8
+    std::vector<rcl::vec3> pixels(count);
+    for (rcl::vec3& pixel : pixels)
+        pixel = rcl::vec3(rcl::RandomDoubleMinMax(-0.1, 1.2), 4 * rcl::RandomDouble01() * rcl::RandomDouble01(), rcl::RandomDouble01() * 0.01);
+    const float* in = &pixels[0].r;
+    size_t samples = count * 3;
+
+    std::vector<rcl::vec3> resolved(count);
+    const float* out = &resolved[0].r;
+    std::vector<uint8_t> bytes(samples);
+    std::vector<uint16_t> words(samples);
+    size_t failures = 0;
+
+    // No curves: the exporters' 8-bit values exactly
+    rcl::Resolve(pixels.data(), bytes.data(), width, height, rcl::ResolveSettings());
+    for (size_t i = 0; i < samples; i++)
+        failures += bytes[i] != Quantize(in[i]);
+
+    // Square root and Reinhard as Picture::GammaCorection and the path tracer compute them
+    rcl::Resolve(pixels.data(), resolved.data(), width, height, Settings(rcl::ToneCurve::Reinhard, rcl::TransferCurve::Gamma2));
+    for (size_t i = 0; i < samples; i++)
+        failures += out[i] != static_cast<float>(rcl::LinearToGamma(in[i] / (in[i] + 1.0f)));
+
+    // sRGB and ACES to their definitions
+    double srgbError = 0, acesError = 0;
+    rcl::Resolve(pixels.data(), resolved.data(), width, height, Settings(rcl::ToneCurve::None, rcl::TransferCurve::SRGB));
+    for (size_t i = 0; i < samples; i++)
+        srgbError = std::max(srgbError, std::abs(out[i] - SRGB(in[i])));
+    rcl::Resolve(pixels.data(), resolved.data(), width, height, Settings(rcl::ToneCurve::ACES, rcl::TransferCurve::Linear));
+    for (size_t i = 0; i < samples; i++)
+        acesError = std::max(acesError, std::abs(out[i] - ACES(in[i])));
+    failures += srgbError > 2e-6;
+    failures += acesError > 1e-6;
+
+    // 16-bit: nearest step
+    int wordError = 0;
+    rcl::Resolve(pixels.data(), words.data(), width, height, Settings(rcl::ToneCurve::ACES, rcl::TransferCurve::SRGB));
+    for (size_t i = 0; i < samples; i++)
+        wordError = std::max(wordError, std::abs(words[i] - static_cast<int>(std::lround(SRGB(ACES(in[i])) * 65535))));
+    failures += wordError > 1;
+
+    // Dithering keeps the average: truncating x + noise gives x - 0.5 on average
+    std::vector<rcl::vec3> flat(count, rcl::vec3(0.3));
+    rcl::Resolve(flat.data(), bytes.data(), width, height, Settings(rcl::ToneCurve::None, rcl::TransferCurve::Linear, true));
+    double mean = 0;
+    for (uint8_t b : bytes)
+        mean += b;
+    mean /= samples;
+    double ditherBias = mean - (0.3f * 256 - 0.5);
+    failures += std::abs(ditherBias) > 0.01;
+
+    // Non-finite radiance, as a path can produce: one row of 3 pixels, 8 samples through the vector
+    // path and the last through the scalar one. NaN resolves to 0 and both paths agree on every value.
+    size_t nonFinite = 0;
+    for (float value : {std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()})
+    {
+        std::vector<rcl::vec3> row(3, rcl::vec3(value));
+        for (rcl::ToneCurve curve : {rcl::ToneCurve::None, rcl::ToneCurve::Reinhard, rcl::ToneCurve::ACES})
+            for (rcl::TransferCurve transfer : {rcl::TransferCurve::Linear, rcl::TransferCurve::Gamma2, rcl::TransferCurve::SRGB})
+            {
+                uint8_t rowBytes[9];
+                uint16_t rowWords[9];
+                rcl::vec3 rowFloats[3];
+                rcl::Resolve(row.data(), rowBytes, 3, 1, Settings(curve, transfer));
+                rcl::Resolve(row.data(), rowWords, 3, 1, Settings(curve, transfer));
+                rcl::Resolve(row.data(), rowFloats, 3, 1, Settings(curve, transfer));
+                for (int i = 0; i < 8; i++)
+                    nonFinite += rowBytes[i] != rowBytes[8] || rowWords[i] != rowWords[8] ||
+                                 std::memcmp(&rowFloats[0].r + i, &rowFloats[2].b, sizeof(float)) != 0;
+                if (value != value)
+                    nonFinite += rowBytes[8] != 0 || rowWords[8] != 0;
+            }
+    }
+    failures += nonFinite;
+
+    std::cout << "max error: sRGB " << srgbError << ", ACES " << acesError << ", 16-bit " << wordError
+              << " steps, dither bias " << ditherBias << " steps, non-finite mismatches " << nonFinite << std::endl;
+
+    // The old way: tone map, square root, then quantize, each a separate per channel pass
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<rcl::vec3> copy = pixels;
+    for (rcl::vec3& pixel : copy)
+    {
+        pixel.x /= pixel.x + 1;
+        pixel.y /= pixel.y + 1;
+        pixel.z /= pixel.z + 1;
+    }
+    for (rcl::vec3& pixel : copy)
+    {
+        pixel.r = rcl::LinearToGamma(pixel.r);
+        pixel.g = rcl::LinearToGamma(pixel.g);
+        pixel.b = rcl::LinearToGamma(pixel.b);
+    }
+    for (size_t i = 0; i < samples; i++)
+        bytes[i] = static_cast<uint8_t>(Quantize((&copy[0].r)[i]));
+    double separateMs = Milliseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    rcl::Resolve(pixels.data(), bytes.data(), width, height, Settings(rcl::ToneCurve::Reinhard, rcl::TransferCurve::Gamma2));
+    double fusedMs = Milliseconds(start);
+
+    start = std::chrono::high_resolution_clock::now();
+    rcl::Resolve(pixels.data(), bytes.data(), width, height, Settings(rcl::ToneCurve::ACES, rcl::TransferCurve::SRGB, true));
+    double fullMs = Milliseconds(start);
+
+    std::cout << width << " x " << height << ": separate passes " << separateMs << " ms, fused " << fusedMs
+              << " ms, ACES + sRGB + dither " << fullMs << " ms" << std::endl;
+
+    std::cout << (failures == 0 ? "all passed" : "SOME FAILED: " + std::to_string(failures)) << std::endl;
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <cmath>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "alias_table.hpp"
+#include "quad.hpp"
+#include "vertex_triangle.hpp"
+#include "hittable_list.hpp"
+#include "mesh.hpp"
+#include "bvh.hpp"
+#include "quantized_bvh.hpp"
+#include "materials.hpp"
+
+namespace
+{
+
+const int SAMPLE_COUNT = 400000;
+
+bool Check(const char* name, double measured, double expected, double tolerance)
+{
+    bool passed = std::fabs(measured - expected) <= tolerance;
+    std::cout << (passed ? "ok     " : "FAILED ") << name << ": " << measured << " (expected " << expected << ")" << std::endl;
+    return passed;
+}
+
+// Fraction of surface samples landing on the part of the scene with x > 0
+double FractionRight(const rcl::Hittable& object)
+{
+    int right = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+        if (object.RandomPointOnSurface().x > 0)
+            right++;
+    return double(right) / SAMPLE_COUNT;
+}
+
+}
+
+int main()
+{
+    bool passed = true;
+
+    std::vector<double> weights = {1, 0, 3, 6, -2};
+    rcl::AliasTable table(weights);
+    std::vector<int> counts(weights.size(), 0);
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+        counts[table.Sample()]++;
+    passed &= Check("alias table, weight 1", double(counts[0]) / SAMPLE_COUNT, 0.1, 0.005);
+    passed &= Check("alias table, weight 0", double(counts[1]) / SAMPLE_COUNT, 0.0, 0.0);
+    passed &= Check("alias table, weight 3", double(counts[2]) / SAMPLE_COUNT, 0.3, 0.005);
+    passed &= Check("alias table, weight 6", double(counts[3]) / SAMPLE_COUNT, 0.6, 0.005);
+    passed &= Check("alias table, negative weight", double(counts[4]) / SAMPLE_COUNT, 0.0, 0.0);
+    passed &= Check("alias table, probability", table.Probability(3), 0.6, 1e-12);
+
+    // Points must stay inside the triangle x >= 0, y >= 0, x + y <= 1
+    rcl::Vertex a, b, c;
+    a.coord = rcl::vec3(0, 0, 0);
+    b.coord = rcl::vec3(1, 0, 0);
+    c.coord = rcl::vec3(0, 1, 0);
+    rcl::VertexTriangle triangle(a, b, c);
+    int outside = 0;
+    for (int i = 0; i < SAMPLE_COUNT; i++)
+    {
+        rcl::vec3 point = triangle.RandomPointOnSurface();
+        if (point.x < 0 || point.y < 0 || point.x + point.y > 1 + 1e-6)
+            outside++;
+    }
+    passed &= Check("triangle, samples outside", outside, 0, 0);
+
+    // Unit square at x < 0 and a 3 x 3 one at x > 0, 90% of the surface is on the right
+    rcl::HittableList list;
+    list.Add(std::make_shared<rcl::Quad>(rcl::vec3(-2, 0, 0), rcl::vec3(1, 0, 0), rcl::vec3(0, 1, 0), nullptr));
+    list.Add(std::make_shared<rcl::Quad>(rcl::vec3(1, 0, 0), rcl::vec3(3, 0, 0), rcl::vec3(0, 3, 0), nullptr));
+    for (int i = 0; i < 6; i++)
+        list.Add(std::make_shared<rcl::Quad>(rcl::vec3(-10 - i, 0, 0), rcl::vec3(0.01, 0, 0), rcl::vec3(0, 0.01, 0), nullptr));
+
+    double expected = 9.0 / list.Area();
+    passed &= Check("list", FractionRight(list), expected, 0.005);
+
+    rcl::BVHNode bvh(list);
+    passed &= Check("bvh", FractionRight(bvh), expected, 0.005);
+
+    rcl::QuantizedBVH<uint8_t> quantized(list);
+    passed &= Check("quantized bvh", FractionRight(quantized), expected, 0.005);
+
+    // Light lists go by power: the small square shines 27 times brighter than the large one, and an
+    // unlit one is never picked. Adding a second large square as bright as the small one rebuilds the table.
+    rcl::HittableList lights;
+    lights.SetSurfaceSampling(rcl::SurfaceSampling::Power);
+    lights.Add(std::make_shared<rcl::Quad>(rcl::vec3(-2, 0, 0), rcl::vec3(1, 0, 0), rcl::vec3(0, 1, 0), std::make_shared<rcl::Light>(rcl::vec3(1), 27)));
+    lights.Add(std::make_shared<rcl::Quad>(rcl::vec3(1, 0, 0), rcl::vec3(3, 0, 0), rcl::vec3(0, 3, 0), std::make_shared<rcl::Light>(rcl::vec3(1), 1)));
+    lights.Add(std::make_shared<rcl::Quad>(rcl::vec3(-5, 0, 0), rcl::vec3(1, 0, 0), rcl::vec3(0, 1, 0), nullptr));
+    passed &= Check("lights by power", FractionRight(lights), 0.25, 0.005);
+    lights.Add(std::make_shared<rcl::Quad>(rcl::vec3(1, 5, 0), rcl::vec3(3, 0, 0), rcl::vec3(0, 3, 0), std::make_shared<rcl::Light>(rcl::vec3(1), 27)));
+    passed &= Check("lights by power, after Add", FractionRight(lights), 252.0 / 279.0, 0.005);
+
+    // Without power nothing is picked, sampling answers as for an empty list
+    rcl::HittableList dark;
+    dark.SetSurfaceSampling(rcl::SurfaceSampling::Power);
+    dark.Add(std::make_shared<rcl::Quad>(rcl::vec3(1, 0, 0), rcl::vec3(3, 0, 0), rcl::vec3(0, 3, 0), nullptr));
+    dark.Add(std::make_shared<rcl::Quad>(rcl::vec3(1, 5, 0), rcl::vec3(3, 0, 0), rcl::vec3(0, 3, 0), std::make_shared<rcl::Light>(rcl::vec3(1), 0)));
+    passed &= Check("lights without power", FractionRight(dark), 0.0, 0.0);
+
+    // Same split with a mesh: one triangle left of x = 0 with area 0.5, one right with area 4.5
+    const char* path = "sampling_test.obj";
+    {
+        std::ofstream obj(path);
+        obj << "v -2 0 0\nv -1 0 0\nv -2 1 0\nv 1 0 0\nv 4 0 0\nv 1 3 0\nf 1 2 3\nf 4 5 6\n";
+    }
+    rcl::Mesh mesh(path, nullptr, false);
+    passed &= Check("mesh", FractionRight(mesh), 0.9, 0.005);
+    std::remove(path);
+
+    std::cout << (passed ? "all passed" : "SOME FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "vector.hpp"
+#include "functions.hpp"
+#include "picture.hpp"
+#include "picture_texture.hpp"
+#include "camera.hpp"
+#include "quad.hpp"
+#include "hit_record.hpp"
+#include "check.hpp"
+
+namespace
+{
+
+double Milliseconds(std::chrono::high_resolution_clock::time_point start)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Black and white squares of period texels, with a little color so channels differ
+std::shared_ptr<rcl::Picture> Checker(int width, int height, int period)
+{
+    auto picture = std::make_shared<rcl::Picture>(width, height);
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool white = ((x / period) + (y / period)) % 2 == 0;
+            picture->WritePixel(y, x, white ? rcl::vec3(1.0f, 0.9f, 0.8f) : rcl::vec3(0.0f, 0.05f, 0.1f));
+        }
+    }
+    return picture;
+}
+
+rcl::vec3 Mean(const rcl::Picture& picture)
+{
+    rcl::dvec3 sum(0.0);
+    for (int i = 0; i < picture.GetSize(); i++)
+        sum += rcl::dvec3(picture.GetData()[i]);
+    return rcl::vec3(sum / double(picture.GetSize()));
+}
+
+float Difference(const rcl::vec3& a, const rcl::vec3& b)
+{
+    return std::max(std::fabs(a.r - b.r), std::max(std::fabs(a.g - b.g), std::fabs(a.b - b.b)));
+}
+
+// A checkered floor seen from just above it, what the texture looks like through the camera's
+// pixels with samples jittered samples each, or a 16x16 grid of them when reference is set.
+// With footprint the cones narrow with the samples, as PathTracer narrows them.
+std::vector<rcl::vec3> View(const rcl::PictureTexture& texture, rcl::Camera& cam, int samples, bool reference, bool footprint)
+{
+    rcl::Quad floor(rcl::vec3(-20, 0, -2), rcl::vec3(40, 0, 0), rcl::vec3(0, 0, -60), nullptr);
+    int width = cam.GetImageWidth();
+    int height = cam.GetImageHeight();
+    int grid = reference ? 16 : 1;
+    int count = reference ? grid * grid : samples;
+
+    std::vector<rcl::vec3> image(static_cast<size_t>(width) * height, rcl::vec3(0.0f));
+    for (int i = 0; i < height; i++)
+    {
+        for (int j = 0; j < width; j++)
+        {
+            rcl::vec3 sum(0.0f);
+            for (int s = 0; s < count; s++)
+            {
+                rcl::vec3 offset = reference ? rcl::vec3((s % grid + 0.5) / grid - 0.5, (s / grid + 0.5) / grid - 0.5, 0)
+                                             : rcl::vec3(rcl::RandomDouble01() - 0.5, rcl::RandomDouble01() - 0.5, 0);
+                rcl::Ray ray = cam.GetRay(i, j, offset);
+                ray.coneSpread /= std::sqrt(float(count));
+                rcl::HitRecord rec;
+                if (floor.hit(ray, rcl::Interval<double>(0.0001, 1e9), rec))
+                    sum += texture.GetColor(rec.uv, footprint ? rec.UVFootprint(ray) : 0.0f);
+            }
+            image[static_cast<size_t>(i) * width + j] = sum / float(count);
+        }
+    }
+    return image;
+}
+
+double RootMeanSquare(const std::vector<rcl::vec3>& image, const std::vector<rcl::vec3>& reference)
+{
+    double sum = 0;
+    for (size_t i = 0; i < image.size(); i++)
+    {
+        rcl::vec3 d = image[i] - reference[i];
+        sum += (d.r * d.r + d.g * d.g + d.b * d.b) / 3;
+    }
+    return std::sqrt(sum / image.size());
+}
+
+}
+
+// Usage: texture_filter_test [texture size], checks the mip pyramid and its lookups, times building
+// it for a texture of that size, then compares
+// a floor seen through a camera with nearest and trilinear lookups against a 256 sample reference
+int main(int argc, char** argv)
+{
+    int size = argc > 1 ? std::atoi(argv[1]) : 2048;
+    bool passed = true;
+
+    // Odd sizes halve to their floor down to 1x1, the box keeps the mean on every level
+    {
+        auto picture = Checker(37, 21, 3);
+        rcl::PictureTexture texture(picture, rcl::TextureFilter::Trilinear, rcl::MipFilter::Box);
+        passed &= Check(texture.GetLevelCount() == 6, "level count");
+        passed &= Check(texture.GetLevel(1).GetWidth() == 18 && texture.GetLevel(1).GetHeight() == 10, "level size");
+        const rcl::Picture& last = texture.GetLevel(texture.GetLevelCount() - 1);
+        passed &= Check(last.GetWidth() == 1 && last.GetHeight() == 1, "last level");
+        bool meanKept = true;
+        for (int level = 1; level < texture.GetLevelCount(); level++)
+            meanKept &= Difference(Mean(texture.GetLevel(level)), Mean(*picture)) < 1e-5f;
+        passed &= Check(meanKept, "box filter keeps the mean");
+
+        // A footprint of the whole texture reads the 1x1 level
+        passed &= Check(Difference(texture.GetColor(rcl::vec2(0.3f, 0.6f), 4.0f), last.GetData()[0]) < 1e-6f, "coarsest level");
+
+        // Texel centers read the texels themselves
+        bool exact = true;
+        for (int y = 0; y < 21; y++)
+            for (int x = 0; x < 37; x++)
+                exact &= Difference(texture.GetColor(rcl::vec2((x + 0.5f) / 37, 1 - (y + 0.5f) / 21)), picture->GetData()[y * 37 + x]) < 1e-5f;
+        passed &= Check(exact, "bilinear at texel centers");
+    }
+
+    // The Kaiser filter keeps flat areas flat
+    {
+        auto flat = std::make_shared<rcl::Picture>(64, 48);
+        for (int i = 0; i < flat->GetSize(); i++)
+            flat->GetData()[i] = rcl::vec3(0.25f, 0.5f, 0.75f);
+        rcl::PictureTexture texture(flat, rcl::TextureFilter::Trilinear, rcl::MipFilter::Kaiser);
+        bool kept = true;
+        for (int level = 1; level < texture.GetLevelCount(); level++)
+            for (int i = 0; i < texture.GetLevel(level).GetSize(); i++)
+                kept &= Difference(texture.GetLevel(level).GetData()[i], rcl::vec3(0.25f, 0.5f, 0.75f)) < 1e-5f;
+        passed &= Check(kept, "Kaiser filter on a flat picture");
+    }
+
+    // Building the pyramid of a large texture
+    for (rcl::MipFilter mip : {rcl::MipFilter::Box, rcl::MipFilter::Kaiser})
+    {
+        auto picture = Checker(size, size, 2);
+        auto start = std::chrono::high_resolution_clock::now();
+        rcl::PictureTexture texture(picture, rcl::TextureFilter::Trilinear, mip);
+        std::cout << size << "x" << size << " pyramid, " << (mip == rcl::MipFilter::Box ? "box" : "Kaiser") << ": "
+                  << texture.GetLevelCount() << " levels in " << Milliseconds(start) << " ms" << std::endl;
+    }
+
+    // Aliasing on a receding floor against the reference, texels of 2 cm in checks of 2 texels,
+    // a fine pattern most of the floor shrinks
+    auto checker = Checker(2048, 2048, 2);
+    rcl::Camera cam;
+    cam.aspectRatio = 16.0f / 9.0f;
+    cam.imageWidth = 256;
+    cam.vfov = 40;
+    cam.lookFrom = rcl::vec3(0, 1, 0);
+    cam.lookAt = rcl::vec3(0, 0.2, -10);
+    cam.Initialize();
+
+    rcl::PictureTexture nearest(checker, rcl::TextureFilter::Nearest);
+    rcl::PictureTexture trilinear(checker, rcl::TextureFilter::Trilinear);
+    rcl::SeedRandom(7);
+    std::vector<rcl::vec3> reference = View(nearest, cam, 0, true, false);
+
+    double nearestError[3];
+    double trilinearError[3];
+    int spp[3] = {1, 4, 16};
+    for (int k = 0; k < 3; k++)
+    {
+        nearestError[k] = RootMeanSquare(View(nearest, cam, spp[k], false, false), reference);
+        trilinearError[k] = RootMeanSquare(View(trilinear, cam, spp[k], false, true), reference);
+        std::cout << spp[k] << " spp: nearest error " << nearestError[k] << ", trilinear error " << trilinearError[k] << std::endl;
+    }
+    passed &= Check(trilinearError[0] < nearestError[1], "trilinear at 1 spp beats nearest at 4");
+
+    std::cout << (passed ? "All texture filter checks passed" : "Texture filter checks FAILED") << std::endl;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "ray_tracer.hpp"
 #include "sampler.hpp"
+#include "resolve.hpp"
 
 namespace rcl
 {
@@ -11,17 +12,39 @@ class PathTracer : public RayTracer
 {
 public:
     PathTracer(int sapmles, int maxDepth);
+    // Into target, whose pixels are reused when it already has the camera's size
     void Render
     (const HittableList& world, Camera& cam, Picture& target, const HittableList& lights = HittableList()) 
     const override;
 
+    // Render for images too large to keep: bands of rows are rendered in turn and each finished
+    // band is resolved and written to path while the next one renders. Only two bands are ever
+    // held. The bands get the tracer's resolve settings with this transfer curve, by default the
+    // square root Picture::GammaCorection would apply. False when the file cannot be written.
+    bool RenderStreamed
+    (const HittableList& world, Camera& cam, const char* path, const HittableList& lights = HittableList(),
+     int compressionLevel = 6, TransferCurve transfer = TransferCurve::Gamma2) 
+    const;
+
+    // Applied to the linear radiance once a render finishes, Reinhard tone mapping by default
+    void SetResolve(const ResolveSettings& settings);
+    const ResolveSettings& GetResolve() const;
+
 private:
     int samplePerPixel = 10;
     double pixelSamplesScale;
+    // The samples of a pixel average out detail between them, each one's cone only covers its share
+    float coneScale;
     Sampler sampler;
     int maxDepth = 50;
     vec3 backgroundColor = vec3(0.5);
+    ResolveSettings resolve = {0.0f, ToneCurve::Reinhard, TransferCurve::Linear, false};
     
+    // Averaged samples of pixel (i, j), linear
+    vec3 PixelColor
+    (int i, int j, const HittableList& world, const Camera& cam, const HittableList& lights)
+    const;
+
     vec3 RayColor
     (const Ray& ray, int depth, const HittableList& world, const HittableList& lights = HittableList())
     const;
@@ -0,0 +1,41 @@
+#ifndef RCL_PHOTON_TRACER
+#define RCL_PHOTON_TRACER
+
+#include <vector>
+
+#include "hittable_list.hpp"
+#include "photon_map.hpp"
+
+namespace rcl
+{
+
+// Shoots photons from the emitters in the lights list and stores them on diffuse hits.
+// Work is split across threads, each with its own random stream and photon buffer.
+class PhotonTracer
+{
+public:
+    PhotonTracer(int photonCount, int maxDepth, unsigned int seed = 0);
+
+    void Trace(const HittableList& world, const HittableList& lights, std::vector<Photon>& photons) const;
+    void Trace(const HittableList& world, const HittableList& lights, PhotonMap& map) const;
+
+private:
+    int photonCount;
+    int maxDepth;
+    unsigned int seed;
+
+    struct Emitter
+    {
+        const Hittable* object;
+        vec3 radiance;
+        double area;
+    };
+
+    void TracePhoton
+    (Ray ray, vec3 power, const HittableList& world, std::vector<Photon>& photons) const;
+
+    static int MaterialKind(const Material& mat);
+};
+
+}
+#endif
\ No newline at end of file
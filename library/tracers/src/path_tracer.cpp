@@ -4,6 +4,10 @@
 #include <thread>
 #include <future>
 #include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include "pictures_workers.hpp"
 
 namespace rcl
 {
@@ -11,15 +15,20 @@ namespace rcl
 PathTracer::PathTracer(int sapmles, int maxDepth) : samplePerPixel(sapmles), maxDepth(maxDepth), sampler(sapmles)
 {
     pixelSamplesScale = 1.0 / sapmles;
+    coneScale = 1.0f / std::sqrt(static_cast<float>(sapmles));
 }
 
 void PathTracer::Render
 (const HittableList& world, Camera& cam, Picture& target, const HittableList& lights) const
 {
     cam.Initialize();
-    target = Picture(cam);
     unsigned int height = cam.GetImageHeight();
     unsigned int width = cam.GetImageWidth();
+
+    // Every pixel is overwritten, a target of the right size is rendered into as it is, wherever
+    // its pixels live
+    if (!target.GetData() || target.GetWidth() != static_cast<int>(width) || target.GetHeight() != static_cast<int>(height))
+        target = Picture(cam);
     
     unsigned int numThreads = std::thread::hardware_concurrency();
     if (numThreads == 0) numThreads = 1; // fallback if detection fails
@@ -40,20 +49,7 @@ void PathTracer::Render
             {
                 for (int j = 0; j < width; j++)
                 {
-                    vec3 pixelColor(0);
-                    for(int s = 0; s < samplePerPixel; s++)
-                    {
-                        Ray r = cam.GetRay(i, j, sampler.GetSampleOffset(s));
-                        pixelColor += RayColor(r, 1, world, lights);
-                    }
-
-                    pixelColor *= pixelSamplesScale;
-
-                    pixelColor.x /= pixelColor.x + 1;
-                    pixelColor.y /= pixelColor.y + 1;
-                    pixelColor.z /= pixelColor.z + 1;
-
-                    target.WritePixel(i, j, pixelColor);
+                    target.WritePixel(i, j, PixelColor(i, j, world, cam, lights));
                 }
             }
         }));
@@ -63,6 +59,97 @@ void PathTracer::Render
     {
         future.wait();
     }
+
+    target.Resolve(resolve);
+}
+
+bool PathTracer::RenderStreamed
+(const HittableList& world, Camera& cam, const char* path, const HittableList& lights, int compressionLevel,
+ TransferCurve transfer) const
+{
+    cam.Initialize();
+    int height = cam.GetImageHeight();
+    int width = cam.GetImageWidth();
+
+    ImageStreamWriter writer;
+    if (!writer.Open(path, width, height, compressionLevel))
+        return false;
+
+    ResolveSettings bandResolve = resolve;
+    bandResolve.transfer = transfer;
+    writer.SetResolve(bandResolve);
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 1; // fallback if detection fails
+
+    // A few rows per thread, threads take every numThreads-th row so costly regions are shared
+    int bandRows = std::max(16, 4 * static_cast<int>(numThreads));
+    std::vector<vec3> bands[2];
+    bands[0].resize(static_cast<size_t>(bandRows) * width);
+    bands[1].resize(static_cast<size_t>(bandRows) * width);
+
+    // Writing the previous band, it overlaps rendering the current one
+    std::future<bool> writing;
+    bool written = true;
+    int current = 0;
+    for (int bandStart = 0; bandStart < height; bandStart += bandRows, current ^= 1)
+    {
+        int rows = std::min(bandRows, height - bandStart);
+        vec3* band = bands[current].data();
+
+        std::vector<std::future<void>> futures;
+        for (unsigned int t = 0; t < numThreads; ++t)
+        {
+            futures.push_back(std::async(std::launch::async, [this, t, numThreads, bandStart, rows, width, band, &world, &cam, &lights]()
+            {
+                for (int row = t; row < rows; row += numThreads)
+                {
+                    for (int j = 0; j < width; j++)
+                    {
+                        band[static_cast<size_t>(row) * width + j] = PixelColor(bandStart + row, j, world, cam, lights);
+                    }
+                }
+            }));
+        }
+
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+
+        if (writing.valid())
+            written = writing.get() && written;
+        writing = std::async(std::launch::async, [&writer, band, rows]() { return writer.WriteRows(band, rows); });
+    }
+
+    if (writing.valid())
+        written = writing.get() && written;
+    return writer.Close() && written;
+}
+
+vec3 PathTracer::PixelColor
+(int i, int j, const HittableList& world, const Camera& cam, const HittableList& lights) const
+{
+    vec3 pixelColor(0);
+    for(int s = 0; s < samplePerPixel; s++)
+    {
+        Ray r = cam.GetRay(i, j, sampler.GetSampleOffset(s));
+        r.coneSpread *= coneScale;
+        pixelColor += RayColor(r, 1, world, lights);
+    }
+
+    pixelColor *= pixelSamplesScale;
+    return pixelColor;
+}
+
+void PathTracer::SetResolve(const ResolveSettings& settings)
+{
+    resolve = settings;
+}
+
+const ResolveSettings& PathTracer::GetResolve() const
+{
+    return resolve;
 }
 
 vec3 PathTracer::RayColor
@@ -81,7 +168,10 @@ const
     if(!rec.mat->Scatter(ray, rec, scatterRec))
         return emission;
 
+    // The cone goes on from the width it reached, bounces are not assumed to widen it
     Ray scattered(rec.point, scatterRec.outVec);
+    scattered.coneWidth = ray.ConeWidth(rec.distance);
+    scattered.coneSpread = ray.coneSpread;
     vec3 scatter;
     if(scatterRec.skipBRDF)
         scatter = scatterRec.albedo * RayColor(scattered, depth+1, world, lights);
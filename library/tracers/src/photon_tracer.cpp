@@ -0,0 +1,170 @@
+#include "photon_tracer.hpp"
+
+#include <iostream>
+#include <thread>
+#include <future>
+#include <algorithm>
+
+#include "functions.hpp"
+#include "material.hpp"
+#include "alias_table.hpp"
+
+namespace rcl
+{
+
+PhotonTracer::PhotonTracer(int photonCount, int maxDepth, unsigned int seed)
+: photonCount(photonCount), maxDepth(maxDepth), seed(seed) {}
+
+void PhotonTracer::Trace
+(const HittableList& world, const HittableList& lights, std::vector<Photon>& photons) const
+{
+    photons.clear();
+
+    // Emission is proportional to the power of every light: radiance * area
+    std::vector<Emitter> emitters;
+    std::vector<double> powers;
+
+    for (const std::shared_ptr<Hittable>& light : lights.objects)
+    {
+        Emitter emitter = {light.get(), EmitterRadiance(*light), light->Area()};
+
+        double power = Luminance(emitter.radiance) * emitter.area;
+        if (power <= 0) continue;
+
+        emitters.push_back(emitter);
+        powers.push_back(power);
+    }
+    AliasTable emitterPowers(powers);
+
+    if (emitters.empty() || photonCount <= 0)
+    {
+        std::cerr << "Error: No emitting lights to shoot photons from" << std::endl;
+        return;
+    }
+
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0) numThreads = 1;
+
+    int photonsPerThread = photonCount / numThreads;
+    int remainder = photonCount % numThreads;
+
+    std::vector<std::vector<Photon>> buffers(numThreads);
+    std::vector<std::future<void>> futures;
+
+    for (unsigned int t = 0; t < numThreads; ++t)
+    {
+        int count = photonsPerThread + ((t == numThreads - 1) ? remainder : 0);
+
+        futures.push_back(std::async(std::launch::async,
+        [this, t, count, &emitters, &emitterPowers, &world, &buffers]()
+        {
+            SeedRandom(seed * 9781u + t * 6271u + 1u);
+
+            std::vector<Photon>& buffer = buffers[t];
+            buffer.reserve(count * 2);
+
+            for (int i = 0; i < count; i++)
+            {
+                size_t index = emitterPowers.Sample();
+                const Emitter& emitter = emitters[index];
+                double probability = emitterPowers.Probability(index);
+
+                // Lambertian emitter flux is radiance * area * PI, shared among the photons it gets.
+                // Their directions are cosine weighted, so the shares are equal.
+                vec3 power = emitter.radiance * (emitter.area * PI / (probability * photonCount));
+
+                TracePhoton(emitter.object->RandomRayFromSurface(), power, world, buffer);
+            }
+        }));
+    }
+
+    for (auto& future : futures)
+    {
+        future.wait();
+    }
+    futures.clear();
+
+    // Every buffer moves into its own slice of the output, no synchronisation needed
+    std::vector<size_t> offsets(numThreads + 1, 0);
+    for (unsigned int t = 0; t < numThreads; ++t)
+        offsets[t + 1] = offsets[t] + buffers[t].size();
+
+    photons.resize(offsets[numThreads]);
+
+    for (unsigned int t = 0; t < numThreads; ++t)
+    {
+        futures.push_back(std::async(std::launch::async, [t, &offsets, &buffers, &photons]()
+        {
+            std::move(buffers[t].begin(), buffers[t].end(), photons.begin() + offsets[t]);
+            std::vector<Photon>().swap(buffers[t]);
+        }));
+    }
+
+    for (auto& future : futures)
+    {
+        future.wait();
+    }
+}
+
+void PhotonTracer::Trace(const HittableList& world, const HittableList& lights, PhotonMap& map) const
+{
+    std::vector<Photon> photons;
+    Trace(world, lights, photons);
+    map.Build(photons);
+}
+
+void PhotonTracer::TracePhoton
+(Ray ray, vec3 power, const HittableList& world, std::vector<Photon>& photons) const
+{
+    bool specularPath = true;
+
+    for (int depth = 0; depth < maxDepth; depth++)
+    {
+        HitRecord rec;
+        if (!world.hit(ray, Interval<double>(0.0001, +infinity), rec) || !rec.mat)
+            return;
+
+        const Material& mat = *rec.mat;
+
+        if (!mat.IsSpecular())
+        {
+            photons.push_back(Photon(rec.point, power, ray.direction, specularPath && depth > 0, MaterialKind(mat), rec.normal));
+            specularPath = false;
+        }
+
+        ScatterRecord scatterRec;
+        if (!mat.Scatter(ray, rec, scatterRec))
+            return;
+
+        Ray scattered(rec.point, scatterRec.outVec);
+
+        vec3 throughput;
+        if (scatterRec.skipBRDF)
+            throughput = scatterRec.albedo;
+        else
+        {
+            if (scatterRec.probability <= 0)
+                return;
+            throughput = mat.BRDF(ray, rec, scattered)
+                       * std::fabs(Dot(rec.normal, scattered.direction))
+                       / scatterRec.probability;
+        }
+
+        // Russian roulette keeps the photon power roughly constant along the path
+        double survival = std::min(1.0, static_cast<double>(throughput.MaxComponent()));
+        if (!(survival > 0) || RandomDouble01() >= survival)
+            return;
+
+        power = power * throughput / survival;
+        ray = scattered;
+    }
+}
+
+int PhotonTracer::MaterialKind(const Material& mat)
+{
+    if (mat.IsRefractive()) return 3;
+    if (mat.IsReflective()) return 2;
+    return 1;
+}
+
+}
\ No newline at end of file